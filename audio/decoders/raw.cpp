@@ -91,12 +91,15 @@ private:
 	};
 
 	/**
-	 * Fill the temporary sample buffer used in readBuffer.
+	 * Fill the temporary sample buffer used in readBuffer. If the
+	 * stream is in memory, the samples are not copied into the buffer,
+	 * but taken directly from the stream instead.
 	 *
+	 * @param src        Set to the location of the samples.
 	 * @param maxSamples Maximum samples to read.
 	 * @return actual count of samples read.
 	 */
-	int fillBuffer(int maxSamples);
+	int fillBuffer(const byte *&src, int maxSamples);
 };
 
 template<bool is16Bit, bool isUnsigned, bool isLE>
@@ -105,7 +108,8 @@ int RawStream<is16Bit, isUnsigned, isLE>::readBuffer(int16 *buffer, const int nu
 
 	while (samplesLeft > 0) {
 		// Try to read up to "samplesLeft" samples.
-		int len = fillBuffer(samplesLeft);
+		const byte *src;
+		int len = fillBuffer(src, samplesLeft);
 
 		// In case we were not able to read any samples
 		// we will stop reading here.
@@ -116,7 +120,6 @@ int RawStream<is16Bit, isUnsigned, isLE>::readBuffer(int16 *buffer, const int nu
 		samplesLeft -= len;
 
 		// Copy the data to the caller's buffer.
-		const byte *src = _buffer;
 		while (len-- > 0) {
 			*buffer++ = READ_ENDIAN_SAMPLE(is16Bit, isUnsigned, src, isLE);
 			src += (is16Bit ? 2 : 1);
@@ -127,15 +130,27 @@ int RawStream<is16Bit, isUnsigned, isLE>::readBuffer(int16 *buffer, const int nu
 }
 
 template<bool is16Bit, bool isUnsigned, bool isLE>
-int RawStream<is16Bit, isUnsigned, isLE>::fillBuffer(int maxSamples) {
+int RawStream<is16Bit, isUnsigned, isLE>::fillBuffer(const byte *&src, int maxSamples) {
 	int bufferedSamples = 0;
 	byte *dst = _buffer;
+	src = _buffer;
 
 	// We can only read up to "kSampleBufferLength" samples
 	// so we take this into consideration, when trying to
 	// read up to maxSamples.
 	maxSamples = MIN<int>(kSampleBufferLength, maxSamples);
 
+	// Avoid the copy if the samples are available in memory
+	if (!endOfData()) {
+		const byte *view = _stream->readView(maxSamples * (is16Bit ? 2 : 1));
+		if (view) {
+			src = view;
+			if (_stream->pos() == _stream->size())
+				_endOfData = true;
+			return maxSamples;
+		}
+	}
+
 	// We will only read up to maxSamples
 	while (maxSamples > 0 && !endOfData()) {
 		// Try to read all the sample data and update the
@@ -20,6 +20,7 @@
  *
  */
 
+#include "common/config-manager.h"
 #include "common/util.h"
 #include "common/system.h"
 #include "common/textconsole.h"
@@ -42,7 +43,7 @@ namespace Audio {
  */
 class Channel {
 public:
-	Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream, DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent);
+	Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream, DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent, RateConverterQuality quality);
 	~Channel();
 
 	/**
@@ -98,7 +99,7 @@ public:
 	 *
 	 * @return volume
 	 */
-	byte getVolume();
+	byte getVolume() const;
 
 	/**
 	 * Sets the channel's balance setting.
@@ -112,7 +113,7 @@ public:
 	 *
 	 * @return balance
 	 */
-	int8 getBalance();
+	int8 getBalance() const;
 
 	/**
 	 * Notifies the channel that the global sound type
@@ -173,15 +174,34 @@ private:
 
 
 MixerImpl::MixerImpl(OSystem *system, uint sampleRate)
-	: _syst(system), _mutex(), _sampleRate(sampleRate), _mixerReady(false), _handleSeed(0), _soundTypeSettings() {
+	: _syst(system), _mutex(), _queueMutex(), _sampleRate(sampleRate), _mixerReady(false), _commandQueue(false),
+	  _handleSeed(0), _converterQuality(kRateConverterFast), _soundTypeSettings(), _numActiveChannels(0), _numCommands(0) {
 
 	assert(sampleRate > 0);
 
-	for (int i = 0; i != NUM_CHANNELS; i++)
+	if (ConfMan.hasKey("resampler_quality")) {
+		const Common::String quality = ConfMan.get("resampler_quality");
+		if (quality.equalsIgnoreCase("low"))
+			_converterQuality = kRateConverterSincLow;
+		else if (quality.equalsIgnoreCase("medium"))
+			_converterQuality = kRateConverterSincMedium;
+		else if (quality.equalsIgnoreCase("high"))
+			_converterQuality = kRateConverterSincHigh;
+		else if (!quality.equalsIgnoreCase("fast"))
+			warning("Unknown resampler quality '%s'", quality.c_str());
+	}
+
+	for (int i = 0; i != NUM_CHANNELS; i++) {
 		_channels[i] = 0;
+		_activeChannels[i] = 0;
+		_activeIndex[i] = 0;
+	}
 }
 
 MixerImpl::~MixerImpl() {
+	// Queued channels have to be freed as well
+	flushCommands();
+
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		delete _channels[i];
 }
@@ -190,14 +210,187 @@ void MixerImpl::setReady(bool ready) {
 	_mixerReady = ready;
 }
 
+void MixerImpl::setCommandQueue(bool enable) {
+	Common::StackLock lock(_mutex);
+	flushCommands();
+	_commandQueue = enable;
+}
+
+void MixerImpl::setRateConverterQuality(RateConverterQuality quality) {
+	_converterQuality = quality;
+}
+
 uint MixerImpl::getOutputRate() const {
 	return _sampleRate;
 }
 
-void MixerImpl::insertChannel(SoundHandle *handle, Channel *chan) {
+int MixerImpl::findSlot(SoundHandle handle) const {
+	const int index = handle._val % NUM_CHANNELS;
+	if (!_slots[index].used || _slots[index].handle != handle._val)
+		return -1;
+	return index;
+}
+
+bool MixerImpl::beginCommand(bool mayQueue) {
+	if (mayQueue && _commandQueue) {
+		_queueMutex.lock();
+		if (_numCommands < COMMAND_QUEUE_SIZE)
+			return false;
+
+		// The audio thread did not keep up with the commands. Fall back to
+		// executing this one directly.
+		_queueMutex.unlock();
+	}
+
+	_mutex.lock();
+	flushCommands();
+	_queueMutex.lock();
+	return true;
+}
+
+void MixerImpl::endCommand(bool sync) {
+	_queueMutex.unlock();
+	if (sync)
+		_mutex.unlock();
+}
+
+void MixerImpl::submitCommand(bool sync, CommandType type, Channel *channel, uint32 handle, int param, bool paused) {
+	Command cmd;
+	cmd.type = type;
+	cmd.channel = channel;
+	cmd.handle = handle;
+	cmd.param = param;
+	cmd.paused = paused;
+
+	if (sync) {
+		runCommand(cmd);
+	} else {
+		assert(_numCommands < COMMAND_QUEUE_SIZE);
+		_commands[_numCommands++] = cmd;
+	}
+}
+
+uint MixerImpl::takeCommands(Command *cmds) {
+	const uint count = _numCommands;
+	for (uint i = 0; i < count; i++)
+		cmds[i] = _commands[i];
+	_numCommands = 0;
+	return count;
+}
+
+void MixerImpl::runCommands(const Command *cmds, uint count) {
+	for (uint i = 0; i < count; i++)
+		runCommand(cmds[i]);
+}
+
+void MixerImpl::flushCommands() {
+	Command cmds[COMMAND_QUEUE_SIZE];
+	uint count;
+
+	{
+		Common::StackLock lock(_queueMutex);
+		count = takeCommands(cmds);
+	}
+
+	// Run the commands without holding _queueMutex, since stopping a
+	// channel may have to destroy its stream.
+	runCommands(cmds, count);
+}
+
+void MixerImpl::runCommand(const Command &cmd) {
+	const int index = cmd.handle % NUM_CHANNELS;
+	Channel *chan = _channels[index];
+	if (chan && chan->getHandle()._val != cmd.handle)
+		chan = 0;
+
+	switch (cmd.type) {
+	case kCommandPlay:
+		assert(!_channels[index]);
+		addActiveChannel(index, cmd.channel);
+		break;
+
+	case kCommandStop:
+		if (chan)
+			removeChannel(index);
+		break;
+
+	case kCommandStopID:
+		for (int i = 0; i != NUM_CHANNELS; i++) {
+			if (_channels[i] != 0 && _channels[i]->getId() == cmd.param)
+				removeChannel(i);
+		}
+		break;
+
+	case kCommandStopAll:
+		for (int i = 0; i != NUM_CHANNELS; i++) {
+			if (_channels[i] != 0 && !_channels[i]->isPermanent())
+				removeChannel(i);
+		}
+		break;
+
+	case kCommandPause:
+		if (chan)
+			chan->pause(cmd.paused);
+		break;
+
+	case kCommandPauseID:
+		for (int i = 0; i != NUM_CHANNELS; i++) {
+			if (_channels[i] != 0 && _channels[i]->getId() == cmd.param) {
+				_channels[i]->pause(cmd.paused);
+				break;
+			}
+		}
+		break;
+
+	case kCommandPauseAll:
+		for (uint i = 0; i < _numActiveChannels; i++)
+			_activeChannels[i]->pause(cmd.paused);
+		break;
+
+	case kCommandSetVolume:
+		if (chan)
+			chan->setVolume(cmd.param);
+		break;
+
+	case kCommandSetBalance:
+		if (chan)
+			chan->setBalance(cmd.param);
+		break;
+
+	case kCommandUpdateTypeVolume:
+		for (uint i = 0; i < _numActiveChannels; i++) {
+			if (_activeChannels[i]->getType() == cmd.param)
+				_activeChannels[i]->notifyGlobalVolChange();
+		}
+		break;
+	}
+}
+
+void MixerImpl::addActiveChannel(int index, Channel *chan) {
+	_channels[index] = chan;
+	_activeIndex[index] = _numActiveChannels;
+	_activeChannels[_numActiveChannels++] = chan;
+}
+
+void MixerImpl::removeChannel(int index) {
+	Channel *chan = _channels[index];
+	assert(chan);
+
+	// Move the last active channel into the freed spot
+	const uint pos = _activeIndex[index];
+	Channel *last = _activeChannels[--_numActiveChannels];
+	_activeChannels[pos] = last;
+	_activeIndex[last->getHandle()._val % NUM_CHANNELS] = pos;
+	_activeChannels[_numActiveChannels] = 0;
+
+	_channels[index] = 0;
+	delete chan;
+}
+
+void MixerImpl::insertChannel(SoundHandle *handle, Channel *chan, bool sync) {
 	int index = -1;
 	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] == 0) {
+		if (!_slots[i].used) {
 			index = i;
 			break;
 		}
@@ -208,8 +401,6 @@ void MixerImpl::insertChannel(SoundHandle *handle, Channel *chan) {
 		return;
 	}
 
-	_channels[index] = chan;
-
 	SoundHandle chanHandle;
 	chanHandle._val = index + (_handleSeed * NUM_CHANNELS);
 
@@ -217,6 +408,17 @@ void MixerImpl::insertChannel(SoundHandle *handle, Channel *chan) {
 	_handleSeed++;
 	if (handle)
 		*handle = chanHandle;
+
+	ChannelSlot &slot = _slots[index];
+	slot.used = true;
+	slot.handle = chanHandle._val;
+	slot.id = chan->getId();
+	slot.type = chan->getType();
+	slot.volume = chan->getVolume();
+	slot.balance = chan->getBalance();
+	slot.permanent = chan->isPermanent();
+
+	submitCommand(sync, kCommandPlay, chan, chanHandle._val, 0);
 }
 
 void MixerImpl::playStream(
@@ -227,8 +429,6 @@ void MixerImpl::playStream(
 			DisposeAfterUse::Flag autofreeStream,
 			bool permanent,
 			bool reverseStereo) {
-	Common::StackLock lock(_mutex);
-
 	if (stream == 0) {
 		warning("stream is 0");
 		return;
@@ -237,10 +437,14 @@ void MixerImpl::playStream(
 
 	assert(_mixerReady);
 
+	const bool sync = beginCommand(true);
+
 	// Prevent duplicate sounds
 	if (id != -1) {
 		for (int i = 0; i != NUM_CHANNELS; i++)
-			if (_channels[i] != 0 && _channels[i]->getId() == id) {
+			if (_slots[i].used && _slots[i].id == id) {
+				endCommand(sync);
+
 				// Delete the stream if were asked to auto-dispose it.
 				// Note: This could cause trouble if the client code does not
 				// yet expect the stream to be gone. The primary example to
@@ -258,10 +462,12 @@ void MixerImpl::playStream(
 #endif
 
 	// Create the channel
-	Channel *chan = new Channel(this, type, stream, autofreeStream, reverseStereo, id, permanent);
+	Channel *chan = new Channel(this, type, stream, autofreeStream, reverseStereo, id, permanent, _converterQuality);
 	chan->setVolume(volume);
 	chan->setBalance(balance);
-	insertChannel(handle, chan);
+	insertChannel(handle, chan, sync);
+
+	endCommand(sync);
 }
 
 int MixerImpl::mixCallback(byte *samples, uint len) {
@@ -269,6 +475,9 @@ int MixerImpl::mixCallback(byte *samples, uint len) {
 
 	Common::StackLock lock(_mutex);
 
+	// Apply the channel changes queued since the last callback
+	flushCommands();
+
 	int16 *buf = (int16 *)samples;
 	// we store stereo, 16-bit samples
 	assert(len % 4 == 0);
@@ -280,64 +489,88 @@ int MixerImpl::mixCallback(byte *samples, uint len) {
 	//  zero the buf
 	memset(buf, 0, 2 * len * sizeof(int16));
 
-	// mix all channels
+	// mix all active channels
+	uint32 finished[NUM_CHANNELS];
+	uint numFinished = 0;
 	int res = 0, tmp;
-	for (int i = 0; i != NUM_CHANNELS; i++)
-		if (_channels[i]) {
-			if (_channels[i]->isFinished()) {
-				delete _channels[i];
-				_channels[i] = 0;
-			} else if (!_channels[i]->isPaused()) {
-				tmp = _channels[i]->mix(buf, len);
-
-				if (tmp > res)
-					res = tmp;
-			}
+	for (uint i = 0; i < _numActiveChannels;) {
+		Channel *chan = _activeChannels[i];
+		if (chan->isFinished()) {
+			// removeChannel moves another channel to position i
+			finished[numFinished++] = chan->getHandle()._val;
+			removeChannel(chan->getHandle()._val % NUM_CHANNELS);
+			continue;
+		}
+
+		if (!chan->isPaused()) {
+			tmp = chan->mix(buf, len);
+
+			if (tmp > res)
+				res = tmp;
+		}
+		i++;
+	}
+
+	if (numFinished) {
+		Common::StackLock queueLock(_queueMutex);
+		for (uint i = 0; i < numFinished; i++) {
+			ChannelSlot &slot = _slots[finished[i] % NUM_CHANNELS];
+			// The slot may have been stopped and reused in the meantime
+			if (slot.used && slot.handle == finished[i])
+				slot.used = false;
 		}
+	}
 
 	return res;
 }
 
 void MixerImpl::stopAll() {
-	Common::StackLock lock(_mutex);
+	// Stops are never queued: callers may free the sound data (or a
+	// stream that is not owned by the mixer) as soon as this returns, so
+	// the audio thread must be done with the channel by then.
+	const bool sync = beginCommand(false);
+
 	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0 && !_channels[i]->isPermanent()) {
-			delete _channels[i];
-			_channels[i] = 0;
-		}
+		if (_slots[i].used && !_slots[i].permanent)
+			_slots[i].used = false;
 	}
+	submitCommand(sync, kCommandStopAll, 0, 0, 0);
+
+	endCommand(sync);
 }
 
 void MixerImpl::stopID(int id) {
-	Common::StackLock lock(_mutex);
+	const bool sync = beginCommand(false);
+
 	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0 && _channels[i]->getId() == id) {
-			delete _channels[i];
-			_channels[i] = 0;
-		}
+		if (_slots[i].used && _slots[i].id == id)
+			_slots[i].used = false;
 	}
+	submitCommand(sync, kCommandStopID, 0, 0, id);
+
+	endCommand(sync);
 }
 
 void MixerImpl::stopHandle(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
+	const bool sync = beginCommand(false);
 
 	// Simply ignore stop requests for handles of sounds that already terminated
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
-		return;
+	const int index = findSlot(handle);
+	if (index != -1) {
+		_slots[index].used = false;
+		submitCommand(sync, kCommandStop, 0, handle._val, 0);
+	}
 
-	delete _channels[index];
-	_channels[index] = 0;
+	endCommand(sync);
 }
 
 void MixerImpl::muteSoundType(SoundType type, bool mute) {
 	assert(0 <= type && type < ARRAYSIZE(_soundTypeSettings));
-	_soundTypeSettings[type].mute = mute;
 
-	for (int i = 0; i != NUM_CHANNELS; ++i) {
-		if (_channels[i] && _channels[i]->getType() == type)
-			_channels[i]->notifyGlobalVolChange();
-	}
+	const bool sync = beginCommand(true);
+	_soundTypeSettings[type].mute = mute;
+	submitCommand(sync, kCommandUpdateTypeVolume, 0, 0, type);
+	endCommand(sync);
 }
 
 bool MixerImpl::isSoundTypeMuted(SoundType type) const {
@@ -346,39 +579,47 @@ bool MixerImpl::isSoundTypeMuted(SoundType type) const {
 }
 
 void MixerImpl::setChannelVolume(SoundHandle handle, byte volume) {
-	Common::StackLock lock(_mutex);
+	const bool sync = beginCommand(true);
 
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
-		return;
+	const int index = findSlot(handle);
+	if (index != -1) {
+		_slots[index].volume = volume;
+		submitCommand(sync, kCommandSetVolume, 0, handle._val, volume);
+	}
 
-	_channels[index]->setVolume(volume);
+	endCommand(sync);
 }
 
 byte MixerImpl::getChannelVolume(SoundHandle handle) {
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	Common::StackLock lock(_queueMutex);
+
+	const int index = findSlot(handle);
+	if (index == -1)
 		return 0;
 
-	return _channels[index]->getVolume();
+	return _slots[index].volume;
 }
 
 void MixerImpl::setChannelBalance(SoundHandle handle, int8 balance) {
-	Common::StackLock lock(_mutex);
+	const bool sync = beginCommand(true);
 
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
-		return;
+	const int index = findSlot(handle);
+	if (index != -1) {
+		_slots[index].balance = balance;
+		submitCommand(sync, kCommandSetBalance, 0, handle._val, balance);
+	}
 
-	_channels[index]->setBalance(balance);
+	endCommand(sync);
 }
 
 int8 MixerImpl::getChannelBalance(SoundHandle handle) {
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	Common::StackLock lock(_queueMutex);
+
+	const int index = findSlot(handle);
+	if (index == -1)
 		return 0;
 
-	return _channels[index]->getBalance();
+	return _slots[index].balance;
 }
 
 uint32 MixerImpl::getSoundElapsedTime(SoundHandle handle) {
@@ -386,7 +627,10 @@ uint32 MixerImpl::getSoundElapsedTime(SoundHandle handle) {
 }
 
 Timestamp MixerImpl::getElapsedTime(SoundHandle handle) {
+	// The timing information is owned by the channel itself, so this has
+	// to wait for the mixer even in command queue mode.
 	Common::StackLock lock(_mutex);
+	flushCommands();
 
 	const int index = handle._val % NUM_CHANNELS;
 	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
@@ -396,61 +640,52 @@ Timestamp MixerImpl::getElapsedTime(SoundHandle handle) {
 }
 
 void MixerImpl::pauseAll(bool paused) {
-	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0) {
-			_channels[i]->pause(paused);
-		}
-	}
+	const bool sync = beginCommand(true);
+	submitCommand(sync, kCommandPauseAll, 0, 0, 0, paused);
+	endCommand(sync);
 }
 
 void MixerImpl::pauseID(int id, bool paused) {
-	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0 && _channels[i]->getId() == id) {
-			_channels[i]->pause(paused);
-			return;
-		}
-	}
+	const bool sync = beginCommand(true);
+	submitCommand(sync, kCommandPauseID, 0, 0, id, paused);
+	endCommand(sync);
 }
 
 void MixerImpl::pauseHandle(SoundHandle handle, bool paused) {
-	Common::StackLock lock(_mutex);
+	const bool sync = beginCommand(true);
 
 	// Simply ignore (un)pause requests for sounds that already terminated
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
-		return;
+	if (findSlot(handle) != -1)
+		submitCommand(sync, kCommandPause, 0, handle._val, 0, paused);
 
-	_channels[index]->pause(paused);
+	endCommand(sync);
 }
 
 bool MixerImpl::isSoundIDActive(int id) {
-	Common::StackLock lock(_mutex);
+	Common::StackLock lock(_queueMutex);
 	for (int i = 0; i != NUM_CHANNELS; i++)
-		if (_channels[i] && _channels[i]->getId() == id)
+		if (_slots[i].used && _slots[i].id == id)
 			return true;
 	return false;
 }
 
 int MixerImpl::getSoundID(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
-	const int index = handle._val % NUM_CHANNELS;
-	if (_channels[index] && _channels[index]->getHandle()._val == handle._val)
-		return _channels[index]->getId();
+	Common::StackLock lock(_queueMutex);
+	const int index = findSlot(handle);
+	if (index != -1)
+		return _slots[index].id;
 	return 0;
 }
 
 bool MixerImpl::isSoundHandleActive(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
-	const int index = handle._val % NUM_CHANNELS;
-	return _channels[index] && _channels[index]->getHandle()._val == handle._val;
+	Common::StackLock lock(_queueMutex);
+	return findSlot(handle) != -1;
 }
 
 bool MixerImpl::hasActiveChannelOfType(SoundType type) {
-	Common::StackLock lock(_mutex);
+	Common::StackLock lock(_queueMutex);
 	for (int i = 0; i != NUM_CHANNELS; i++)
-		if (_channels[i] && _channels[i]->getType() == type)
+		if (_slots[i].used && _slots[i].type == type)
 			return true;
 	return false;
 }
@@ -467,13 +702,10 @@ void MixerImpl::setVolumeForSoundType(SoundType type, int volume) {
 	// TODO: Maybe we should do logarithmic (not linear) volume
 	// scaling? See also Player_V2::setMasterVolume
 
-	Common::StackLock lock(_mutex);
+	const bool sync = beginCommand(true);
 	_soundTypeSettings[type].volume = volume;
-
-	for (int i = 0; i != NUM_CHANNELS; ++i) {
-		if (_channels[i] && _channels[i]->getType() == type)
-			_channels[i]->notifyGlobalVolChange();
-	}
+	submitCommand(sync, kCommandUpdateTypeVolume, 0, 0, type);
+	endCommand(sync);
 }
 
 int MixerImpl::getVolumeForSoundType(SoundType type) const {
@@ -488,8 +720,10 @@ int MixerImpl::getVolumeForSoundType(SoundType type) const {
 #pragma mark -
 
 Channel::Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream,
-                 DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent)
-    : _type(type), _mixer(mixer), _id(id), _permanent(permanent), _volume(Mixer::kMaxChannelVolume),
+                 DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent,
+                 RateConverterQuality quality)
+    : _type(type), _mixer(mixer), _id(id), _permanent(permanent),
+      _volume(Mixer::kMaxChannelVolume),
       _balance(0), _pauseLevel(0), _samplesConsumed(0), _samplesDecoded(0), _mixerTimeStamp(0),
       _pauseStartTime(0), _pauseTime(0), _converter(0),
       _stream(stream, autofreeStream) {
@@ -497,7 +731,7 @@ Channel::Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream,
 	assert(stream);
 
 	// Get a rate converter instance
-	_converter = makeRateConverter(_stream->getRate(), mixer->getOutputRate(), _stream->isStereo(), reverseStereo);
+	_converter = makeRateConverter(_stream->getRate(), mixer->getOutputRate(), _stream->isStereo(), reverseStereo, quality);
 }
 
 Channel::~Channel() {
@@ -509,7 +743,7 @@ void Channel::setVolume(const byte volume) {
 	updateChannelVolumes();
 }
 
-byte Channel::getVolume() {
+byte Channel::getVolume() const {
 	return _volume;
 }
 
@@ -518,7 +752,7 @@ void Channel::setBalance(const int8 balance) {
 	updateChannelVolumes();
 }
 
-int8 Channel::getBalance() {
+int8 Channel::getBalance() const {
 	return _balance;
 }
 
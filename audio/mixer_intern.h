@@ -26,6 +26,7 @@
 #include "common/scummsys.h"
 #include "common/mutex.h"
 #include "audio/mixer.h"
+#include "audio/rate.h"
 
 namespace Audio {
 
@@ -42,6 +43,16 @@ namespace Audio {
  * 4) Change the mixer into ready mode via setReady(true).
  * 5) Start audio processing (e.g. by resuming the audio thread, if applicable).
  *
+ * By default, every channel operation takes the mixer mutex, and thus waits
+ * for a running mixCallback() to finish. Backends may switch the mixer into
+ * command queue mode via setCommandQueue(true). In that mode channel
+ * additions, removals and parameter changes are recorded in a small command
+ * queue which mixCallback() drains before mixing; queries are answered from
+ * a per-slot copy of the channel state. Both the queue and the slot state are
+ * guarded by a separate mutex which is only ever held for a few instructions,
+ * so neither the engine nor the audio thread has to wait for the other to
+ * finish mixing or decoding.
+ *
  * In the future, we might make it possible for backends to provide
  * (partial) alternative implementations of the mixer, e.g. to make
  * better use of native sound mixing support on low-end devices.
@@ -51,15 +62,64 @@ namespace Audio {
 class MixerImpl : public Mixer {
 private:
 	enum {
-		NUM_CHANNELS = 16
+		NUM_CHANNELS = 16,
+		COMMAND_QUEUE_SIZE = 64
+	};
+
+	enum CommandType {
+		kCommandPlay,
+		kCommandStop,
+		kCommandStopID,
+		kCommandStopAll,
+		kCommandPause,
+		kCommandPauseID,
+		kCommandPauseAll,
+		kCommandSetVolume,
+		kCommandSetBalance,
+		kCommandUpdateTypeVolume
+	};
+
+	/**
+	 * A deferred channel operation. Which of the parameter fields are used
+	 * depends on the command type.
+	 */
+	struct Command {
+		CommandType type;
+		Channel *channel;
+		uint32 handle;
+		int param;
+		bool paused;
+	};
+
+	/**
+	 * The state of a channel slot as seen by the callers of the Mixer API.
+	 * Slots are claimed as soon as playStream returns, and are released
+	 * either by a stop call or by the mixer after the channel finished.
+	 */
+	struct ChannelSlot {
+		ChannelSlot() : used(false), handle(0), id(-1), type(kPlainSoundType), volume(0), balance(0), permanent(false) {}
+
+		bool used;
+		uint32 handle;
+		int id;
+		SoundType type;
+		byte volume;
+		int8 balance;
+		bool permanent;
 	};
 
 	OSystem *_syst;
+
+	/** Guards _channels and the active list; held while mixing. */
 	Common::Mutex _mutex;
+	/** Guards _slots and the command queue; only ever held briefly. */
+	Common::Mutex _queueMutex;
 
 	const uint _sampleRate;
 	bool _mixerReady;
+	bool _commandQueue;
 	uint32 _handleSeed;
+	RateConverterQuality _converterQuality;
 
 	struct SoundTypeSettings {
 		SoundTypeSettings() : mute(false), volume(kMaxMixerVolume) {}
@@ -71,6 +131,15 @@ private:
 	SoundTypeSettings _soundTypeSettings[4];
 	Channel *_channels[NUM_CHANNELS];
 
+	/** The non-empty entries of _channels, in no particular order. */
+	Channel *_activeChannels[NUM_CHANNELS];
+	uint _activeIndex[NUM_CHANNELS];
+	uint _numActiveChannels;
+
+	ChannelSlot _slots[NUM_CHANNELS];
+
+	Command _commands[COMMAND_QUEUE_SIZE];
+	uint _numCommands;
 
 public:
 
@@ -120,7 +189,56 @@ public:
 	virtual uint getOutputRate() const;
 
 protected:
-	void insertChannel(SoundHandle *handle, Channel *chan);
+	/** Claims a slot for chan. Must be called between beginCommand and endCommand. */
+	void insertChannel(SoundHandle *handle, Channel *chan, bool sync);
+
+private:
+	/** Returns the slot index of handle, or -1 if the handle is not active. */
+	int findSlot(SoundHandle handle) const;
+
+	/**
+	 * Acquires the locks for changing the channel state. If the change may
+	 * be queued and the command queue is enabled (and not full), only
+	 * _queueMutex is locked. Otherwise all queued commands are executed
+	 * and both mutexes are held.
+	 *
+	 * @return true if the change has to be executed synchronously
+	 */
+	bool beginCommand(bool mayQueue);
+	void endCommand(bool sync);
+
+	/**
+	 * Executes the given command right away, or queues it for the next
+	 * mixCallback when sync is false. Must be called between beginCommand
+	 * and endCommand, right after updating _slots to match.
+	 */
+	void submitCommand(bool sync, CommandType type, Channel *channel, uint32 handle, int param, bool paused = false);
+
+	/** Moves all queued commands into cmds. Requires _queueMutex. */
+	uint takeCommands(Command *cmds);
+	/** Executes the given commands. Requires _mutex. */
+	void runCommands(const Command *cmds, uint count);
+	/** Executes all queued commands. Requires _mutex, but not _queueMutex. */
+	void flushCommands();
+	void runCommand(const Command &cmd);
+
+	void addActiveChannel(int index, Channel *chan);
+	void removeChannel(int index);
+
+public:
+	/**
+	 * Enables or disables the command queue mode, see the class
+	 * description. Pending commands are executed when disabling it.
+	 */
+	void setCommandQueue(bool enable);
+
+	bool hasCommandQueue() const { return _commandQueue; }
+
+	/**
+	 * Sets the rate conversion method for channels started from now on.
+	 * The initial value is taken from the "resampler_quality" config key.
+	 */
+	void setRateConverterQuality(RateConverterQuality quality);
 
 public:
 	/**
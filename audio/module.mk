@@ -12,6 +12,8 @@ MODULE_OBJS := \
 	mpu401.o \
 	musicplugin.o \
 	null.o \
+	rate_kernels.o \
+	rate_sinc.o \
 	timestamp.o \
 	decoders/aac.o \
 	decoders/adpcm.o \
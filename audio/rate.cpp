@@ -30,6 +30,7 @@
 
 #include "audio/audiostream.h"
 #include "audio/rate.h"
+#include "audio/rate_kernels.h"
 #include "audio/mixer.h"
 #include "common/frac.h"
 #include "common/textconsole.h"
@@ -103,43 +104,57 @@ SimpleRateConverter<stereo, reverseStereo>::SimpleRateConverter(st_rate_t inrate
  */
 template<bool stereo, bool reverseStereo>
 int SimpleRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+	const RateKernels &kernels = getRateKernels();
+	st_sample_t frames[INTERMEDIATE_BUFFER_SIZE];
 	st_sample_t *ostart, *oend;
 
 	ostart = obuf;
 	oend = obuf + osamp * 2;
 
 	while (obuf < oend) {
+		// Pick the input samples for as many output frames as fit into
+		// the frame buffer, then mix them in one go
+		const uint maxFrames = MIN<uint>((oend - obuf) / 2, ARRAYSIZE(frames) / (stereo ? 2 : 1));
+		st_sample_t *fptr = frames;
+		uint numFrames = 0;
+		bool endOfInput = false;
+
+		while (numFrames < maxFrames) {
+			// read enough input samples so that opos >= 0
+			do {
+				// Check if we have to refill the buffer
+				if (inLen == 0) {
+					inPtr = inBuf;
+					inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
+					if (inLen <= 0) {
+						endOfInput = true;
+						break;
+					}
+				}
+				inLen -= (stereo ? 2 : 1);
+				opos--;
+				if (opos >= 0) {
+					inPtr += (stereo ? 2 : 1);
+				}
+			} while (opos >= 0);
+
+			if (endOfInput)
+				break;
+
+			*fptr++ = *inPtr++;
+			if (stereo)
+				*fptr++ = *inPtr++;
 
-		// read enough input samples so that opos >= 0
-		do {
-			// Check if we have to refill the buffer
-			if (inLen == 0) {
-				inPtr = inBuf;
-				inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
-				if (inLen <= 0)
-					return (obuf - ostart) / 2;
-			}
-			inLen -= (stereo ? 2 : 1);
-			opos--;
-			if (opos >= 0) {
-				inPtr += (stereo ? 2 : 1);
-			}
-		} while (opos >= 0);
-
-		st_sample_t out0, out1;
-		out0 = *inPtr++;
-		out1 = (stereo ? *inPtr++ : out0);
-
-		// Increment output position
-		opos += opos_inc;
-
-		// output left channel
-		clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+			// Increment output position
+			opos += opos_inc;
+			numFrames++;
+		}
 
-		// output right channel
-		clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+		mixFrames<stereo, reverseStereo>(kernels, obuf, frames, numFrames, vol_l, vol_r);
+		obuf += numFrames * 2;
 
-		obuf += 2;
+		if (endOfInput)
+			break;
 	}
 	return (obuf - ostart) / 2;
 }
@@ -212,53 +227,75 @@ LinearRateConverter<stereo, reverseStereo>::LinearRateConverter(st_rate_t inrate
  */
 template<bool stereo, bool reverseStereo>
 int LinearRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+	const RateKernels &kernels = getRateKernels();
+	st_sample_t last[INTERMEDIATE_BUFFER_SIZE];
+	st_sample_t cur[INTERMEDIATE_BUFFER_SIZE];
+	uint16 frac[INTERMEDIATE_BUFFER_SIZE];
+	st_sample_t frames[INTERMEDIATE_BUFFER_SIZE];
 	st_sample_t *ostart, *oend;
 
 	ostart = obuf;
 	oend = obuf + osamp * 2;
 
 	while (obuf < oend) {
-
-		// read enough input samples so that opos < 0
-		while ((frac_t)FRAC_ONE <= opos) {
-			// Check if we have to refill the buffer
-			if (inLen == 0) {
-				inPtr = inBuf;
-				inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
-				if (inLen <= 0)
-					return (obuf - ostart) / 2;
+		// Collect the interpolation points for as many output frames as
+		// fit into the buffers, then interpolate and mix them in one go
+		const uint maxFrames = MIN<uint>((oend - obuf) / 2, ARRAYSIZE(frames) / (stereo ? 2 : 1));
+		uint numSamples = 0;
+		uint numFrames = 0;
+		bool endOfInput = false;
+
+		while (numFrames < maxFrames) {
+			// read enough input samples so that opos < 0
+			while ((frac_t)FRAC_ONE <= opos) {
+				// Check if we have to refill the buffer
+				if (inLen == 0) {
+					inPtr = inBuf;
+					inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
+					if (inLen <= 0) {
+						endOfInput = true;
+						break;
+					}
+				}
+				inLen -= (stereo ? 2 : 1);
+				ilast0 = icur0;
+				icur0 = *inPtr++;
+				if (stereo) {
+					ilast1 = icur1;
+					icur1 = *inPtr++;
+				}
+				opos -= FRAC_ONE;
 			}
-			inLen -= (stereo ? 2 : 1);
-			ilast0 = icur0;
-			icur0 = *inPtr++;
-			if (stereo) {
-				ilast1 = icur1;
-				icur1 = *inPtr++;
+
+			if (endOfInput)
+				break;
+
+			// Loop as long as the outpos trails behind, and as long as there is
+			// still space in the output buffer.
+			while (opos < (frac_t)FRAC_ONE && numFrames < maxFrames) {
+				last[numSamples] = ilast0;
+				cur[numSamples] = icur0;
+				frac[numSamples] = (uint16)opos;
+				numSamples++;
+				if (stereo) {
+					last[numSamples] = ilast1;
+					cur[numSamples] = icur1;
+					frac[numSamples] = (uint16)opos;
+					numSamples++;
+				}
+				numFrames++;
+
+				// Increment output position
+				opos += opos_inc;
 			}
-			opos -= FRAC_ONE;
 		}
 
-		// Loop as long as the outpos trails behind, and as long as there is
-		// still space in the output buffer.
-		while (opos < (frac_t)FRAC_ONE && obuf < oend) {
-			// interpolate
-			st_sample_t out0, out1;
-			out0 = (st_sample_t)(ilast0 + (((icur0 - ilast0) * opos + FRAC_HALF) >> FRAC_BITS));
-			out1 = (stereo ?
-						  (st_sample_t)(ilast1 + (((icur1 - ilast1) * opos + FRAC_HALF) >> FRAC_BITS)) :
-						  out0);
-
-			// output left channel
-			clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
-
-			// output right channel
-			clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
-
-			obuf += 2;
+		kernels.interpolate(frames, last, cur, frac, numSamples);
+		mixFrames<stereo, reverseStereo>(kernels, obuf, frames, numFrames, vol_l, vol_r);
+		obuf += numFrames * 2;
 
-			// Increment output position
-			opos += opos_inc;
-		}
+		if (endOfInput)
+			break;
 	}
 	return (obuf - ostart) / 2;
 }
@@ -283,11 +320,6 @@ public:
 	virtual int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
 		assert(input.isStereo() == stereo);
 
-		st_sample_t *ptr;
-		st_size_t len;
-
-		st_sample_t *ostart = obuf;
-
 		if (stereo)
 			osamp *= 2;
 
@@ -302,24 +334,14 @@ public:
 			error("[CopyRateConverter::flow] Cannot allocate memory for temp buffer");
 
 		// Read up to 'osamp' samples into our temporary buffer
-		len = input.readBuffer(_buffer, osamp);
+		const int len = input.readBuffer(_buffer, osamp);
+		if (len <= 0)
+			return 0;
 
 		// Mix the data into the output buffer
-		ptr = _buffer;
-		for (; len > 0; len -= (stereo ? 2 : 1)) {
-			st_sample_t out0, out1;
-			out0 = *ptr++;
-			out1 = (stereo ? *ptr++ : out0);
-
-			// output left channel
-			clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
-
-			// output right channel
-			clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
-
-			obuf += 2;
-		}
-		return (obuf - ostart) / 2;
+		const uint numFrames = len / (stereo ? 2 : 1);
+		mixFrames<stereo, reverseStereo>(getRateKernels(), obuf, _buffer, numFrames, vol_l, vol_r);
+		return numFrames;
 	}
 
 	virtual int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
@@ -343,10 +365,13 @@ RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate) {
 	}
 }
 
-/**
- * Create and return a RateConverter object for the specified input and output rates.
- */
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo) {
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo, RateConverterQuality quality) {
+	if (inrate != outrate && (quality != kRateConverterFast || inrate >= 65536 || outrate >= 65536)) {
+		if (quality == kRateConverterFast)
+			quality = kRateConverterSincLow;
+		return makeSincRateConverter(inrate, outrate, stereo, reverseStereo, quality);
+	}
+
 	if (stereo) {
 		if (reverseStereo)
 			return makeRateConverter<true, true>(inrate, outrate);
@@ -78,7 +78,37 @@ public:
 	virtual int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) = 0;
 };
 
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo = false);
+/**
+ * The available rate conversion methods, from the cheapest to the most
+ * accurate one.
+ */
+enum RateConverterQuality {
+	/** Nearest neighbour or linear interpolation, in fixed point math. */
+	kRateConverterFast,
+	/** Windowed sinc interpolation with short filters. */
+	kRateConverterSincLow,
+	/** Windowed sinc interpolation with medium length filters. */
+	kRateConverterSincMedium,
+	/** Windowed sinc interpolation with long filters. */
+	kRateConverterSincHigh
+};
+
+/**
+ * Create and return a RateConverter object for the specified input and output rates.
+ *
+ * Converters for equal rates never resample, regardless of the quality.
+ * The fast converters can only handle rates < 65536, so windowed sinc
+ * interpolation is used for higher rates in any case.
+ */
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo = false, RateConverterQuality quality = kRateConverterFast);
+
+/**
+ * Create a polyphase windowed sinc rate converter. Its filter coefficients
+ * are computed once when the converter is created.
+ *
+ * @param quality one of the kRateConverterSinc* values
+ */
+RateConverter *makeSincRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo, RateConverterQuality quality);
 
 } // End of namespace Audio
 
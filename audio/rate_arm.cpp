@@ -436,7 +436,13 @@ public:
 /**
  * Create and return a RateConverter object for the specified input and output rates.
  */
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo) {
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo, RateConverterQuality quality) {
+	if (inrate != outrate && (quality != kRateConverterFast || inrate >= 65536 || outrate >= 65536)) {
+		if (quality == kRateConverterFast)
+			quality = kRateConverterSincLow;
+		return makeSincRateConverter(inrate, outrate, stereo, reverseStereo, quality);
+	}
+
 	if (inrate != outrate) {
 		if ((inrate % outrate) == 0) {
 			if (stereo) {
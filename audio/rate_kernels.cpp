@@ -0,0 +1,343 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "audio/rate_kernels.h"
+#include "audio/mixer.h"
+#include "common/frac.h"
+
+#ifndef OUTPUT_UNSIGNED_AUDIO
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AUDIO_RATE_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define AUDIO_RATE_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
+namespace Audio {
+
+#pragma mark -
+#pragma mark --- Portable kernels ---
+#pragma mark -
+
+static void mixMonoScalar(st_sample_t *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r) {
+	for (uint i = 0; i < frames; i++) {
+		clampedAdd(obuf[0], (in[i] * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+		clampedAdd(obuf[1], (in[i] * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+		obuf += 2;
+	}
+}
+
+static void mixStereoScalar(st_sample_t *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r, bool reverseStereo) {
+	const int left = reverseStereo ? 1 : 0;
+
+	for (uint i = 0; i < frames; i++) {
+		clampedAdd(obuf[left    ], (in[0] * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+		clampedAdd(obuf[left ^ 1], (in[1] * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+		obuf += 2;
+		in += 2;
+	}
+}
+
+static void interpolateScalar(st_sample_t *out, const st_sample_t *last, const st_sample_t *cur, const uint16 *frac, uint count) {
+	for (uint i = 0; i < count; i++) {
+		// The full product of the difference (17 bits) and the fraction
+		// (16 bits) does not fit into an int, so multiply in two steps.
+		// The result is the same as that of the straightforward formula.
+		const int diff = cur[i] - last[i];
+		const int hi = diff * (frac[i] >> 8);
+		const int lo = diff * (frac[i] & 0xFF);
+		out[i] = (st_sample_t)(last[i] + ((hi + ((lo + FRAC_HALF) >> 8)) >> (FRAC_BITS - 8)));
+	}
+}
+
+static int32 dotProductScalar(const int16 *a, const int16 *b, uint count) {
+	int32 sum = 0;
+	for (uint i = 0; i < count; i++)
+		sum += a[i] * b[i];
+	return sum;
+}
+
+static const RateKernels s_scalarKernels = {
+	"scalar",
+	mixMonoScalar,
+	mixStereoScalar,
+	interpolateScalar,
+	dotProductScalar
+};
+
+#ifdef AUDIO_RATE_SSE2
+
+#pragma mark -
+#pragma mark --- SSE2 kernels ---
+#pragma mark -
+
+/**
+ * Multiplies eight samples by their volumes and divides the result by
+ * Mixer::kMaxMixerVolume, rounding towards zero just like the C code.
+ */
+static inline __m128i scaleSSE2(__m128i samples, __m128i vol) {
+	const __m128i lo = _mm_mullo_epi16(samples, vol);
+	const __m128i hi = _mm_mulhi_epi16(samples, vol);
+	const __m128i bias = _mm_set1_epi32(Audio::Mixer::kMaxMixerVolume - 1);
+
+	__m128i p0 = _mm_unpacklo_epi16(lo, hi);
+	__m128i p1 = _mm_unpackhi_epi16(lo, hi);
+	p0 = _mm_srai_epi32(_mm_add_epi32(p0, _mm_and_si128(_mm_srai_epi32(p0, 31), bias)), 8);
+	p1 = _mm_srai_epi32(_mm_add_epi32(p1, _mm_and_si128(_mm_srai_epi32(p1, 31), bias)), 8);
+
+	return _mm_packs_epi32(p0, p1);
+}
+
+static inline void mixSSE2(st_sample_t *obuf, __m128i scaled) {
+	const __m128i out = _mm_loadu_si128((const __m128i *)obuf);
+	_mm_storeu_si128((__m128i *)obuf, _mm_adds_epi16(out, scaled));
+}
+
+static void mixMonoSSE2(st_sample_t *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r) {
+	const __m128i vol = _mm_set_epi16(vol_r, vol_l, vol_r, vol_l, vol_r, vol_l, vol_r, vol_l);
+
+	uint i = 0;
+	for (; i + 8 <= frames; i += 8) {
+		const __m128i samples = _mm_loadu_si128((const __m128i *)(in + i));
+		mixSSE2(obuf, scaleSSE2(_mm_unpacklo_epi16(samples, samples), vol));
+		mixSSE2(obuf + 8, scaleSSE2(_mm_unpackhi_epi16(samples, samples), vol));
+		obuf += 16;
+	}
+
+	mixMonoScalar(obuf, in + i, frames - i, vol_l, vol_r);
+}
+
+static void mixStereoSSE2(st_sample_t *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r, bool reverseStereo) {
+	// With reversed stereo, the right input channel is scaled by vol_r and
+	// ends up in the left output channel. So swap the samples of each frame
+	// and use the volumes in reverse order.
+	const __m128i vol = reverseStereo ?
+	                    _mm_set_epi16(vol_l, vol_r, vol_l, vol_r, vol_l, vol_r, vol_l, vol_r) :
+	                    _mm_set_epi16(vol_r, vol_l, vol_r, vol_l, vol_r, vol_l, vol_r, vol_l);
+
+	uint i = 0;
+	for (; i + 4 <= frames; i += 4) {
+		__m128i samples = _mm_loadu_si128((const __m128i *)in);
+		if (reverseStereo) {
+			samples = _mm_shufflelo_epi16(samples, _MM_SHUFFLE(2, 3, 0, 1));
+			samples = _mm_shufflehi_epi16(samples, _MM_SHUFFLE(2, 3, 0, 1));
+		}
+		mixSSE2(obuf, scaleSSE2(samples, vol));
+		obuf += 8;
+		in += 8;
+	}
+
+	mixStereoScalar(obuf, in, frames - i, vol_l, vol_r, reverseStereo);
+}
+
+static void interpolateSSE2(st_sample_t *out, const st_sample_t *last, const st_sample_t *cur, const uint16 *frac, uint count) {
+	// SSE2 has no 32 bit multiplication which keeps the low half, so
+	// compute (diff + FRAC_ONE) * frac with the unsigned 32x32->64 bit
+	// multiplication instead and subtract frac from the result afterwards.
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i one = _mm_set1_epi32(FRAC_ONE);
+	const __m128i half = _mm_set_epi32(0, FRAC_HALF, 0, FRAC_HALF);
+
+	uint i = 0;
+	for (; i + 4 <= count; i += 4) {
+		const __m128i l16 = _mm_loadl_epi64((const __m128i *)(last + i));
+		const __m128i c16 = _mm_loadl_epi64((const __m128i *)(cur + i));
+		const __m128i l32 = _mm_srai_epi32(_mm_unpacklo_epi16(l16, l16), 16);
+		const __m128i c32 = _mm_srai_epi32(_mm_unpacklo_epi16(c16, c16), 16);
+		const __m128i f32 = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *)(frac + i)), zero);
+
+		const __m128i u = _mm_add_epi32(_mm_sub_epi32(c32, l32), one);
+		const __m128i even = _mm_srli_epi64(_mm_add_epi64(_mm_mul_epu32(u, f32), half), FRAC_BITS);
+		const __m128i odd = _mm_srli_epi64(_mm_add_epi64(_mm_mul_epu32(_mm_srli_epi64(u, 32), _mm_srli_epi64(f32, 32)), half), FRAC_BITS);
+		const __m128i q = _mm_or_si128(even, _mm_slli_epi64(odd, 32));
+		const __m128i r = _mm_add_epi32(_mm_sub_epi32(q, f32), l32);
+
+		_mm_storel_epi64((__m128i *)(out + i), _mm_packs_epi32(r, r));
+	}
+
+	interpolateScalar(out + i, last + i, cur + i, frac + i, count - i);
+}
+
+static int32 dotProductSSE2(const int16 *a, const int16 *b, uint count) {
+	__m128i sum = _mm_setzero_si128();
+
+	uint i = 0;
+	for (; i + 8 <= count; i += 8)
+		sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_loadu_si128((const __m128i *)(a + i)), _mm_loadu_si128((const __m128i *)(b + i))));
+
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+
+	return _mm_cvtsi128_si32(sum) + dotProductScalar(a + i, b + i, count - i);
+}
+
+static const RateKernels s_sse2Kernels = {
+	"SSE2",
+	mixMonoSSE2,
+	mixStereoSSE2,
+	interpolateSSE2,
+	dotProductSSE2
+};
+
+static bool hasSSE2() {
+#if defined(__x86_64__) || defined(_M_X64)
+	return true;
+#elif defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 8))
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("sse2");
+#else
+	// The compiler was told to target SSE2, so it may use it anywhere
+	return true;
+#endif
+}
+
+#endif // AUDIO_RATE_SSE2
+
+#ifdef AUDIO_RATE_NEON
+
+#pragma mark -
+#pragma mark --- NEON kernels ---
+#pragma mark -
+
+/**
+ * Multiplies four samples by their volumes and divides the result by
+ * Mixer::kMaxMixerVolume, rounding towards zero just like the C code.
+ */
+static inline int16x4_t scaleNEON(int16x4_t samples, int16x4_t vol) {
+	int32x4_t p = vmull_s16(samples, vol);
+	const int32x4_t bias = vandq_s32(vshrq_n_s32(p, 31), vdupq_n_s32(Audio::Mixer::kMaxMixerVolume - 1));
+	return vshrn_n_s32(vaddq_s32(p, bias), 8);
+}
+
+static inline void mixNEON(st_sample_t *obuf, int16x4_t lo, int16x4_t hi) {
+	vst1q_s16(obuf, vqaddq_s16(vld1q_s16(obuf), vcombine_s16(lo, hi)));
+}
+
+static void mixMonoNEON(st_sample_t *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r) {
+	const int16 volumes[4] = { (int16)vol_l, (int16)vol_r, (int16)vol_l, (int16)vol_r };
+	const int16x4_t vol = vld1_s16(volumes);
+
+	uint i = 0;
+	for (; i + 4 <= frames; i += 4) {
+		const int16x4_t samples = vld1_s16(in + i);
+		const int16x4x2_t dup = vzip_s16(samples, samples);
+		mixNEON(obuf, scaleNEON(dup.val[0], vol), scaleNEON(dup.val[1], vol));
+		obuf += 8;
+	}
+
+	mixMonoScalar(obuf, in + i, frames - i, vol_l, vol_r);
+}
+
+static void mixStereoNEON(st_sample_t *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r, bool reverseStereo) {
+	// See mixStereoSSE2 for how reversed stereo is handled
+	const int16 first = reverseStereo ? vol_r : vol_l;
+	const int16 second = reverseStereo ? vol_l : vol_r;
+	const int16 volumes[4] = { first, second, first, second };
+	const int16x4_t vol = vld1_s16(volumes);
+
+	uint i = 0;
+	for (; i + 4 <= frames; i += 4) {
+		int16x8_t samples = vld1q_s16(in);
+		if (reverseStereo)
+			samples = vrev32q_s16(samples);
+		mixNEON(obuf, scaleNEON(vget_low_s16(samples), vol), scaleNEON(vget_high_s16(samples), vol));
+		obuf += 8;
+		in += 8;
+	}
+
+	mixStereoScalar(obuf, in, frames - i, vol_l, vol_r, reverseStereo);
+}
+
+static void interpolateNEON(st_sample_t *out, const st_sample_t *last, const st_sample_t *cur, const uint16 *frac, uint count) {
+	const int64x2_t half = vdupq_n_s64(FRAC_HALF);
+
+	uint i = 0;
+	for (; i + 4 <= count; i += 4) {
+		const int32x4_t l32 = vmovl_s16(vld1_s16(last + i));
+		const int32x4_t diff = vsubq_s32(vmovl_s16(vld1_s16(cur + i)), l32);
+		const int32x4_t f32 = vreinterpretq_s32_u32(vmovl_u16(vld1_u16(frac + i)));
+
+		const int64x2_t p0 = vmull_s32(vget_low_s32(diff), vget_low_s32(f32));
+		const int64x2_t p1 = vmull_s32(vget_high_s32(diff), vget_high_s32(f32));
+		const int32x4_t q = vcombine_s32(vshrn_n_s64(vaddq_s64(p0, half), FRAC_BITS), vshrn_n_s64(vaddq_s64(p1, half), FRAC_BITS));
+
+		vst1_s16(out + i, vqmovn_s32(vaddq_s32(q, l32)));
+	}
+
+	interpolateScalar(out + i, last + i, cur + i, frac + i, count - i);
+}
+
+static int32 dotProductNEON(const int16 *a, const int16 *b, uint count) {
+	int32x4_t sum = vdupq_n_s32(0);
+
+	uint i = 0;
+	for (; i + 4 <= count; i += 4)
+		sum = vmlal_s16(sum, vld1_s16(a + i), vld1_s16(b + i));
+
+	const int32x2_t half = vadd_s32(vget_low_s32(sum), vget_high_s32(sum));
+	return vget_lane_s32(vpadd_s32(half, half), 0) + dotProductScalar(a + i, b + i, count - i);
+}
+
+static const RateKernels s_neonKernels = {
+	"NEON",
+	mixMonoNEON,
+	mixStereoNEON,
+	interpolateNEON,
+	dotProductNEON
+};
+
+#endif // AUDIO_RATE_NEON
+
+#pragma mark -
+
+static const RateKernels *selectRateKernels() {
+#ifdef AUDIO_RATE_SSE2
+	if (hasSSE2())
+		return &s_sse2Kernels;
+#endif
+#ifdef AUDIO_RATE_NEON
+	// NEON support is only compiled in when the target CPU is known
+	// to provide it.
+	return &s_neonKernels;
+#else
+	return &s_scalarKernels;
+#endif
+}
+
+const RateKernels &getRateKernels() {
+	// Picking the kernels twice from different threads is harmless, both
+	// arrive at the same result.
+	static const RateKernels *kernels = 0;
+	if (!kernels)
+		kernels = selectRateKernels();
+	return *kernels;
+}
+
+const RateKernels &getScalarRateKernels() {
+	return s_scalarKernels;
+}
+
+} // End of namespace Audio
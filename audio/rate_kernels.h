@@ -0,0 +1,98 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef AUDIO_RATE_KERNELS_H
+#define AUDIO_RATE_KERNELS_H
+
+#include "audio/rate.h"
+
+namespace Audio {
+
+/**
+ * The inner loops shared by the rate converters. Besides the portable
+ * implementation, there are SSE2 and NEON variants, which are picked at
+ * runtime by getRateKernels() when supported by the compiler and the CPU.
+ *
+ * All variants produce bit identical results.
+ */
+struct RateKernels {
+	/** Name of the implementation, for debugging purposes. */
+	const char *name;
+
+	/**
+	 * Scales the mono samples in by the given volumes and adds them to the
+	 * stereo output buffer, clamping the result.
+	 *
+	 * @param obuf   stereo output buffer, 2 * frames samples
+	 * @param in     mono input samples, frames samples
+	 * @param frames number of frames to mix
+	 * @param vol_l  volume for the left output channel (0 - Mixer::kMaxMixerVolume)
+	 * @param vol_r  volume for the right output channel (0 - Mixer::kMaxMixerVolume)
+	 */
+	void (*mixMono)(st_sample_t *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r);
+
+	/**
+	 * Like mixMono, but for interleaved stereo input. If reverseStereo is
+	 * set, the left input channel goes to the right output channel and
+	 * vice versa.
+	 */
+	void (*mixStereo)(st_sample_t *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r, bool reverseStereo);
+
+	/**
+	 * Linear interpolation between two sample sequences:
+	 * out[i] = last[i] + (((cur[i] - last[i]) * frac[i] + FRAC_HALF) >> FRAC_BITS)
+	 */
+	void (*interpolate)(st_sample_t *out, const st_sample_t *last, const st_sample_t *cur, const uint16 *frac, uint count);
+
+	/**
+	 * Returns the sum of a[i] * b[i]. The sum is accumulated in 32 bits,
+	 * so the caller has to make sure it cannot overflow.
+	 */
+	int32 (*dotProduct)(const int16 *a, const int16 *b, uint count);
+};
+
+/**
+ * Mixes the given frames into the output buffer, using the mono or stereo
+ * kernel as appropriate.
+ */
+template<bool stereo, bool reverseStereo>
+inline void mixFrames(const RateKernels &kernels, st_sample_t *obuf, const st_sample_t *frames, uint numFrames, st_volume_t vol_l, st_volume_t vol_r) {
+	if (stereo)
+		kernels.mixStereo(obuf, frames, numFrames, vol_l, vol_r, reverseStereo);
+	else
+		kernels.mixMono(obuf, frames, numFrames, vol_l, vol_r);
+}
+
+/**
+ * Returns the fastest kernel set available on this machine.
+ */
+const RateKernels &getRateKernels();
+
+/**
+ * Returns the portable kernel set, which serves as the reference for
+ * the optimized variants.
+ */
+const RateKernels &getScalarRateKernels();
+
+} // End of namespace Audio
+
+#endif
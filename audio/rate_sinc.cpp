@@ -0,0 +1,360 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "audio/audiostream.h"
+#include "audio/rate.h"
+#include "audio/rate_kernels.h"
+#include "common/math.h"
+#include "common/textconsole.h"
+#include "common/util.h"
+
+namespace Audio {
+
+/**
+ * The size of the intermediate input cache, see rate.cpp.
+ */
+#define INTERMEDIATE_BUFFER_SIZE 512
+
+/**
+ * Coefficients are stored as fixed point numbers with this many fractional
+ * bits. This leaves two bits of headroom for the 32 bit accumulation of
+ * the filter output.
+ */
+#define COEFF_BITS 14
+
+/**
+ * The maximal number of filter phases. If the reduced output rate is
+ * higher, the position between two input samples is rounded to the
+ * nearest one of MAX_PHASES phases.
+ */
+#define MAX_PHASES 1024
+
+/** The maximal number of filter taps. Limits the cost of downsampling. */
+#define MAX_TAPS 256
+
+struct SincQualitySettings {
+	/** Number of filter taps when upsampling. Must be a multiple of 8. */
+	uint taps;
+	/** Passband width, relative to the lower of the two Nyquist frequencies. */
+	double rolloff;
+	/** Shape parameter of the Kaiser window. */
+	double beta;
+};
+
+static const SincQualitySettings s_sincQuality[] = {
+	{ 16, 0.85, 5.0 },  // kRateConverterSincLow
+	{ 32, 0.91, 7.0 },  // kRateConverterSincMedium
+	{ 64, 0.95, 9.0 }   // kRateConverterSincHigh
+};
+
+/**
+ * Zeroth order modified Bessel function of the first kind, used for the
+ * Kaiser window.
+ */
+static double besselI0(double x) {
+	double sum = 1.0, term = 1.0;
+	const double halfX = x / 2.0;
+	for (int k = 1; k < 50; k++) {
+		term *= (halfX / k) * (halfX / k);
+		sum += term;
+		if (term < sum * 1e-12)
+			break;
+	}
+	return sum;
+}
+
+static uint32 gcd(uint32 a, uint32 b) {
+	while (b) {
+		const uint32 t = a % b;
+		a = b;
+		b = t;
+	}
+	return a;
+}
+
+/**
+ * Audio rate converter based on band limited interpolation with a windowed
+ * sinc filter.
+ *
+ * The rates are reduced to the smallest integer ratio inStep / outStep,
+ * which allows tracking the position in the input stream exactly, without
+ * any limit on the rates. For every output frame, one of the precomputed
+ * filter phases is applied to the input samples around that position.
+ * Both the position and the phase are advanced with integer steps and
+ * remainders, so no division is needed per output frame.
+ */
+template<bool stereo, bool reverseStereo>
+class SincRateConverter : public RateConverter {
+protected:
+	enum {
+		kChannels = stereo ? 2 : 1
+	};
+
+	st_sample_t inBuf[INTERMEDIATE_BUFFER_SIZE];
+
+	/** Deinterleaved input samples, one buffer per channel. */
+	int16 *_history[kChannels];
+	uint _historySize;
+	/** Index of the first input sample used for the next output frame. */
+	uint _histStart;
+	/** Number of valid samples in the history buffers. */
+	uint _histEnd;
+
+	/** The rate ratio, reduced to lowest terms. */
+	uint32 _inStep, _outStep;
+	/** Input samples and 1/_outStep fractions to advance per output frame. */
+	uint32 _inSkip, _inFrac;
+	/** Position between _histStart and the next sample, in 1/_outStep units. */
+	uint32 _pos;
+
+	/**
+	 * The filter phase of _pos, rounded to the nearest one. It is kept as
+	 * a whole number of phases plus a remainder in 1/_outStep units, which
+	 * starts at _outStep / 2 to round. The phase is _numPhases if the
+	 * position is rounded up to the next sample.
+	 */
+	uint32 _phase, _phaseFrac;
+	/** Phases and 1/_outStep fractions to advance per output frame. */
+	uint32 _phaseStep, _phaseStepFrac;
+
+	uint _taps;
+	uint _numPhases;
+	/** Coefficients of the phases 0 to _numPhases, _taps for each. */
+	int16 *_coeffs;
+
+	bool refill(AudioStream &input);
+
+public:
+	SincRateConverter(st_rate_t inrate, st_rate_t outrate, RateConverterQuality quality);
+	~SincRateConverter();
+
+	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
+	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
+		return ST_SUCCESS;
+	}
+};
+
+template<bool stereo, bool reverseStereo>
+SincRateConverter<stereo, reverseStereo>::SincRateConverter(st_rate_t inrate, st_rate_t outrate, RateConverterQuality quality) {
+	assert(quality >= kRateConverterSincLow && quality <= kRateConverterSincHigh);
+	const SincQualitySettings &settings = s_sincQuality[quality - kRateConverterSincLow];
+
+	if (inrate == 0 || outrate == 0)
+		error("SincRateConverter: invalid rates %d -> %d", inrate, outrate);
+
+	const uint32 div = gcd(inrate, outrate);
+	_inStep = inrate / div;
+	_outStep = outrate / div;
+	_inSkip = _inStep / _outStep;
+	_inFrac = _inStep % _outStep;
+	_pos = 0;
+
+	// The phase step below must not overflow
+	if (_outStep > 0xFFFFFFFF / MAX_PHASES)
+		error("SincRateConverter: unsupported rates %d -> %d", inrate, outrate);
+
+	// Every output frame must not skip more input samples than fit into
+	// the input buffer
+	if (inrate / outrate >= INTERMEDIATE_BUFFER_SIZE / 2)
+		error("SincRateConverter: cannot downsample from %d to %d Hz", inrate, outrate);
+
+	// When downsampling, the filter has to cut off below the output
+	// Nyquist frequency. This widens the impulse response, so more taps
+	// are needed to keep the same transition band.
+	const double scale = MIN<double>(1.0, (double)outrate / inrate);
+	_taps = (uint)ceil(settings.taps / scale / 8.0) * 8;
+	if (_taps > MAX_TAPS)
+		_taps = MAX_TAPS;
+	_numPhases = MIN<uint32>(_outStep, MAX_PHASES);
+
+	_phase = 0;
+	_phaseFrac = _outStep / 2;
+	_phaseStep = _inFrac * _numPhases / _outStep;
+	_phaseStepFrac = _inFrac * _numPhases % _outStep;
+
+	_coeffs = new int16[(_numPhases + 1) * _taps];
+
+	const double cutoff = scale * settings.rolloff;
+	const double halfLength = _taps / 2.0;
+	const double windowNorm = besselI0(settings.beta);
+	double *phase = new double[_taps];
+
+	for (uint p = 0; p <= _numPhases; p++) {
+		// Tap i is applied to the input sample at distance x from the
+		// output position. The center of the filter lies between taps
+		// _taps / 2 - 1 and _taps / 2.
+		const double offset = (double)p / _numPhases;
+		double sum = 0.0;
+
+		for (uint i = 0; i < _taps; i++) {
+			const double x = (double)i - (halfLength - 1.0) - offset;
+			const double t = x / halfLength;
+			double value = cutoff;
+			if (x != 0.0)
+				value = sin(M_PI * cutoff * x) / (M_PI * x);
+			if (t > -1.0 && t < 1.0)
+				value *= besselI0(settings.beta * sqrt(1.0 - t * t)) / windowNorm;
+			else
+				value = 0.0;
+
+			phase[i] = value;
+			sum += value;
+		}
+
+		// Normalize every phase to unity gain, so that there is no ripple
+		// on constant signals. The rounding error goes to the largest tap.
+		int16 *c = _coeffs + p * _taps;
+		int total = 0;
+		uint largest = 0;
+		for (uint i = 0; i < _taps; i++) {
+			const double value = floor(phase[i] / sum * (1 << COEFF_BITS) + 0.5);
+			c[i] = (int16)CLIP<double>(value, -32768.0, 32767.0);
+			total += c[i];
+			if (c[i] > c[largest])
+				largest = i;
+		}
+		c[largest] += (1 << COEFF_BITS) - total;
+	}
+
+	delete[] phase;
+
+	// Start with silence in front of the input, so that the first output
+	// frame lies right at the first input sample
+	_historySize = _taps + INTERMEDIATE_BUFFER_SIZE;
+	for (int ch = 0; ch < kChannels; ch++) {
+		_history[ch] = new int16[_historySize];
+		memset(_history[ch], 0, _historySize * sizeof(int16));
+	}
+	_histStart = 0;
+	_histEnd = _taps / 2 - 1;
+}
+
+template<bool stereo, bool reverseStereo>
+SincRateConverter<stereo, reverseStereo>::~SincRateConverter() {
+	for (int ch = 0; ch < kChannels; ch++)
+		delete[] _history[ch];
+	delete[] _coeffs;
+}
+
+/*
+ * Appends new input samples to the history buffers.
+ * Returns false if no input was available.
+ */
+template<bool stereo, bool reverseStereo>
+bool SincRateConverter<stereo, reverseStereo>::refill(AudioStream &input) {
+	// Drop the samples which are not needed anymore
+	if (_histStart > 0) {
+		const uint keep = _histEnd > _histStart ? _histEnd - _histStart : 0;
+		for (int ch = 0; ch < kChannels; ch++)
+			memmove(_history[ch], _history[ch] + _histStart, keep * sizeof(int16));
+		_histStart = _histStart > _histEnd ? _histStart - _histEnd : 0;
+		_histEnd = keep;
+	}
+
+	const int maxSamples = MIN<int>(ARRAYSIZE(inBuf), (_historySize - _histEnd) * kChannels);
+	const int len = input.readBuffer(inBuf, maxSamples);
+	if (len <= 0)
+		return false;
+
+	const st_sample_t *in = inBuf;
+	for (int i = 0; i < len / kChannels; i++) {
+		for (int ch = 0; ch < kChannels; ch++)
+			_history[ch][_histEnd] = *in++;
+		_histEnd++;
+	}
+	return true;
+}
+
+/*
+ * Processed signed long samples from ibuf to obuf.
+ * Return number of sample pairs processed.
+ */
+template<bool stereo, bool reverseStereo>
+int SincRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+	const RateKernels &kernels = getRateKernels();
+	st_sample_t frames[INTERMEDIATE_BUFFER_SIZE];
+	st_sample_t *ostart, *oend;
+
+	ostart = obuf;
+	oend = obuf + osamp * 2;
+
+	while (obuf < oend) {
+		const uint maxFrames = MIN<uint>((oend - obuf) / 2, ARRAYSIZE(frames) / kChannels);
+		st_sample_t *fptr = frames;
+		uint numFrames = 0;
+		bool endOfInput = false;
+
+		while (numFrames < maxFrames) {
+			// Make sure all input samples covered by the filter are there
+			if (_histStart + _taps > _histEnd) {
+				if (!refill(input)) {
+					endOfInput = true;
+					break;
+				}
+				continue;
+			}
+
+			const int16 *coeffs = _coeffs + _phase * _taps;
+
+			for (int ch = 0; ch < kChannels; ch++) {
+				const int32 sum = kernels.dotProduct(_history[ch] + _histStart, coeffs, _taps);
+				const int value = (sum + (1 << (COEFF_BITS - 1))) >> COEFF_BITS;
+				*fptr++ = (st_sample_t)CLIP<int>(value, ST_SAMPLE_MIN, ST_SAMPLE_MAX);
+			}
+			numFrames++;
+
+			// Advance to the next output position
+			_histStart += _inSkip;
+			_pos += _inFrac;
+			_phase += _phaseStep;
+			_phaseFrac += _phaseStepFrac;
+			if (_phaseFrac >= _outStep) {
+				_phaseFrac -= _outStep;
+				_phase++;
+			}
+			if (_pos >= _outStep) {
+				_pos -= _outStep;
+				_phase -= _numPhases;
+				_histStart++;
+			}
+		}
+
+		mixFrames<stereo, reverseStereo>(kernels, obuf, frames, numFrames, vol_l, vol_r);
+		obuf += numFrames * 2;
+
+		if (endOfInput)
+			break;
+	}
+	return (obuf - ostart) / 2;
+}
+
+RateConverter *makeSincRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo, RateConverterQuality quality) {
+	if (stereo) {
+		if (reverseStereo)
+			return new SincRateConverter<true, true>(inrate, outrate, quality);
+		else
+			return new SincRateConverter<true, false>(inrate, outrate, quality);
+	} else
+		return new SincRateConverter<false, false>(inrate, outrate, quality);
+}
+
+} // End of namespace Audio
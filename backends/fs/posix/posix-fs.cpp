@@ -30,8 +30,10 @@
 #define FORBIDDEN_SYMBOL_EXCEPTION_exit		//Needed for IRIX's unistd.h
 
 #include "backends/fs/posix/posix-fs.h"
+#include "backends/fs/posix/posix-mmap-stream.h"
 #include "backends/fs/stdiostream.h"
 #include "common/algorithm.h"
+#include "common/config-manager.h"
 
 #include <sys/param.h>
 #include <sys/stat.h>
@@ -242,7 +244,30 @@ AbstractFSNode *POSIXFilesystemNode::getParent() const {
 	return makeNode(Common::String(start, end));
 }
 
+#if defined(POSIX) && !defined(__OS2__)
+/**
+ * Check whether the given path is in the directory the savefile manager
+ * keeps saved games in. Saved games are rewritten in place, so they are
+ * never mapped into memory, see PosixMmapStream.
+ */
+static bool isInSavePath(const Common::String &path) {
+	const Common::String savePath = ConfMan.get("savepath");
+	if (savePath.empty())
+		return false;
+
+	return path.hasPrefix(POSIXFilesystemNode(savePath).getPath() + "/");
+}
+#endif
+
 Common::SeekableReadStream *POSIXFilesystemNode::createReadStream() {
+#if defined(POSIX) && !defined(__OS2__)
+	// Map larger files into memory, which saves copying data around
+	if (!isInSavePath(getPath())) {
+		Common::SeekableReadStream *mapped = PosixMmapStream::makeFromPath(getPath());
+		if (mapped)
+			return mapped;
+	}
+#endif
 	return StdioStream::makeFromPath(getPath(), false);
 }
 
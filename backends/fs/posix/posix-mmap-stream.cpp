@@ -0,0 +1,99 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#if defined(POSIX) && !defined(__OS2__)
+
+// Re-enable some forbidden symbols to avoid clashes with stat.h and unistd.h.
+#define FORBIDDEN_SYMBOL_EXCEPTION_time_h
+#define FORBIDDEN_SYMBOL_EXCEPTION_unistd_h
+#define FORBIDDEN_SYMBOL_EXCEPTION_mkdir
+
+#include "backends/fs/posix/posix-mmap-stream.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/vfs.h>
+#endif
+
+static bool isLocalFilesystem(int fd) {
+#ifdef __linux__
+	struct statfs fs;
+	if (fstatfs(fd, &fs) != 0)
+		return false;
+
+	switch ((uint32)fs.f_type) {
+	case 0x6969:		// NFS
+	case 0x517B:		// SMB
+	case 0xFF534D42:	// CIFS
+	case 0x65735546:	// FUSE, e.g. sshfs
+		return false;
+	default:
+		break;
+	}
+#endif
+	return true;
+}
+
+PosixMmapStream::PosixMmapStream(const byte *mapping, uint32 size)
+	: Common::MemoryReadStream(mapping, size), _mapping(mapping), _mappingSize(size) {
+}
+
+PosixMmapStream::~PosixMmapStream() {
+	munmap(const_cast<byte *>(_mapping), _mappingSize);
+}
+
+PosixMmapStream *PosixMmapStream::makeFromPath(const Common::String &path) {
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		return 0;
+
+	// Accessing a mapped page beyond the end of a file raises SIGBUS, so
+	// files on network filesystems, which may change behind our back, are
+	// not mapped
+	struct stat st;
+	void *mapping = MAP_FAILED;
+	if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) &&
+	    st.st_size >= kMinMapSize && st.st_size <= 0x7FFFFFFF &&
+	    isLocalFilesystem(fd))
+		mapping = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+	// Check that the file has not changed size while it was mapped
+	struct stat mappedSt;
+	if (mapping != MAP_FAILED && (fstat(fd, &mappedSt) != 0 || mappedSt.st_size != st.st_size)) {
+		munmap(mapping, st.st_size);
+		mapping = MAP_FAILED;
+	}
+
+	// The mapping stays valid after the file is closed
+	close(fd);
+
+	if (mapping == MAP_FAILED)
+		return 0;
+
+	return new PosixMmapStream((const byte *)mapping, st.st_size);
+}
+
+#endif
@@ -0,0 +1,72 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef BACKENDS_FS_POSIX_MMAP_STREAM_H
+#define BACKENDS_FS_POSIX_MMAP_STREAM_H
+
+#include "common/scummsys.h"
+#include "common/memstream.h"
+#include "common/noncopyable.h"
+#include "common/str.h"
+
+/**
+ * A read stream for a file which is mapped into memory. Reading from it
+ * needs no system calls, and the contents can be accessed directly with
+ * getData(), without copying them.
+ *
+ * This is only meant for game data, which nothing writes to while the game
+ * runs; POSIXFilesystemNode never maps saved games. If another process
+ * truncates a file while it is mapped, reading the part that is gone raises
+ * SIGBUS and ScummVM crashes. There is no portable way to guard against
+ * this short of not mapping the file at all.
+ */
+class PosixMmapStream : public Common::MemoryReadStream, public Common::NonCopyable {
+protected:
+	const byte *_mapping;
+	uint32 _mappingSize;
+
+	PosixMmapStream(const byte *mapping, uint32 size);
+
+public:
+	enum {
+		/**
+		 * Smaller files are not worth the cost of creating a mapping
+		 * and are read with regular buffered I/O instead.
+		 */
+		kMinMapSize = 32 * 1024
+	};
+
+	/**
+	 * Map the file with the given path into memory. Returns 0 if the file
+	 * should not or cannot be mapped: if it is too small, not a regular file,
+	 * or located on a network filesystem, where the contents could go away
+	 * while being mapped. The caller falls back to buffered reads then.
+	 */
+	static PosixMmapStream *makeFromPath(const Common::String &path);
+
+	virtual ~PosixMmapStream();
+
+	/** Return the mapped contents of the file, which stay valid as long as the stream exists. */
+	const byte *getData() const { return _mapping; }
+};
+
+#endif
@@ -93,6 +93,8 @@ void SdlMixerManager::init() {
 
 		_mixer = new Audio::MixerImpl(g_system, _obtained.freq);
 		assert(_mixer);
+		if (ConfMan.getBool("mixer_queue"))
+			_mixer->setCommandQueue(true);
 		_mixer->setReady(true);
 
 		startAudio();
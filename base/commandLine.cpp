@@ -192,6 +192,9 @@ void registerDefaults() {
 	ConfMan.registerDefault("mt32_device", "null");
 	ConfMan.registerDefault("gm_device", "null");
 
+	ConfMan.registerDefault("mixer_queue", false);
+	ConfMan.registerDefault("resampler_quality", "fast");
+
 	ConfMan.registerDefault("cdrom", 0);
 
 	ConfMan.registerDefault("enable_unsupported_game_warning", true);
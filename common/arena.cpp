@@ -0,0 +1,274 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/arena.h"
+#include "common/mutex.h"
+#include "common/textconsole.h"
+
+namespace Common {
+
+// Multiples of 16 up to 128, then four classes per power of two. Apart from
+// the first one, all sizes are multiples of kAlignment.
+const uint16 Arena::_sizeClasses[kNumSizeClasses] = {
+	8, 16, 32, 48, 64, 80, 96, 112, 128,
+	160, 192, 224, 256,
+	320, 384, 448, 512,
+	640, 768, 896, 1024,
+	1280, 1536, 1792, 2048
+};
+
+Arena::Arena(bool threadSafe) {
+	_mutex = threadSafe ? new Mutex() : 0;
+
+	uint sizeClass = 0;
+	for (uint i = 0; i <= kMaxSmallSize / 8; ++i) {
+		while (_sizeClasses[sizeClass] < i * 8)
+			++sizeClass;
+		_classForSize[i] = sizeClass;
+	}
+
+	for (uint i = 0; i < kNumSizeClasses; ++i)
+		_partialPages[i] = 0;
+	_freePages = 0;
+	_largePages = 0;
+	_largeSize = 0;
+	_usedSize = 0;
+}
+
+Arena::~Arena() {
+	releaseLarge();
+	releaseBlocks();
+	delete _mutex;
+}
+
+void Arena::lock() {
+	if (_mutex)
+		_mutex->lock();
+}
+
+void Arena::unlock() {
+	if (_mutex)
+		_mutex->unlock();
+}
+
+// Pointers are converted to size_t for the address arithmetic, which has
+// the size of a pointer on all supported platforms
+typedef char ArenaPointerSizeCheck[sizeof(size_t) == sizeof(void *) ? 1 : -1];
+
+Arena::Page *Arena::getPage(const void *ptr) {
+	// Every allocation lies within the first page of its heap block
+	return (Page *)((size_t)ptr & ~(size_t)(kPageSize - 1));
+}
+
+Arena::Page *Arena::getFirstPage(const void *block) {
+	return (Page *)(((size_t)block + kPageSize - 1) & ~(size_t)(kPageSize - 1));
+}
+
+Arena *Arena::getOwner(const void *ptr) {
+	return getPage(ptr)->owner;
+}
+
+void Arena::linkPage(Page *&list, Page *page) {
+	page->prev = 0;
+	page->next = list;
+	if (list)
+		list->prev = page;
+	list = page;
+}
+
+void Arena::unlinkPage(Page *&list, Page *page) {
+	if (page->prev)
+		page->prev->next = page->next;
+	else
+		list = page->next;
+	if (page->next)
+		page->next->prev = page->prev;
+	page->prev = page->next = 0;
+}
+
+void Arena::allocBlock() {
+	// One page more than needed, to be able to align the pages
+	void *block = ::malloc((kPagesPerBlock + 1) * kPageSize);
+	if (!block)
+		::error("Common::Arena: failure to allocate %u bytes", (uint)((kPagesPerBlock + 1) * kPageSize));
+	_blocks.push_back(block);
+
+	byte *start = (byte *)getFirstPage(block);
+	for (uint i = 0; i < kPagesPerBlock; ++i) {
+		Page *page = (Page *)(start + i * kPageSize);
+		page->owner = this;
+		linkPage(_freePages, page);
+	}
+}
+
+void *Arena::allocateSmall(uint sizeClass) {
+	Page *page = _partialPages[sizeClass];
+	if (!page) {
+		// Assign a free page to the size class
+		if (!_freePages)
+			allocBlock();
+		page = _freePages;
+		unlinkPage(_freePages, page);
+
+		page->freeChunks = 0;
+		page->unused = (byte *)page + kHeaderSize;
+		page->sizeClass = sizeClass;
+		page->usedChunks = 0;
+		page->size = _sizeClasses[sizeClass];
+		page->block = 0;
+		linkPage(_partialPages[sizeClass], page);
+	}
+
+	// Reuse a freed chunk if there is one, else take the next unused one
+	void *ptr = page->freeChunks;
+	if (ptr) {
+		page->freeChunks = *(void **)ptr;
+	} else {
+		ptr = page->unused;
+		page->unused += page->size;
+	}
+	page->usedChunks++;
+	_usedSize += page->size;
+
+	// Full pages are taken out of the list until a chunk is freed again
+	if (!page->freeChunks && page->unused + page->size > (byte *)page + kPageSize)
+		unlinkPage(_partialPages[sizeClass], page);
+
+	return ptr;
+}
+
+void *Arena::allocateLarge(size_t size) {
+	const size_t blockSize = size + kHeaderSize + kPageSize - 1;
+	void *block = ::malloc(blockSize);
+	if (!block)
+		::error("Common::Arena: failure to allocate %u bytes", (uint)blockSize);
+
+	Page *page = getFirstPage(block);
+	page->owner = this;
+	page->freeChunks = 0;
+	page->unused = 0;
+	page->sizeClass = kLargeClass;
+	page->usedChunks = 1;
+	page->size = size;
+	page->block = block;
+	linkPage(_largePages, page);
+
+	_largeSize += blockSize;
+	_usedSize += size;
+	return (byte *)page + kHeaderSize;
+}
+
+void *Arena::allocate(size_t size) {
+	lock();
+	void *ptr = (size > kMaxSmallSize) ? allocateLarge(size) : allocateSmall(_classForSize[(size + 7) / 8]);
+	unlock();
+	return ptr;
+}
+
+void Arena::freeChunk(Page *page, void *ptr) {
+	if (page->sizeClass == kLargeClass) {
+		unlinkPage(_largePages, page);
+		_largeSize -= page->size + kHeaderSize + kPageSize - 1;
+		_usedSize -= page->size;
+		::free(page->block);
+		return;
+	}
+
+	assert(page->usedChunks > 0);
+	const bool wasFull = !page->freeChunks && page->unused + page->size > (byte *)page + kPageSize;
+
+	*(void **)ptr = page->freeChunks;
+	page->freeChunks = ptr;
+	page->usedChunks--;
+	_usedSize -= page->size;
+
+	if (page->usedChunks == 0) {
+		// Give the page back, so that other size classes can use it
+		if (!wasFull)
+			unlinkPage(_partialPages[page->sizeClass], page);
+		linkPage(_freePages, page);
+	} else if (wasFull) {
+		linkPage(_partialPages[page->sizeClass], page);
+	}
+}
+
+void Arena::deallocate(void *ptr) {
+	if (!ptr)
+		return;
+
+	Page *page = getPage(ptr);
+	Arena *arena = page->owner;
+	arena->lock();
+	arena->freeChunk(page, ptr);
+	arena->unlock();
+}
+
+void Arena::releaseLarge() {
+	while (_largePages) {
+		Page *page = _largePages;
+		_largePages = page->next;
+		::free(page->block);
+	}
+	_largeSize = 0;
+}
+
+void Arena::releaseBlocks() {
+	for (uint i = 0; i < _blocks.size(); ++i)
+		::free(_blocks[i]);
+	_blocks.clear();
+	_freePages = 0;
+	for (uint i = 0; i < kNumSizeClasses; ++i)
+		_partialPages[i] = 0;
+}
+
+void Arena::reset(bool releaseMemory) {
+	lock();
+	releaseLarge();
+
+	if (releaseMemory) {
+		releaseBlocks();
+	} else {
+		// Put all pages back into the list of free pages
+		_freePages = 0;
+		for (uint i = 0; i < kNumSizeClasses; ++i)
+			_partialPages[i] = 0;
+
+		for (uint i = 0; i < _blocks.size(); ++i) {
+			byte *start = (byte *)getFirstPage(_blocks[i]);
+			for (uint j = 0; j < kPagesPerBlock; ++j)
+				linkPage(_freePages, (Page *)(start + j * kPageSize));
+		}
+	}
+
+	_usedSize = 0;
+	unlock();
+}
+
+size_t Arena::getAllocatedSize() const {
+	return _blocks.size() * (kPagesPerBlock + 1) * kPageSize + _largeSize;
+}
+
+size_t Arena::getUsedSize() const {
+	return _usedSize;
+}
+
+}	// End of namespace Common
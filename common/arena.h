@@ -0,0 +1,169 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_ARENA_H
+#define COMMON_ARENA_H
+
+#include "common/scummsys.h"
+#include "common/array.h"
+#include "common/noncopyable.h"
+
+namespace Common {
+
+class Mutex;
+
+/**
+ * A general purpose allocator for small objects, which hands out memory
+ * from a fixed set of size classes.
+ *
+ * Memory is taken from the heap in large blocks of aligned pages. Every page
+ * serves a single size class and starts with a header, so the page and the
+ * arena owning a chunk are found in constant time from the chunk's address.
+ * Pages whose chunks have all been freed are reused for other size classes.
+ *
+ * Besides freeing individual allocations, all memory of an arena can be
+ * released at once with reset(), which makes arenas suitable for objects
+ * with a common life time, e.g. everything belonging to the current room
+ * or frame. reset() does not run any destructors.
+ *
+ * An arena is not shared with any other arena, so arenas which are only
+ * used by a single thread need no locking. There are no implicit per-thread
+ * caches, as OSystem offers no thread local storage; a thread wanting one
+ * has to own an arena itself. Arenas which are used by several threads must
+ * be created thread safe, this requires the OSystem to be available.
+ *
+ * Allocations larger than the biggest size class are supported, but carry
+ * an overhead of up to one page; use them sparingly.
+ *
+ * Arena doesn't build on MemoryPool: the pages of a MemoryPool aren't
+ * aligned, so the owner of a chunk could not be found from its address.
+ *
+ * No engine uses arenas yet; this is infrastructure for engines to adopt.
+ */
+class Arena : NonCopyable {
+public:
+	enum {
+		kPageSize = 16 * 1024,		///< Size and alignment of the pages
+		kPagesPerBlock = 8,			///< Number of pages allocated from the heap at once
+		kMaxSmallSize = 2048,		///< Size of the biggest size class
+		kAlignment = 16				///< Alignment of all chunks of 16 bytes or more
+	};
+
+	explicit Arena(bool threadSafe = false);
+	~Arena();
+
+	/**
+	 * Allocate memory for an object of the given size. Never returns 0;
+	 * running out of memory is a fatal error.
+	 */
+	void *allocate(size_t size);
+
+	/**
+	 * Return memory obtained from allocate() to the arena which owns it.
+	 * Passing 0 is allowed and does nothing.
+	 */
+	static void deallocate(void *ptr);
+
+	/** Return the arena which owns the given allocation. */
+	static Arena *getOwner(const void *ptr);
+
+	/**
+	 * Free all allocations of this arena at once. Pages are kept for
+	 * reuse unless releaseMemory is set, in which case everything is
+	 * returned to the heap.
+	 */
+	void reset(bool releaseMemory = false);
+
+	/** Return the number of bytes this arena took from the heap. */
+	size_t getAllocatedSize() const;
+
+	/** Return the number of bytes currently handed out, rounded up to the size classes. */
+	size_t getUsedSize() const;
+
+	/** Call the destructor of an object created in an arena and free its memory. */
+	template<class T>
+	static void destroy(T *object) {
+		if (object) {
+			object->~T();
+			deallocate(object);
+		}
+	}
+
+private:
+	struct Page {
+		Arena *owner;
+		Page *prev, *next;		///< List of partially used pages of the size class, or of free pages
+		void *freeChunks;		///< Chunks which were freed
+		byte *unused;			///< Start of the chunks which were never used
+		uint16 sizeClass;		///< kLargeClass for large allocations
+		uint16 usedChunks;
+		size_t size;			///< Chunk size, or allocation size for large allocations
+		void *block;			///< Heap block of large allocations
+	};
+
+	enum {
+		kNumSizeClasses = 25,
+		kLargeClass = 0xFFFF,
+		kHeaderSize = (sizeof(Page) + kAlignment - 1) & ~(kAlignment - 1)
+	};
+
+	static const uint16 _sizeClasses[kNumSizeClasses];
+
+	Mutex *_mutex;
+	byte _classForSize[kMaxSmallSize / 8 + 1];	///< Size class for each multiple of 8 bytes
+	Page *_partialPages[kNumSizeClasses];	///< Pages with available chunks, for each size class
+	Page *_freePages;						///< Pages not assigned to any size class
+	Page *_largePages;						///< Large allocations
+	Array<void *> _blocks;					///< Heap blocks of all small pages
+	size_t _largeSize;						///< Heap memory used for large allocations
+	size_t _usedSize;
+
+	void lock();
+	void unlock();
+
+	static Page *getPage(const void *ptr);
+	static Page *getFirstPage(const void *block);
+	void allocBlock();
+	void *allocateLarge(size_t size);
+	void *allocateSmall(uint sizeClass);
+	void freeChunk(Page *page, void *ptr);
+	void unlinkPage(Page *&list, Page *page);
+	void linkPage(Page *&list, Page *page);
+	void releaseLarge();
+	void releaseBlocks();
+};
+
+}	// End of namespace Common
+
+/**
+ * A custom placement new operator, allocating from an Arena. Objects must be
+ * freed with Common::Arena::destroy(), or all at once with reset().
+ */
+inline void *operator new(size_t nbytes, Common::Arena &arena) {
+	return arena.allocate(nbytes);
+}
+
+inline void operator delete(void *p, Common::Arena &arena) {
+	Common::Arena::deallocate(p);
+}
+
+#endif
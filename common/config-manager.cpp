@@ -49,6 +49,10 @@ char const *const ConfigManager::kKeymapperDomain = "keymapper";
 
 
 ConfigManager::ConfigManager() : _activeDomain(0) {
+	_transientDomain.setStatsName("config.transient");
+	_gameDomains.setStatsName("config.gameDomains");
+	_appDomain.setStatsName("config.application");
+	_defaultsDomain.setStatsName("config.defaults");
 }
 
 void ConfigManager::defragment() {
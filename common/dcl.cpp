@@ -21,7 +21,6 @@
  */
 
 #include "common/dcl.h"
-#include "common/debug.h"
 #include "common/memstream.h"
 #include "common/stream.h"
 #include "common/textconsole.h"
@@ -30,11 +29,16 @@ namespace Common {
 
 class DecompressorDCL {
 public:
+	DecompressorDCL() : _packed(0) {}
+	~DecompressorDCL() { delete[] _packed; }
+
 	bool unpack(ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
 
 protected:
 	/**
 	 * Initialize decompressor.
+	 * The packed data is read into memory as a whole, so that the bit reader
+	 * doesn't have to go through the stream for every byte.
 	 * @param src		source stream to read from
 	 * @param dest		destination stream to write to
 	 * @param nPacked	size of packed data
@@ -75,6 +79,9 @@ protected:
 	uint32 _dwWrote;	///< number of bytes written to _dest
 	ReadStream *_src;
 	byte *_dest;
+	byte *_packed;		///< packed data read from _src
+	const byte *_in;	///< next byte of packed data to read
+	const byte *_inEnd;	///< end of the packed data
 };
 
 void DecompressorDCL::init(ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked) {
@@ -85,11 +92,32 @@ void DecompressorDCL::init(ReadStream *src, byte *dest, uint32 nPacked, uint32 n
 	_nBits = 0;
 	_dwRead = _dwWrote = 0;
 	_dwBits = 0;
+
+	delete[] _packed;
+	_packed = new byte[nPacked];
+	uint32 bytesRead = src->read(_packed, nPacked);
+	// Like reading past the end of the stream, missing data reads as zeroes
+	memset(_packed + bytesRead, 0, nPacked - bytesRead);
+	_in = _packed;
+	_inEnd = _packed + nPacked;
 }
 
 void DecompressorDCL::fetchBitsLSB() {
+	// Refill as many whole bytes as fit with one 32-bit read, if possible
+	if (_inEnd - _in >= 4) {
+		const uint count = (32 - _nBits) >> 3;
+		uint32 word = READ_LE_UINT32(_in);
+		if (count < 4)
+			word &= (1 << (count << 3)) - 1;
+		_dwBits |= word << _nBits;
+		_nBits += count << 3;
+		_in += count;
+		_dwRead += count;
+		return;
+	}
+
 	while (_nBits <= 24) {
-		_dwBits |= ((uint32)_src->readByte()) << _nBits;
+		_dwBits |= ((uint32)((_in < _inEnd) ? *_in++ : 0)) << _nBits;
 		_nBits += 8;
 		_dwRead++;
 	}
@@ -321,11 +349,9 @@ int DecompressorDCL::huffman_lookup(const int *tree) {
 
 	while (!(tree[pos] & HUFFMAN_LEAF)) {
 		int bit = getBitsLSB(1);
-		debug(8, "[%d]:%d->", pos, bit);
 		pos = bit ? tree[pos] & 0xFFF : tree[pos] >> 12;
 	}
 
-	debug(8, "=%02x\n", tree[pos] & 0xffff);
 	return tree[pos] & 0xFFFF;
 }
 
@@ -358,8 +384,6 @@ bool DecompressorDCL::unpack(ReadStream *src, byte *dest, uint32 nPacked, uint32
 			else
 				val_length = 8 + (1 << (value - 7)) + getBitsLSB(value - 7);
 
-			debug(8, " | ");
-
 			value = huffman_lookup(distance_tree);
 
 			if (val_length == 2)
@@ -368,8 +392,6 @@ bool DecompressorDCL::unpack(ReadStream *src, byte *dest, uint32 nPacked, uint32
 				val_distance = (value << length_param) | getBitsLSB(length_param);
 			val_distance ++;
 
-			debug(8, "\nCOPY(%d from %d)\n", val_length, val_distance);
-
 			if (val_length + _dwWrote > _szUnpacked) {
 				warning("DCL-INFLATE Error: Write out of bounds while copying %d bytes", val_length);
 				return false;
@@ -380,25 +402,20 @@ bool DecompressorDCL::unpack(ReadStream *src, byte *dest, uint32 nPacked, uint32
 				return false;
 			}
 
-			while (val_length) {
-				uint32 copy_length = (val_length > val_distance) ? val_distance : val_length;
-				assert(val_distance >= copy_length);
-				uint32 pos = _dwWrote - val_distance;
-				for (uint32 i = 0; i < copy_length; i++)
-					putByte(dest[pos + i]);
-
-				for (uint32 i = 0; i < copy_length; i++)
-					debug(9, "\33[32;31m%02x\33[37;37m ", dest[pos + i]);
-				debug(9, "\n");
-
-				val_length -= copy_length;
-				val_distance += copy_length;
+			byte *copyDest = dest + _dwWrote;
+			const byte *copySrc = copyDest - val_distance;
+			if (val_length <= val_distance) {
+				memcpy(copyDest, copySrc, val_length);
+			} else {
+				// Overlapping copies repeat the data, so these have to be done byte by byte
+				for (uint32 i = 0; i < val_length; i++)
+					copyDest[i] = copySrc[i];
 			}
+			_dwWrote += val_length;
 
 		} else { // Copy byte verbatim
 			value = (mode == DCL_ASCII_MODE) ? huffman_lookup(ascii_tree) : getByteLSB();
 			putByte(value);
-			debug(9, "\33[32;31m%02x \33[37;37m", value);
 		}
 	}
 
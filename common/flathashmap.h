@@ -0,0 +1,584 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_FLATHASHMAP_H
+#define COMMON_FLATHASHMAP_H
+
+#include "common/func.h"
+#include "common/hashmap.h"
+#include "common/textconsole.h"
+
+namespace Common {
+
+/**
+ * FlatHashMap<Key,Val> is a drop-in alternative to HashMap<Key,Val> which
+ * stores keys and values directly in its table instead of allocating a
+ * node for every entry. Collisions are resolved by linear probing with
+ * Robin Hood ordering (the entries of a cluster are kept sorted by their
+ * home slot, so a lookup can stop as soon as it passes the place where its
+ * key would have to be). The hash of every entry is cached next to it,
+ * and erased entries are removed by shifting the following entries of
+ * their cluster back, so the table never contains tombstones.
+ *
+ * This saves the node allocations and a pointer indirection on every
+ * lookup, and keys are only compared on a full hash match. That does not
+ * make it faster in general: test/bench/hashbench shows it slower than
+ * HashMap for integer keys, and slower to erase from for any key type.
+ * It only pays off for keys which are expensive to compare, like strings,
+ * when many lookups fail, or when the map is iterated often. Use HashMap
+ * unless a benchmark of the actual use shows a gain.
+ *
+ * There are also two differences to HashMap which callers must be aware of:
+ * - Inserting an entry may move all other entries, so pointers and
+ *   references to values are only valid until the next insertion.
+ * - Erasing an entry may move other entries into earlier slots, so all
+ *   iterators are invalidated by erase().
+ *
+ * Hash and equality functors are the same as for HashMap, and so are the
+ * statistics.
+ */
+template<class Key, class Val, class HashFunc = Hash<Key>, class EqualFunc = EqualTo<Key> >
+class FlatHashMap {
+public:
+	typedef uint size_type;
+
+private:
+
+	typedef FlatHashMap<Key, Val, HashFunc, EqualFunc> HM_t;
+
+	struct Node {
+		const Key _key;
+		Val _value;
+		explicit Node(const Key &key) : _key(key), _value() {}
+	};
+
+	enum {
+		HASHMAP_NONE_FOUND = (size_type)-1,
+		HASHMAP_MIN_CAPACITY = 16,
+
+		// The quotient of the next two constants controls how much the
+		// internal storage of the hashmap may fill up before being
+		// increased automatically.
+		HASHMAP_LOADFACTOR_NUMERATOR = 3,
+		HASHMAP_LOADFACTOR_DENOMINATOR = 4
+	};
+
+	/**
+	 * A table entry. The node is only constructed if the hash is non-zero,
+	 * a zero hash marks an empty slot.
+	 */
+	struct Slot {
+		size_type _hash;
+		Node _node;
+	};
+
+	Slot *_slots;
+	size_type _mask;	///< Capacity of the FlatHashMap minus one; capacity must be a power of two
+	size_type _size;
+
+	HashFunc _hash;
+	EqualFunc _equal;
+
+	/** Default value, returned by the const getVal. */
+	const Val _defaultVal;
+
+#ifdef USE_HASHMAP_STATS
+	mutable HashMapCounters _counters;
+#endif
+	const char *_statsName;	///< Name in the statistics registry, if registered
+
+	static void getStatsFunc(const void *map, HashMapStats &stats) {
+		((const HM_t *)map)->getStats(stats);
+	}
+
+	/**
+	 * Compute the cached hash of a key. The bits of the user supplied hash
+	 * are mixed, since linear probing suffers badly from clustered hashes,
+	 * e.g. keys which only differ in their upper bits. The top bit is always set, so that 0 can
+	 * mark empty slots.
+	 */
+	size_type hashOf(const Key &key) const {
+		size_type hash = _hash(key);
+		hash ^= hash >> 16;
+		hash *= 0x85EBCA6B;
+		hash ^= hash >> 13;
+		hash *= 0xC2B2AE35;
+		hash ^= hash >> 16;
+		return hash | 0x80000000;
+	}
+
+	void allocStorage(size_type capacity);
+	void freeStorage();
+	void assign(const HM_t &map);
+	size_type lookup(const Key &key, size_type hash) const;
+	size_type insertSlot(size_type hash);
+	size_type lookupAndCreateIfMissing(const Key &key);
+	void expandStorage(size_type newCapacity);
+	void eraseSlot(size_type ctr);
+
+	/**
+	 * Simple FlatHashMap iterator implementation.
+	 */
+	template<class NodeType>
+	class IteratorImpl {
+		friend class FlatHashMap;
+		template<class T> friend class IteratorImpl;
+	protected:
+		typedef const FlatHashMap hashmap_t;
+
+		size_type _idx;
+		hashmap_t *_hashmap;
+
+	protected:
+		IteratorImpl(size_type idx, hashmap_t *hashmap) : _idx(idx), _hashmap(hashmap) {}
+
+		NodeType *deref() const {
+			assert(_hashmap != 0);
+			assert(_idx <= _hashmap->_mask);
+			assert(_hashmap->_slots[_idx]._hash != 0);
+			return &_hashmap->_slots[_idx]._node;
+		}
+
+	public:
+		IteratorImpl() : _idx(0), _hashmap(0) {}
+		template<class T>
+		IteratorImpl(const IteratorImpl<T> &c) : _idx(c._idx), _hashmap(c._hashmap) {}
+
+		NodeType &operator*() const { return *deref(); }
+		NodeType *operator->() const { return deref(); }
+
+		bool operator==(const IteratorImpl &iter) const { return _idx == iter._idx && _hashmap == iter._hashmap; }
+		bool operator!=(const IteratorImpl &iter) const { return !(*this == iter); }
+
+		IteratorImpl &operator++() {
+			assert(_hashmap);
+			do {
+				_idx++;
+			} while (_idx <= _hashmap->_mask && _hashmap->_slots[_idx]._hash == 0);
+			if (_idx > _hashmap->_mask)
+				_idx = (size_type)-1;
+
+			return *this;
+		}
+
+		IteratorImpl operator++(int) {
+			IteratorImpl old = *this;
+			operator ++();
+			return old;
+		}
+	};
+
+public:
+	typedef IteratorImpl<Node> iterator;
+	typedef IteratorImpl<const Node> const_iterator;
+
+	FlatHashMap();
+	FlatHashMap(const HM_t &map);
+	~FlatHashMap();
+
+	HM_t &operator=(const HM_t &map) {
+		if (this == &map)
+			return *this;
+
+		// Remove the previous content and ...
+		freeStorage();
+		// ... copy the new stuff.
+		assign(map);
+		return *this;
+	}
+
+	bool contains(const Key &key) const;
+
+	Val &operator[](const Key &key);
+	const Val &operator[](const Key &key) const;
+
+	Val &getVal(const Key &key);
+	const Val &getVal(const Key &key) const;
+	const Val &getVal(const Key &key, const Val &defaultVal) const;
+	void setVal(const Key &key, const Val &val);
+
+	void clear(bool shrinkArray = 0);
+
+	void erase(iterator entry);
+	void erase(const Key &key);
+
+	size_type size() const { return _size; }
+
+	/**
+	 * Register this map in the global statistics registry under the given
+	 * name, see HashMap::setStatsName().
+	 */
+	void setStatsName(const char *name) {
+		_statsName = name;
+#ifdef USE_HASHMAP_STATS
+		registerHashMapStats(name, this, &getStatsFunc, &_counters);
+#else
+		registerHashMapStats(name, this, &getStatsFunc, 0);
+#endif
+	}
+
+	void getStats(HashMapStats &stats) const;
+	void resetStats() {
+#ifdef USE_HASHMAP_STATS
+		_counters.reset();
+#endif
+	}
+
+	iterator	begin() {
+		// Find and return the first non-empty entry
+		for (size_type ctr = 0; ctr <= _mask; ++ctr) {
+			if (_slots[ctr]._hash)
+				return iterator(ctr, this);
+		}
+		return end();
+	}
+	iterator	end() {
+		return iterator((size_type)-1, this);
+	}
+
+	const_iterator	begin() const {
+		// Find and return the first non-empty entry
+		for (size_type ctr = 0; ctr <= _mask; ++ctr) {
+			if (_slots[ctr]._hash)
+				return const_iterator(ctr, this);
+		}
+		return end();
+	}
+	const_iterator	end() const {
+		return const_iterator((size_type)-1, this);
+	}
+
+	iterator	find(const Key &key) {
+		return iterator(lookup(key, hashOf(key)), this);
+	}
+
+	const_iterator	find(const Key &key) const {
+		return const_iterator(lookup(key, hashOf(key)), this);
+	}
+
+	bool empty() const {
+		return (_size == 0);
+	}
+};
+
+//-------------------------------------------------------
+// FlatHashMap functions
+
+/**
+ * Base constructor, creates an empty hashmap.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+FlatHashMap<Key, Val, HashFunc, EqualFunc>::FlatHashMap() : _defaultVal(), _statsName(0) {
+	allocStorage(HASHMAP_MIN_CAPACITY);
+}
+
+/**
+ * Copy constructor, creates a full copy of the given hashmap.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+FlatHashMap<Key, Val, HashFunc, EqualFunc>::FlatHashMap(const HM_t &map) : _defaultVal(), _statsName(0) {
+	assign(map);
+}
+
+/**
+ * Destructor, frees all used memory.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+FlatHashMap<Key, Val, HashFunc, EqualFunc>::~FlatHashMap() {
+	freeStorage();
+
+	if (_statsName)
+		unregisterHashMapStats(this);
+}
+
+/**
+ * Internal method for allocating empty storage for the given number of
+ * entries, which must be a power of two.
+ *
+ * @note We do *not* deallocate the previous storage here -- the caller is
+ *       responsible for doing that!
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::allocStorage(size_type capacity) {
+	_mask = capacity - 1;
+	_size = 0;
+
+	_slots = (Slot *)malloc(capacity * sizeof(Slot));
+	if (!_slots)
+		::error("Common::FlatHashMap: failure to allocate %u bytes", capacity * (size_type)sizeof(Slot));
+	for (size_type ctr = 0; ctr < capacity; ++ctr)
+		_slots[ctr]._hash = 0;
+}
+
+/**
+ * Internal method for destroying all entries and freeing the storage.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::freeStorage() {
+	for (size_type ctr = 0; ctr <= _mask; ++ctr) {
+		if (_slots[ctr]._hash)
+			_slots[ctr]._node.~Node();
+	}
+
+	free(_slots);
+	_slots = 0;
+	_size = 0;
+}
+
+/**
+ * Internal method for assigning the content of another FlatHashMap
+ * to this one.
+ *
+ * @note We do *not* deallocate the previous storage here -- the caller is
+ *       responsible for doing that!
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::assign(const HM_t &map) {
+	allocStorage(map._mask + 1);
+
+	// The hash functions are the same, so every entry can stay in its slot
+	for (size_type ctr = 0; ctr <= _mask; ++ctr) {
+		if (map._slots[ctr]._hash) {
+			new ((void *)&_slots[ctr]._node) Node(map._slots[ctr]._node);
+			_slots[ctr]._hash = map._slots[ctr]._hash;
+			_size++;
+		}
+	}
+	assert(_size == map._size);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::clear(bool shrinkArray) {
+	if (shrinkArray && _mask >= HASHMAP_MIN_CAPACITY) {
+		freeStorage();
+		allocStorage(HASHMAP_MIN_CAPACITY);
+		return;
+	}
+
+	for (size_type ctr = 0; ctr <= _mask; ++ctr) {
+		if (_slots[ctr]._hash) {
+			_slots[ctr]._node.~Node();
+			_slots[ctr]._hash = 0;
+		}
+	}
+	_size = 0;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::expandStorage(size_type newCapacity) {
+	assert(newCapacity > _mask+1);
+
+#ifndef NDEBUG
+	const size_type old_size = _size;
+#endif
+	const size_type old_mask = _mask;
+	Slot *old_slots = _slots;
+
+#ifdef USE_HASHMAP_STATS
+	_counters.rehashes++;
+#endif
+	allocStorage(newCapacity);
+
+	// Move all the old elements. Since we know that no key exists twice in
+	// the old table, and we still know their hashes, there is no need to
+	// call _hash() or _equal().
+	for (size_type ctr = 0; ctr <= old_mask; ++ctr) {
+		if (!old_slots[ctr]._hash)
+			continue;
+
+		const size_type idx = insertSlot(old_slots[ctr]._hash);
+		new ((void *)&_slots[idx]._node) Node(old_slots[ctr]._node);
+		old_slots[ctr]._node.~Node();
+	}
+	assert(_size == old_size);
+
+	free(old_slots);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+typename FlatHashMap<Key, Val, HashFunc, EqualFunc>::size_type FlatHashMap<Key, Val, HashFunc, EqualFunc>::lookup(const Key &key, size_type hash) const {
+	// Entries further away from their home slot than the key would be
+	// belong to an earlier home slot. The first entry which is closer to
+	// its home slot ends the search.
+	size_type ctr = hash & _mask;
+	size_type dist = 0;
+	for (; _slots[ctr]._hash != 0 && ((ctr - _slots[ctr]._hash) & _mask) >= dist; ++dist) {
+		if (_slots[ctr]._hash == hash && _equal(_slots[ctr]._node._key, key)) {
+#ifdef USE_HASHMAP_STATS
+			_counters.addLookup(dist + 1);
+#endif
+			return ctr;
+		}
+		ctr = (ctr + 1) & _mask;
+	}
+#ifdef USE_HASHMAP_STATS
+	_counters.addLookup(dist + 1);
+#endif
+	return HASHMAP_NONE_FOUND;
+}
+
+/**
+ * Internal method for making room for a new entry with the given hash.
+ * Returns the slot in which the caller must construct the entry.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+typename FlatHashMap<Key, Val, HashFunc, EqualFunc>::size_type FlatHashMap<Key, Val, HashFunc, EqualFunc>::insertSlot(size_type hash) {
+	// Skip all entries with an earlier or the same home slot
+	size_type ctr = hash & _mask;
+	for (size_type dist = 0; _slots[ctr]._hash != 0 && ((ctr - _slots[ctr]._hash) & _mask) >= dist; ++dist)
+		ctr = (ctr + 1) & _mask;
+
+	// Shift the rest of the cluster forward by one slot. This keeps the
+	// cluster sorted.
+	size_type hole = ctr;
+	while (_slots[hole]._hash != 0)
+		hole = (hole + 1) & _mask;
+
+	while (hole != ctr) {
+		const size_type prev = (hole - 1) & _mask;
+		new ((void *)&_slots[hole]._node) Node(_slots[prev]._node);
+		_slots[prev]._node.~Node();
+		_slots[hole]._hash = _slots[prev]._hash;
+		hole = prev;
+	}
+
+	_slots[ctr]._hash = hash;
+	_size++;
+	return ctr;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+typename FlatHashMap<Key, Val, HashFunc, EqualFunc>::size_type FlatHashMap<Key, Val, HashFunc, EqualFunc>::lookupAndCreateIfMissing(const Key &key) {
+	const size_type hash = hashOf(key);
+	size_type ctr = lookup(key, hash);
+	if (ctr != HASHMAP_NONE_FOUND)
+		return ctr;
+
+	// Keep the load factor below a certain threshold
+	size_type capacity = _mask + 1;
+	if ((_size + 1) * HASHMAP_LOADFACTOR_DENOMINATOR > capacity * HASHMAP_LOADFACTOR_NUMERATOR) {
+		capacity = capacity < 500 ? (capacity * 4) : (capacity * 2);
+		expandStorage(capacity);
+	}
+
+	ctr = insertSlot(hash);
+	new ((void *)&_slots[ctr]._node) Node(key);
+	return ctr;
+}
+
+/**
+ * Internal method for removing the entry in the given slot. The following
+ * entries of the cluster which are not in their home slot are shifted back
+ * by one, so that lookups never need to skip over deleted entries.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::eraseSlot(size_type ctr) {
+	_slots[ctr]._node.~Node();
+	_size--;
+
+	size_type next = (ctr + 1) & _mask;
+	while (_slots[next]._hash != 0 && ((next - _slots[next]._hash) & _mask) != 0) {
+		new ((void *)&_slots[ctr]._node) Node(_slots[next]._node);
+		_slots[next]._node.~Node();
+		_slots[ctr]._hash = _slots[next]._hash;
+		ctr = next;
+		next = (next + 1) & _mask;
+	}
+	_slots[ctr]._hash = 0;
+}
+
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::getStats(HashMapStats &stats) const {
+	stats.name = _statsName;
+	stats.size = _size;
+	stats.capacity = _mask + 1;
+	stats.deleted = 0;
+	stats.memory = sizeof(*this) + (_mask + 1) * sizeof(Slot);
+#ifdef USE_HASHMAP_STATS
+	stats.counters = _counters;
+#else
+	stats.counters.reset();
+#endif
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+bool FlatHashMap<Key, Val, HashFunc, EqualFunc>::contains(const Key &key) const {
+	return lookup(key, hashOf(key)) != HASHMAP_NONE_FOUND;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::operator[](const Key &key) {
+	return getVal(key);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+const Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::operator[](const Key &key) const {
+	return getVal(key);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::getVal(const Key &key) {
+	size_type ctr = lookupAndCreateIfMissing(key);
+	return _slots[ctr]._node._value;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+const Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::getVal(const Key &key) const {
+	return getVal(key, _defaultVal);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+const Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::getVal(const Key &key, const Val &defaultVal) const {
+	size_type ctr = lookup(key, hashOf(key));
+	if (ctr != HASHMAP_NONE_FOUND)
+		return _slots[ctr]._node._value;
+	else
+		return defaultVal;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::setVal(const Key &key, const Val &val) {
+	size_type ctr = lookupAndCreateIfMissing(key);
+	_slots[ctr]._node._value = val;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::erase(iterator entry) {
+	// Check whether we have a valid iterator
+	assert(entry._hashmap == this);
+	assert(entry._idx <= _mask);
+	assert(_slots[entry._idx]._hash != 0);
+
+	eraseSlot(entry._idx);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::erase(const Key &key) {
+	size_type ctr = lookup(key, hashOf(key));
+	if (ctr != HASHMAP_NONE_FOUND)
+		eraseSlot(ctr);
+}
+
+}	// End of namespace Common
+
+#endif
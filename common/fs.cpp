@@ -291,6 +291,8 @@ void FSDirectory::cacheDirectoryRecursive(FSNode node, int depth, const String&
 void FSDirectory::ensureCached() const  {
 	if (_cached)
 		return;
+	_statsName = "fs:" + _node.getPath();
+	_fileCache.setStatsName(_statsName.c_str());
 	cacheDirectoryRecursive(_node, _depth, _prefix);
 	_cached = true;
 }
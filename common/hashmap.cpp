@@ -52,58 +52,63 @@ uint hashit_lower(const char *p) {
 	return hash ^ size;
 }
 
-#ifdef DEBUG_HASH_COLLISIONS
-static double
-	g_collisions = 0,
-	g_dummyHits = 0,
-	g_lookups = 0,
-	g_collPerLook = 0,
-	g_capacity = 0,
-	g_size = 0;
-static int g_max_capacity = 0, g_max_size = 0;
-static int g_totalHashmaps = 0;
-static int g_stats[4] = {0,0,0,0};
-
-void updateHashCollisionStats(int collisions, int dummyHits, int lookups, int arrsize, int nele) {
-	g_collisions += collisions;
-	g_lookups += lookups;
-	g_dummyHits += dummyHits;
-	if (lookups)
-		g_collPerLook += (double)collisions / (double)lookups;
-	g_capacity += arrsize;
-	g_size += nele;
-	g_totalHashmaps++;
-
-	if (3*nele <= 2*8)
-		g_stats[0]++;
-	if (3*nele <= 2*16)
-		g_stats[1]++;
-	if (3*nele <= 2*32)
-		g_stats[2]++;
-	if (3*nele <= 2*64)
-		g_stats[3]++;
-
-	g_max_capacity = MAX(g_max_capacity, arrsize);
-	g_max_size = MAX(g_max_size, nele);
-
-	debug("%d hashmaps: colls %.1f; dummies hit %.1f, lookups %.1f; ratio %.3f%%; size %f (max: %d); capacity %f (max: %d)",
-		g_totalHashmaps,
-		g_collisions / g_totalHashmaps,
-		g_dummyHits / g_totalHashmaps,
-		g_lookups / g_totalHashmaps,
-		100 * g_collPerLook / g_totalHashmaps,
-		g_size / g_totalHashmaps, g_max_size,
-		g_capacity / g_totalHashmaps, g_max_capacity);
-	debug("  %d less than %d; %d less than %d; %d less than %d; %d less than %d",
-			g_stats[0], 2*8/3,
-			g_stats[1],2*16/3,
-			g_stats[2],2*32/3,
-			g_stats[3],2*64/3);
-
-	// TODO:
-	// * Should record the maximal size of the map during its lifetime, not that at its death
-	// * Should do some statistics: how many maps are less than 2/3*8, 2/3*16, 2/3*32, ...
+#pragma mark -
+
+struct HashMapRegistryEntry {
+	const char *name;
+	const void *map;
+	HashMapStatsFunc func;
+	HashMapCounters *counters;
+	HashMapRegistryEntry *next;
+};
+
+// A plain list, to avoid a global constructor. Registering maps is rare,
+// and maps are only registered and queried from the main thread.
+static HashMapRegistryEntry *g_hashMapRegistry = 0;
+
+void registerHashMapStats(const char *name, const void *map, HashMapStatsFunc func, HashMapCounters *counters) {
+	for (HashMapRegistryEntry *entry = g_hashMapRegistry; entry; entry = entry->next) {
+		if (entry->map == map) {
+			entry->name = name;
+			return;
+		}
+	}
+
+	HashMapRegistryEntry *entry = new HashMapRegistryEntry;
+	entry->name = name;
+	entry->map = map;
+	entry->func = func;
+	entry->counters = counters;
+	entry->next = g_hashMapRegistry;
+	g_hashMapRegistry = entry;
+}
+
+void unregisterHashMapStats(const void *map) {
+	for (HashMapRegistryEntry **entry = &g_hashMapRegistry; *entry; entry = &(*entry)->next) {
+		if ((*entry)->map == map) {
+			HashMapRegistryEntry *next = (*entry)->next;
+			delete *entry;
+			*entry = next;
+			return;
+		}
+	}
+}
+
+void getRegisteredHashMapStats(Array<HashMapStats> &stats) {
+	stats.clear();
+	for (HashMapRegistryEntry *entry = g_hashMapRegistry; entry; entry = entry->next) {
+		HashMapStats mapStats;
+		entry->func(entry->map, mapStats);
+		mapStats.name = entry->name;
+		stats.push_back(mapStats);
+	}
+}
+
+void resetRegisteredHashMapStats() {
+	for (HashMapRegistryEntry *entry = g_hashMapRegistry; entry; entry = entry->next) {
+		if (entry->counters)
+			entry->counters->reset();
+	}
 }
-#endif
 
 }	// End of namespace Common
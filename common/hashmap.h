@@ -26,14 +26,6 @@
 #ifndef COMMON_HASHMAP_H
 #define COMMON_HASHMAP_H
 
-/**
- * @def DEBUG_HASH_COLLISIONS
- * Enable the following #define if you want to check how many collisions the
- * code produces (many collisions indicate either a bad hash function, or a
- * hash table that is too small).
- */
-//#define DEBUG_HASH_COLLISIONS
-
 /**
  * @def USE_HASHMAP_MEMORY_POOL
  * Enable the following define to let HashMaps use a memory pool for the
@@ -42,12 +34,21 @@
  */
 #define USE_HASHMAP_MEMORY_POOL
 
+/**
+ * @def USE_HASHMAP_STATS
+ * Defined if hash maps count their lookups, probes and growths, see
+ * HashMapCounters. This costs some speed and the counters are updated
+ * without locking by const methods too, so they are only compiled into
+ * development builds. Release builds still report the size, load and
+ * memory footprint of registered maps.
+ */
+#ifndef RELEASE_BUILD
+#define USE_HASHMAP_STATS
+#endif
 
-#include "common/func.h"
 
-#ifdef DEBUG_HASH_COLLISIONS
-#include "common/debug.h"
-#endif
+#include "common/func.h"
+#include "common/array.h"
 
 #ifdef USE_HASHMAP_MEMORY_POOL
 #include "common/memorypool.h"
@@ -64,6 +65,63 @@ namespace Common {
 template<class T> class IteratorImpl;
 #endif
 
+/**
+ * Counters every hash map keeps about its lookups. Many probes per lookup
+ * indicate either a bad hash function, or a hash table that is too full.
+ * They stay zero unless USE_HASHMAP_STATS is defined.
+ */
+struct HashMapCounters {
+	uint lookups;	///< Number of lookups
+	uint probes;	///< Number of slots visited by these lookups
+	uint maxProbes;	///< Longest probe sequence of a single lookup
+	uint dummyHits;	///< Number of slots of erased entries visited by these lookups
+	uint rehashes;	///< Number of times the table was grown
+
+	HashMapCounters() { reset(); }
+	void reset() { lookups = probes = maxProbes = dummyHits = rehashes = 0; }
+
+	void addLookup(uint numProbes) {
+		lookups++;
+		probes += numProbes;
+		if (numProbes > maxProbes)
+			maxProbes = numProbes;
+	}
+};
+
+/**
+ * Statistics about a hash map, see HashMap::getStats().
+ */
+struct HashMapStats {
+	const char *name;		///< Name the map was registered with, if any
+	uint size;				///< Number of entries
+	uint capacity;			///< Number of slots of the table
+	uint deleted;			///< Number of slots of erased entries
+	uint memory;			///< Heap and object memory used by the map, in bytes
+	HashMapCounters counters;
+};
+
+/**
+ * Function filling in the statistics of a map, used by the statistics
+ * registry. Every map class provides one.
+ */
+typedef void (*HashMapStatsFunc)(const void *map, HashMapStats &stats);
+
+/**
+ * Add a map to the global statistics registry, or rename it if it is
+ * already registered. Use the setStatsName() method of the maps instead of
+ * calling this directly.
+ */
+void registerHashMapStats(const char *name, const void *map, HashMapStatsFunc func, HashMapCounters *counters);
+
+/** Remove a map from the global statistics registry. */
+void unregisterHashMapStats(const void *map);
+
+/** Get the statistics of all registered maps. */
+void getRegisteredHashMapStats(Array<HashMapStats> &stats);
+
+/** Reset the counters of all registered maps. */
+void resetRegisteredHashMapStats();
+
 
 /**
  * HashMap<Key,Val> maps objects of type Key to objects of type Val.
@@ -127,9 +185,14 @@ private:
 	/** Dummy node, used as marker for erased objects. */
 	#define HASHMAP_DUMMY_NODE	((Node *)1)
 
-#ifdef DEBUG_HASH_COLLISIONS
-	mutable int _collisions, _lookups, _dummyHits;
+#ifdef USE_HASHMAP_STATS
+	mutable HashMapCounters _counters;
 #endif
+	const char *_statsName;	///< Name in the statistics registry, if registered
+
+	static void getStatsFunc(const void *map, HashMapStats &stats) {
+		((const HM_t *)map)->getStats(stats);
+	}
 
 	Node *allocNode(const Key &key) {
 #ifdef USE_HASHMAP_MEMORY_POOL
@@ -252,6 +315,28 @@ public:
 
 	size_type size() const { return _size; }
 
+	/**
+	 * Register this map in the global statistics registry under the given
+	 * name, which makes it show up in the 'hashmaps' debugger command.
+	 * The name must stay valid as long as the map exists, e.g. by using a
+	 * string literal. Copies of a map are not registered.
+	 */
+	void setStatsName(const char *name) {
+		_statsName = name;
+#ifdef USE_HASHMAP_STATS
+		registerHashMapStats(name, this, &getStatsFunc, &_counters);
+#else
+		registerHashMapStats(name, this, &getStatsFunc, 0);
+#endif
+	}
+
+	void getStats(HashMapStats &stats) const;
+	void resetStats() {
+#ifdef USE_HASHMAP_STATS
+		_counters.reset();
+#endif
+	}
+
 	iterator	begin() {
 		// Find and return the first non-empty entry
 		for (size_type ctr = 0; ctr <= _mask; ++ctr) {
@@ -313,6 +398,7 @@ HashMap<Key, Val, HashFunc, EqualFunc>::HashMap()
 #else
 	: _defaultVal() {
 #endif
+	_statsName = 0;
 	_mask = HASHMAP_MIN_CAPACITY - 1;
 	_storage = new Node *[HASHMAP_MIN_CAPACITY];
 	assert(_storage != NULL);
@@ -320,12 +406,6 @@ HashMap<Key, Val, HashFunc, EqualFunc>::HashMap()
 
 	_size = 0;
 	_deleted = 0;
-
-#ifdef DEBUG_HASH_COLLISIONS
-	_collisions = 0;
-	_lookups = 0;
-	_dummyHits = 0;
-#endif
 }
 
 /**
@@ -335,12 +415,7 @@ HashMap<Key, Val, HashFunc, EqualFunc>::HashMap()
  */
 template<class Key, class Val, class HashFunc, class EqualFunc>
 HashMap<Key, Val, HashFunc, EqualFunc>::HashMap(const HM_t &map) :
-	_defaultVal() {
-#ifdef DEBUG_HASH_COLLISIONS
-	_collisions = 0;
-	_lookups = 0;
-	_dummyHits = 0;
-#endif
+	_statsName(0), _defaultVal() {
 	assign(map);
 }
 
@@ -353,10 +428,9 @@ HashMap<Key, Val, HashFunc, EqualFunc>::~HashMap() {
 	  freeNode(_storage[ctr]);
 
 	delete[] _storage;
-#ifdef DEBUG_HASH_COLLISIONS
-	extern void updateHashCollisionStats(int, int, int, int, int);
-	updateHashCollisionStats(_collisions, _dummyHits, _lookups, _mask+1, _size);
-#endif
+
+	if (_statsName)
+		unregisterHashMapStats(this);
 }
 
 /**
@@ -426,6 +500,10 @@ void HashMap<Key, Val, HashFunc, EqualFunc>::expandStorage(size_type newCapacity
 	const size_type old_mask = _mask;
 	Node **old_storage = _storage;
 
+#ifdef USE_HASHMAP_STATS
+	_counters.rehashes++;
+#endif
+
 	// allocate a new array
 	_size = 0;
 	_deleted = 0;
@@ -466,28 +544,27 @@ template<class Key, class Val, class HashFunc, class EqualFunc>
 typename HashMap<Key, Val, HashFunc, EqualFunc>::size_type HashMap<Key, Val, HashFunc, EqualFunc>::lookup(const Key &key) const {
 	const size_type hash = _hash(key);
 	size_type ctr = hash & _mask;
+#ifdef USE_HASHMAP_STATS
+	uint probes = 1;
+#endif
 	for (size_type perturb = hash; ; perturb >>= HASHMAP_PERTURB_SHIFT) {
 		if (_storage[ctr] == NULL)
 			break;
 		if (_storage[ctr] == HASHMAP_DUMMY_NODE) {
-#ifdef DEBUG_HASH_COLLISIONS
-			_dummyHits++;
+#ifdef USE_HASHMAP_STATS
+			_counters.dummyHits++;
 #endif
 		} else if (_equal(_storage[ctr]->_key, key))
 			break;
 
 		ctr = (5 * ctr + perturb + 1) & _mask;
-
-#ifdef DEBUG_HASH_COLLISIONS
-		_collisions++;
+#ifdef USE_HASHMAP_STATS
+		probes++;
 #endif
 	}
 
-#ifdef DEBUG_HASH_COLLISIONS
-	_lookups++;
-	debug("collisions %d, dummies hit %d, lookups %d, ratio %f in HashMap %p; size %d num elements %d",
-		_collisions, _dummyHits, _lookups, ((double) _collisions / (double)_lookups),
-		(const void *)this, _mask+1, _size);
+#ifdef USE_HASHMAP_STATS
+	_counters.addLookup(probes);
 #endif
 
 	return ctr;
@@ -500,12 +577,15 @@ typename HashMap<Key, Val, HashFunc, EqualFunc>::size_type HashMap<Key, Val, Has
 	const size_type NONE_FOUND = _mask + 1;
 	size_type first_free = NONE_FOUND;
 	bool found = false;
+#ifdef USE_HASHMAP_STATS
+	uint probes = 1;
+#endif
 	for (size_type perturb = hash; ; perturb >>= HASHMAP_PERTURB_SHIFT) {
 		if (_storage[ctr] == NULL)
 			break;
 		if (_storage[ctr] == HASHMAP_DUMMY_NODE) {
-#ifdef DEBUG_HASH_COLLISIONS
-			_dummyHits++;
+#ifdef USE_HASHMAP_STATS
+			_counters.dummyHits++;
 #endif
 			if (first_free != _mask + 1)
 				first_free = ctr;
@@ -515,17 +595,13 @@ typename HashMap<Key, Val, HashFunc, EqualFunc>::size_type HashMap<Key, Val, Has
 		}
 
 		ctr = (5 * ctr + perturb + 1) & _mask;
-
-#ifdef DEBUG_HASH_COLLISIONS
-		_collisions++;
+#ifdef USE_HASHMAP_STATS
+		probes++;
 #endif
 	}
 
-#ifdef DEBUG_HASH_COLLISIONS
-	_lookups++;
-	debug("collisions %d, dummies hit %d, lookups %d, ratio %f in HashMap %p; size %d num elements %d",
-		_collisions, _dummyHits, _lookups, ((double) _collisions / (double)_lookups),
-		(const void *)this, _mask+1, _size);
+#ifdef USE_HASHMAP_STATS
+	_counters.addLookup(probes);
 #endif
 
 	if (!found && first_free != _mask + 1)
@@ -554,6 +630,25 @@ typename HashMap<Key, Val, HashFunc, EqualFunc>::size_type HashMap<Key, Val, Has
 }
 
 
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void HashMap<Key, Val, HashFunc, EqualFunc>::getStats(HashMapStats &stats) const {
+	stats.name = _statsName;
+	stats.size = _size;
+	stats.capacity = _mask + 1;
+	stats.deleted = _deleted;
+	stats.memory = sizeof(*this) + (_mask + 1) * sizeof(Node *);
+#ifdef USE_HASHMAP_MEMORY_POOL
+	stats.memory += _nodePool.getAllocatedSize();
+#else
+	stats.memory += _size * sizeof(Node);
+#endif
+#ifdef USE_HASHMAP_STATS
+	stats.counters = _counters;
+#else
+	stats.counters.reset();
+#endif
+}
+
 template<class Key, class Val, class HashFunc, class EqualFunc>
 bool HashMap<Key, Val, HashFunc, EqualFunc>::contains(const Key &key) const {
 	size_type ctr = lookup(key);
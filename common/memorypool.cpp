@@ -117,6 +117,13 @@ bool MemoryPool::isPointerInPage(void *ptr, const Page &page) {
 	return (ptr >= page.start) && (ptr < (char *)page.start + page.numChunks * _chunkSize);
 }
 
+size_t MemoryPool::getAllocatedSize() const {
+	size_t size = 0;
+	for (size_t i = 0; i < _pages.size(); ++i)
+		size += _pages[i].numChunks * _chunkSize;
+	return size;
+}
+
 void MemoryPool::freeUnusedPages() {
 	//std::sort(_pages.begin(), _pages.end());
 	Array<size_t> numberOfFreeChunksPerPage;
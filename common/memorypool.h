@@ -94,6 +94,12 @@ public:
 	 * Return the chunk size used by this memory pool.
 	 */
 	size_t	getChunkSize() const { return _chunkSize; }
+
+	/**
+	 * Return the number of bytes of all pages allocated from the heap.
+	 * Internal storage of the pool object itself is not included.
+	 */
+	size_t	getAllocatedSize() const;
 };
 
 /**
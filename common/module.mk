@@ -2,6 +2,7 @@ MODULE := common
 
 MODULE_OBJS := \
 	archive.o \
+	arena.o \
 	config-file.o \
 	config-manager.o \
 	coroutines.o \
@@ -54,6 +54,17 @@ uint32 MemoryReadStream::read(void *dataPtr, uint32 dataSize) {
 	return dataSize;
 }
 
+const byte *MemoryReadStream::readView(uint32 dataSize) {
+	if (dataSize > _size - _pos)
+		return 0;
+
+	const byte *data = _ptr;
+	_ptr += dataSize;
+	_pos += dataSize;
+
+	return data;
+}
+
 bool MemoryReadStream::seek(int32 offs, int whence) {
 	// Pre-Condition
 	assert(_pos <= _size);
@@ -108,6 +119,15 @@ bool MemoryWriteStreamDynamic::seek(int32 offs, int whence) {
 
 #pragma mark -
 
+uint32 SeekableReadStream::readOrView(const byte *&data, uint32 dataSize, byte *buffer) {
+	data = readView(dataSize);
+	if (data)
+		return dataSize;
+
+	data = buffer;
+	return read(buffer, dataSize);
+}
+
 enum {
 	LF = 0x0A,
 	CR = 0x0D
@@ -240,6 +260,17 @@ bool SeekableSubReadStream::seek(int32 offset, int whence) {
 	return ret;
 }
 
+const byte *SeekableSubReadStream::readView(uint32 dataSize) {
+	if (dataSize > _end - _pos)
+		return 0;
+
+	const byte *data = _parentStream->readView(dataSize);
+	if (data)
+		_pos += dataSize;
+
+	return data;
+}
+
 uint32 SafeSeekableSubReadStream::read(void *dataPtr, uint32 dataSize) {
 	// Make sure the parent stream is at the right position
 	seek(0, SEEK_CUR);
@@ -247,6 +278,13 @@ uint32 SafeSeekableSubReadStream::read(void *dataPtr, uint32 dataSize) {
 	return SeekableSubReadStream::read(dataPtr, dataSize);
 }
 
+const byte *SafeSeekableSubReadStream::readView(uint32 dataSize) {
+	// Make sure the parent stream is at the right position
+	seek(0, SEEK_CUR);
+
+	return SeekableSubReadStream::readView(dataSize);
+}
+
 
 #pragma mark -
 
@@ -371,6 +371,33 @@ public:
 	 */
 	virtual bool skip(uint32 offset) { return seek(offset, SEEK_CUR); }
 
+	/**
+	 * Zero-copy variant of read(). If the next dataSize bytes of the stream
+	 * are available in memory, returns a pointer to them and advances the
+	 * stream position past them, just like read() would. The data stays
+	 * valid and unchanged as long as the stream exists.
+	 *
+	 * Streams which are not backed by memory return 0, and so do memory
+	 * streams if fewer than dataSize bytes are left. The stream position
+	 * is not changed in that case.
+	 *
+	 * @param dataSize	number of bytes to view
+	 * @return a pointer to the data, or 0 if no view is available
+	 */
+	virtual const byte *readView(uint32 dataSize) { return 0; }
+
+	/**
+	 * Read data, avoiding to copy it if possible. Tries to obtain a view
+	 * of the data with readView(), and reads the data into the supplied
+	 * buffer otherwise.
+	 *
+	 * @param data		set to the view or to buffer, wherever the data is
+	 * @param dataSize	number of bytes to be read
+	 * @param buffer	buffer of at least dataSize bytes, used if no view is available
+	 * @return the number of bytes which were actually read
+	 */
+	uint32 readOrView(const byte *&data, uint32 dataSize, byte *buffer);
+
 	/**
 	 * Reads at most one less than the number of characters specified
 	 * by bufSize from the and stores them in the string buf. Reading
@@ -77,6 +77,7 @@ public:
 	virtual int32 size() const { return _end - _begin; }
 
 	virtual bool seek(int32 offset, int whence = SEEK_SET);
+	virtual const byte *readView(uint32 dataSize);
 };
 
 /**
@@ -114,6 +115,7 @@ public:
 	}
 
 	virtual uint32 read(void *dataPtr, uint32 dataSize);
+	virtual const byte *readView(uint32 dataSize);
 };
 
 
@@ -24,6 +24,7 @@
 #define FORBIDDEN_SYMBOL_ALLOW_ALL
 
 #include "common/zlib.h"
+#include "common/array.h"
 #include "common/ptr.h"
 #include "common/util.h"
 #include "common/stream.h"
@@ -89,11 +90,25 @@ bool inflateZlibHeaderless(byte *dst, uint dstLen, const byte *src, uint srcLen,
  * A simple wrapper class which can be used to wrap around an arbitrary
  * other SeekableReadStream and will then provide on-the-fly decompression support.
  * Assumes the compressed data to be in gzip format.
+ *
+ * To speed up seeking, the state of the decompressor is saved at regular
+ * intervals while decompressing (like zlib's zran example does). A seek then
+ * only needs to decompress the data between the closest preceding checkpoint
+ * and the new position, instead of restarting at the beginning of the file.
+ * Every checkpoint keeps a copy of the 32 KB inflate window.
  */
 class GZipReadStream : public SeekableReadStream {
 protected:
 	enum {
-		BUFSIZE = 16384		// 1 << MAX_WBITS
+		BUFSIZE = 16384,		// 1 << MAX_WBITS
+		WINSIZE = 32768			// Size of the inflate window
+	};
+
+	struct Checkpoint {
+		uint32 out;		///< Position in the uncompressed data
+		int32 in;		///< Position of the next complete byte in the compressed data
+		int bits;		///< Number of bits of the previous byte which are still unused
+		byte *window;	///< The uncompressed data before out
 	};
 
 	byte	_buf[BUFSIZE];
@@ -105,9 +120,110 @@ protected:
 	uint32 _origSize;
 	bool _eos;
 
+	uint32 _checkpointInterval;
+	byte *_window;						///< The most recently uncompressed data, used as ring buffer
+	Array<Checkpoint> _checkpoints;
+
+	void restart() {
+		// The stream may have been switched to raw deflate data by
+		// restoreCheckpoint(), so reinitialize it completely.
+		inflateEnd(&_stream);
+		_stream = z_stream();
+		_wrapped->seek(0, SEEK_SET);
+		_pos = 0;
+
+		// Adding 32 to windowBits indicates to zlib that it is supposed to
+		// automatically detect whether gzip or zlib headers are used for
+		// the compressed file. This feature was added in zlib 1.2.0.4,
+		// released 10 August 2003.
+		// Note: This is *crucial* for savegame compatibility, do *not* remove!
+		_zlibErr = inflateInit2(&_stream, MAX_WBITS + 32);
+
+		// Setup input buffer
+		_stream.next_in = _buf;
+		_stream.avail_in = 0;
+	}
+
+	/** Append uncompressed data, which ends at position end, to the window. */
+	void updateWindow(const byte *data, uint32 size, uint32 end) {
+		if (size > WINSIZE) {
+			data += size - WINSIZE;
+			size = WINSIZE;
+		}
+
+		uint32 start = (end - size) & (WINSIZE - 1);
+		uint32 part = MIN<uint32>(size, WINSIZE - start);
+		memcpy(_window + start, data, part);
+		memcpy(_window, data + part, size - part);
+	}
+
+	void addCheckpoint(uint32 out) {
+		Checkpoint cp;
+		cp.out = out;
+		cp.in = _wrapped->pos() - _stream.avail_in;
+		cp.bits = _stream.data_type & 7;
+		cp.window = new byte[WINSIZE];
+
+		// Store the window in order, so that it can be passed to
+		// inflateSetDictionary() directly.
+		uint32 start = out & (WINSIZE - 1);
+		memcpy(cp.window, _window + start, WINSIZE - start);
+		memcpy(cp.window + WINSIZE - start, _window, start);
+
+		_checkpoints.push_back(cp);
+	}
+
+	bool restoreCheckpoint(const Checkpoint &cp) {
+		inflateEnd(&_stream);
+		_stream = z_stream();
+
+		// The gzip or zlib header is behind us, continue with raw deflate data
+		_zlibErr = inflateInit2(&_stream, -MAX_WBITS);
+		if (_zlibErr != Z_OK)
+			return false;
+
+		_wrapped->seek(cp.in - (cp.bits ? 1 : 0), SEEK_SET);
+		if (cp.bits) {
+#if ZLIB_VERNUM >= 0x1224
+			byte partial = _wrapped->readByte();
+			_zlibErr = inflatePrime(&_stream, cp.bits, partial >> (8 - cp.bits));
+#else
+			// inflatePrime() is not available in zlib versions before
+			// 1.2.2.4, so checkpoints are disabled in the constructor.
+			_zlibErr = Z_STREAM_ERROR;
+#endif
+			if (_zlibErr != Z_OK)
+				return false;
+		}
+
+		uint32 dictSize = MIN<uint32>(cp.out, WINSIZE);
+		_zlibErr = inflateSetDictionary(&_stream, cp.window + WINSIZE - dictSize, dictSize);
+		if (_zlibErr != Z_OK)
+			return false;
+
+		_stream.next_in = _buf;
+		_stream.avail_in = 0;
+		_pos = cp.out;
+		updateWindow(cp.window, WINSIZE, cp.out);
+		return true;
+	}
+
+	/** Return the last checkpoint before the given position, or 0 if there is none. */
+	const Checkpoint *findCheckpoint(uint32 pos) const {
+		uint lo = 0, hi = _checkpoints.size();
+		while (lo < hi) {
+			uint mid = (lo + hi) / 2;
+			if (_checkpoints[mid].out <= pos)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		return lo ? &_checkpoints[lo - 1] : 0;
+	}
+
 public:
 
-	GZipReadStream(SeekableReadStream *w, uint32 knownSize = 0) : _wrapped(w), _stream() {
+	GZipReadStream(SeekableReadStream *w, uint32 knownSize = 0, uint32 checkpointInterval = 0) : _wrapped(w), _stream() {
 		assert(w != 0);
 
 		// Verify file header is correct
@@ -125,26 +241,26 @@ public:
 			// use an otherwise known size if supplied.
 			_origSize = knownSize;
 		}
-		_pos = 0;
-		w->seek(0, SEEK_SET);
 		_eos = false;
 
-		// Adding 32 to windowBits indicates to zlib that it is supposed to
-		// automatically detect whether gzip or zlib headers are used for
-		// the compressed file. This feature was added in zlib 1.2.0.4,
-		// released 10 August 2003.
-		// Note: This is *crucial* for savegame compatibility, do *not* remove!
-		_zlibErr = inflateInit2(&_stream, MAX_WBITS + 32);
-		if (_zlibErr != Z_OK)
-			return;
+		// Only bother with checkpoints if there is more than one interval
+		// of data. If the size is unknown, always use them.
+		_checkpointInterval = checkpointInterval;
+		if (_origSize && _origSize <= _checkpointInterval)
+			_checkpointInterval = 0;
+#if ZLIB_VERNUM < 0x1224
+		_checkpointInterval = 0;
+#endif
+		_window = _checkpointInterval ? new byte[WINSIZE] : 0;
 
-		// Setup input buffer
-		_stream.next_in = _buf;
-		_stream.avail_in = 0;
+		restart();
 	}
 
 	~GZipReadStream() {
 		inflateEnd(&_stream);
+		for (uint i = 0; i < _checkpoints.size(); ++i)
+			delete[] _checkpoints[i].window;
+		delete[] _window;
 	}
 
 	bool err() const { return (_zlibErr != Z_OK) && (_zlibErr != Z_STREAM_END); }
@@ -164,7 +280,24 @@ public:
 				_stream.next_in = _buf;
 				_stream.avail_in = _wrapped->read(_buf, BUFSIZE);
 			}
-			_zlibErr = inflate(&_stream, Z_NO_FLUSH);
+
+			if (!_checkpointInterval) {
+				_zlibErr = inflate(&_stream, Z_NO_FLUSH);
+				continue;
+			}
+
+			// Stop at the end of every deflate block, since those are
+			// the only places where checkpoints can be made.
+			byte *start = _stream.next_out;
+			_zlibErr = inflate(&_stream, Z_BLOCK);
+
+			uint32 out = _pos + dataSize - _stream.avail_out;
+			updateWindow(start, _stream.next_out - start, out);
+
+			uint32 last = _checkpoints.empty() ? 0 : _checkpoints.back().out;
+			if (_zlibErr == Z_OK && (_stream.data_type & 128) && !(_stream.data_type & 64) &&
+			    out >= last + _checkpointInterval)
+				addCheckpoint(out);
 		}
 
 		// Update the position counter
@@ -198,28 +331,30 @@ public:
 
 		assert(newPos >= 0);
 
-		if ((uint32)newPos < _pos) {
+		// Jump to the closest checkpoint, if it saves decompressing data.
+		// This also works for forward seeks into already visited data.
+		const Checkpoint *cp = findCheckpoint(newPos);
+		if (cp && (cp->out > _pos || (uint32)newPos < _pos)) {
+			if (!restoreCheckpoint(*cp))
+				return false;	// FIXME: STREAM REWRITE
+		} else if ((uint32)newPos < _pos) {
 			// To search backward, we have to restart the whole decompression
 			// from the start of the file. A rather wasteful operation, best
 			// to avoid it. :/
 #if DEBUG
-			warning("Backward seeking in GZipReadStream detected");
+			if (!_checkpointInterval)
+				warning("Backward seeking in GZipReadStream detected");
 #endif
-			_pos = 0;
-			_wrapped->seek(0, SEEK_SET);
-			_zlibErr = inflateReset(&_stream);
+			restart();
 			if (_zlibErr != Z_OK)
 				return false;	// FIXME: STREAM REWRITE
-			_stream.next_in = _buf;
-			_stream.avail_in = 0;
 		}
 
 		offset = newPos - _pos;
 
-		// Skip the given amount of data (very inefficient if one tries to skip
-		// huge amounts of data, but usually client code will only skip a few
-		// bytes, so this should be fine.
-		byte tmpBuf[1024];
+		// Skip the given amount of data. Checkpoints limit this to at most
+		// one checkpoint interval when seeking backwards.
+		byte tmpBuf[4096];
 		while (!err() && offset > 0) {
 			offset -= read(tmpBuf, MIN((int32)sizeof(tmpBuf), offset));
 		}
@@ -337,7 +472,7 @@ public:
 
 #endif	// USE_ZLIB
 
-SeekableReadStream *wrapCompressedReadStream(SeekableReadStream *toBeWrapped, uint32 knownSize) {
+SeekableReadStream *wrapCompressedReadStream(SeekableReadStream *toBeWrapped, uint32 knownSize, uint32 checkpointInterval) {
 #if defined(USE_ZLIB)
 	if (toBeWrapped) {
 		uint16 header = toBeWrapped->readUint16BE();
@@ -346,7 +481,7 @@ SeekableReadStream *wrapCompressedReadStream(SeekableReadStream *toBeWrapped, ui
 				      header % 31 == 0));
 		toBeWrapped->seek(-2, SEEK_CUR);
 		if (isCompressed)
-			return new GZipReadStream(toBeWrapped, knownSize);
+			return new GZipReadStream(toBeWrapped, knownSize, checkpointInterval);
 	}
 #endif
 	return toBeWrapped;
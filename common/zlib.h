@@ -91,13 +91,21 @@ bool inflateZlibHeaderless(byte *dst, uint dstLen, const byte *src, uint srcLen,
  * the decompressed length at wrap-time, then it can be supplied as knownSize
  * here. knownSize will be ignored if the GZip-stream DOES include a length.
  *
+ * Seeking backwards in the compressed stream requires decompressing the data
+ * again. To limit this, the decompressor state is saved every
+ * checkpointInterval bytes of uncompressed data, so that no seek needs to
+ * decompress more than one interval of data. Each checkpoint costs 32 KB of
+ * memory; an interval of 0 disables checkpoints, which makes every backward
+ * seek restart at the beginning of the stream.
+ *
  * It is safe to call this with a NULL parameter (in this case, NULL is
  * returned).
  *
  * @param toBeWrapped	the stream to be wrapped (if it is in gzip-format)
  * @param knownSize		a supplied length of the compressed data (if not available directly) 
+ * @param checkpointInterval	the distance between checkpoints in the uncompressed data
  */
-SeekableReadStream *wrapCompressedReadStream(SeekableReadStream *toBeWrapped, uint32 knownSize = 0);
+SeekableReadStream *wrapCompressedReadStream(SeekableReadStream *toBeWrapped, uint32 knownSize = 0, uint32 checkpointInterval = 256 * 1024);
 
 /**
  * Take an arbitrary WriteStream and wrap it in a custom stream which provides
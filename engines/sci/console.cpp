@@ -81,6 +81,9 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	// Variables
 	DVar_Register("sleeptime_factor",	&g_debug_sleeptime_factor, DVAR_INT, 0);
 	DVar_Register("gc_interval",		&engine->_gamestate->scriptGCInterval, DVAR_INT, 0);
+	DVar_Register("gc_incremental",		&engine->_gamestate->incrementalGC, DVAR_BOOL, 0);
+	DVar_Register("predecode_scripts",	&_debugState.predecodeScripts, DVAR_BOOL, 0);
+	DVar_Register("span_drawing",		&_debugState.spanDrawing, DVAR_BOOL, 0);
 	DVar_Register("simulated_key",		&g_debug_simulated_key, DVAR_INT, 0);
 	DVar_Register("track_mouse_clicks",	&g_debug_track_mouse_clicks, DVAR_BOOL, 0);
 	DVar_Register("script_abort_flag",	&_engine->_gamestate->abortScriptProcessing, DVAR_INT, 0);
@@ -112,6 +115,7 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	DCmd_Register("list",				WRAP_METHOD(Console, cmdList));
 	DCmd_Register("hexgrep",			WRAP_METHOD(Console, cmdHexgrep));
 	DCmd_Register("verify_scripts",		WRAP_METHOD(Console, cmdVerifyScripts));
+	DCmd_Register("decompress_bench",	WRAP_METHOD(Console, cmdDecompressionBenchmark));
 	// Game
 	DCmd_Register("save_game",			WRAP_METHOD(Console, cmdSaveGame));
 	DCmd_Register("restore_game",		WRAP_METHOD(Console, cmdRestoreGame));
@@ -138,6 +142,8 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	DCmd_Register("pi",                 WRAP_METHOD(Console, cmdPlaneItemList));	// alias
 	DCmd_Register("saved_bits",         WRAP_METHOD(Console, cmdSavedBits));
 	DCmd_Register("show_saved_bits",    WRAP_METHOD(Console, cmdShowSavedBits));
+	DCmd_Register("cel_cache",			WRAP_METHOD(Console, cmdCelCache));
+	DCmd_Register("pic_cache",			WRAP_METHOD(Console, cmdPictureCache));
 	// Segments
 	DCmd_Register("segment_table",		WRAP_METHOD(Console, cmdPrintSegmentTable));
 	DCmd_Register("segtable",			WRAP_METHOD(Console, cmdPrintSegmentTable));	// alias
@@ -185,6 +191,8 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	DCmd_Register("disasm_addr",		WRAP_METHOD(Console, cmdDisassembleAddress));
 	DCmd_Register("find_callk",			WRAP_METHOD(Console, cmdFindKernelFunctionCall));
 	DCmd_Register("send",				WRAP_METHOD(Console, cmdSend));
+	DCmd_Register("vm_bench",			WRAP_METHOD(Console, cmdVMBenchmark));
+	DCmd_Register("avoidpath_bench",	WRAP_METHOD(Console, cmdAvoidPathBenchmark));
 	DCmd_Register("go",					WRAP_METHOD(Console, cmdGo));
 	DCmd_Register("logkernel",          WRAP_METHOD(Console, cmdLogKernel));
 	// Breakpoints
@@ -230,6 +238,9 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	_debugState.breakpointWasHit = false;
 	_debugState._breakpoints.clear(); // No breakpoints defined
 	_debugState._activeBreakpointTypes = 0;
+	_debugState.predecodeScripts = false;
+	_debugState.recordInstructions = false;
+	_debugState.spanDrawing = true;
 }
 
 Console::~Console() {
@@ -313,6 +324,8 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	DebugPrintf("---------\n");
 	DebugPrintf("sleeptime_factor: Factor to multiply with wait times in kWait()\n");
 	DebugPrintf("gc_interval: Number of kernel calls in between garbage collections\n");
+	DebugPrintf("gc_incremental: Spread garbage collections over several kernel calls\n");
+	DebugPrintf("span_drawing: Draw cels in runs of pixels. Set to 0 to draw them pixel by pixel\n");
 	DebugPrintf("simulated_key: Add a key with the specified scan code to the event list\n");
 	DebugPrintf("track_mouse_clicks: Toggles mouse click tracking to the console\n");
 	DebugPrintf("weak_validations: Turns some validation errors into warnings\n");
@@ -352,6 +365,7 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	DebugPrintf(" list - Lists all the resources of a given type\n");
 	DebugPrintf(" hexgrep - Searches some resources for a particular sequence of bytes, represented as hexadecimal numbers\n");
 	DebugPrintf(" verify_scripts - Performs sanity checks on SCI1.1-SCI2.1 game scripts (e.g. if they're up to 64KB in total)\n");
+	DebugPrintf(" decompress_bench - Measures how fast the resources of the game are decompressed\n");
 	DebugPrintf("\n");
 	DebugPrintf("Game:\n");
 	DebugPrintf(" save_game - Saves the current game state to the hard disk\n");
@@ -376,6 +390,8 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	DebugPrintf(" plane_items / pi - Shows a list of all items for a plane (SCI2+)\n");
 	DebugPrintf(" saved_bits - List saved bits on the hunk\n");
 	DebugPrintf(" show_saved_bits - Display saved bits\n");
+	DebugPrintf(" cel_cache - Shows how well the cache of unpacked cels works\n");
+	DebugPrintf(" pic_cache - Shows how well the cache of rendered pictures works (SCI0-SCI1.1)\n");
 	DebugPrintf("\n");
 	DebugPrintf("Segments:\n");
 	DebugPrintf(" segment_table / segtable - Lists all segments\n");
@@ -415,6 +431,8 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	DebugPrintf(" disasm - Disassembles a method by name\n");
 	DebugPrintf(" disasm_addr - Disassembles one or more commands\n");
 	DebugPrintf(" send - Sends a message to an object\n");
+	DebugPrintf(" vm_bench - Records executed instructions and measures how fast they are fetched\n");
+	DebugPrintf(" avoidpath_bench - Records pathfinding calls and measures how fast they are replayed\n");
 	DebugPrintf(" go - Executes the script\n");
 	DebugPrintf(" logkernel - Logs kernel calls\n");
 	DebugPrintf("\n");
@@ -900,6 +918,23 @@ bool Console::cmdVerifyScripts(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdDecompressionBenchmark(int argc, const char **argv) {
+	if (argc > 2) {
+		DebugPrintf("Decompresses all compressed resources of the game and shows how fast this is done for each compression method\n");
+		DebugPrintf("Usage: %s [iterations]\n", argv[0]);
+		return true;
+	}
+
+	int iterations = (argc == 2) ? atoi(argv[1]) : 10;
+	if (iterations < 1) {
+		DebugPrintf("Invalid number of iterations\n");
+		return true;
+	}
+
+	_engine->getResMan()->benchmarkDecompression(this, iterations);
+	return true;
+}
+
 // Same as in sound/drivers/midi.cpp
 uint8 getGmInstrument(const Mt32ToGmMap &Mt32Ins) {
 	if (Mt32Ins.gmInstr == MIDI_MAPPED_TO_RHYTHM)
@@ -1842,6 +1877,20 @@ bool Console::cmdShowSavedBits(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdCelCache(int argc, const char **argv) {
+	_engine->_gfxCache->printCelCacheStats(this);
+	return true;
+}
+
+bool Console::cmdPictureCache(int argc, const char **argv) {
+	if (!_engine->_gfxPaint16) {
+		DebugPrintf("This SCI version does not have a picture cache\n");
+		return true;
+	}
+
+	_engine->_gfxPaint16->printPictureCacheStats(this);
+	return true;
+}
 
 bool Console::cmdParseGrammar(int argc, const char **argv) {
 	DebugPrintf("Parse grammar, in strict GNF:\n");
@@ -2273,7 +2322,8 @@ bool Console::cmdGCShowReachable(int argc, const char **argv) {
 	}
 
 	DebugPrintf("Reachable from %04x:%04x:\n", PRINT_REG(addr));
-	const Common::Array<reg_t> tmp = mobj->listAllOutgoingReferences(addr);
+	Common::Array<reg_t> tmp;
+	mobj->listAllOutgoingReferences(addr, tmp);
 	for (Common::Array<reg_t>::const_iterator it = tmp.begin(); it != tmp.end(); ++it)
 		if (it->getSegment())
 			g_sci->getSciDebugger()->DebugPrintf("  %04x:%04x\n", PRINT_REG(*it));
@@ -3201,6 +3251,72 @@ bool Console::cmdSend(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdVMBenchmark(int argc, const char **argv) {
+	if (argc > 2) {
+		DebugPrintf("Replays the instructions the VM has executed and shows how long fetching them\n");
+		DebugPrintf("takes, once decoding them when they are executed and once decoded in advance\n");
+		DebugPrintf("Usage: %s record|stop|[iterations]\n", argv[0]);
+		DebugPrintf("\"record\" starts recording the executed instructions, \"stop\" ends it\n");
+		return true;
+	}
+
+	if (argc == 2 && !scumm_stricmp(argv[1], "record")) {
+		_debugState.recordedInstructions.clear();
+		_debugState.recordInstructions = true;
+		DebugPrintf("Recording executed instructions, up to %d of them\n", kMaxRecordedInstructions);
+		return true;
+	}
+
+	if (argc == 2 && !scumm_stricmp(argv[1], "stop")) {
+		_debugState.recordInstructions = false;
+		DebugPrintf("Stopped recording, %d instructions recorded\n", _debugState.recordedInstructions.size());
+		return true;
+	}
+
+	int iterations = (argc == 2) ? atoi(argv[1]) : 10;
+	if (iterations < 1) {
+		DebugPrintf("Invalid number of iterations\n");
+		return true;
+	}
+
+	benchmarkVM(_engine->_gamestate, this, iterations);
+	return true;
+}
+
+bool Console::cmdAvoidPathBenchmark(int argc, const char **argv) {
+	if (argc > 2) {
+		DebugPrintf("Replays the most recent pathfinding calls of the game and shows how long they take\n");
+		DebugPrintf("Usage: %s record|stop|[iterations]\n", argv[0]);
+		DebugPrintf("\"record\" starts recording the pathfinding calls, \"stop\" ends it\n");
+		return true;
+	}
+
+	PathfindingCache &cache = _engine->_gamestate->_pathfindingCache;
+
+	if (argc == 2 && !scumm_stricmp(argv[1], "record")) {
+		cache.recorded.clear();
+		cache.recordNext = 0;
+		cache.recording = true;
+		DebugPrintf("Recording pathfinding calls, the last %d are kept\n", PathfindingCache::kMaxRecorded);
+		return true;
+	}
+
+	if (argc == 2 && !scumm_stricmp(argv[1], "stop")) {
+		cache.recording = false;
+		DebugPrintf("Stopped recording, %d pathfinding calls recorded\n", cache.recorded.size());
+		return true;
+	}
+
+	int iterations = (argc == 2) ? atoi(argv[1]) : 100;
+	if (iterations < 1) {
+		DebugPrintf("Invalid number of iterations\n");
+		return true;
+	}
+
+	benchmarkAvoidPath(_engine->_gamestate, this, iterations);
+	return true;
+}
+
 bool Console::cmdGo(int argc, const char **argv) {
 	// CHECKME: is this necessary?
 	_debugState.seeking = kDebugSeekNothing;
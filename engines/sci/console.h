@@ -75,6 +75,7 @@ private:
 	bool cmdList(int argc, const char **argv);
 	bool cmdHexgrep(int argc, const char **argv);
 	bool cmdVerifyScripts(int argc, const char **argv);
+	bool cmdDecompressionBenchmark(int argc, const char **argv);
 	// Game
 	bool cmdSaveGame(int argc, const char **argv);
 	bool cmdRestoreGame(int argc, const char **argv);
@@ -98,6 +99,8 @@ private:
 	bool cmdPlaneItemList(int argc, const char **argv);
 	bool cmdSavedBits(int argc, const char **argv);
 	bool cmdShowSavedBits(int argc, const char **argv);
+	bool cmdCelCache(int argc, const char **argv);
+	bool cmdPictureCache(int argc, const char **argv);
 	// Segments
 	bool cmdPrintSegmentTable(int argc, const char **argv);
 	bool cmdSegmentInfo(int argc, const char **argv);
@@ -134,6 +137,8 @@ private:
 	bool cmdDisassembleAddress(int argc, const char **argv);
 	bool cmdFindKernelFunctionCall(int argc, const char **argv);
 	bool cmdSend(int argc, const char **argv);
+	bool cmdVMBenchmark(int argc, const char **argv);
+	bool cmdAvoidPathBenchmark(int argc, const char **argv);
 	bool cmdGo(int argc, const char **argv);
 	bool cmdLogKernel(int argc, const char **argv);
 	// Breakpoints
@@ -23,6 +23,7 @@
 #ifndef SCI_DEBUG_H
 #define SCI_DEBUG_H
 
+#include "common/array.h"
 #include "common/list.h"
 #include "sci/engine/vm_types.h"	// for StackPtr
 
@@ -60,6 +61,16 @@ enum DebugSeeking {
 	kDebugSeekStepOver = 5      // Step forward until we reach same stack-level again
 };
 
+/** An instruction executed by the VM, as replayed by the vm_bench command */
+struct RecordedInstruction {
+	reg32_t pc;
+	int scriptNr; ///< Script at pc when it was recorded, to skip it once the script is gone
+};
+
+enum {
+	kMaxRecordedInstructions = 1 << 20
+};
+
 struct DebugState {
 	bool debugging;
 	bool breakpointWasHit;
@@ -72,6 +83,17 @@ struct DebugState {
 	StackPtr old_sp;
 	Common::List<Breakpoint> _breakpoints;   //< List of breakpoints
 	int _activeBreakpointTypes;  //< Bit mask specifying which types of breakpoints are active
+	bool predecodeScripts;		// Execute instructions decoded in advance, see Script::findInstruction()
+	bool recordInstructions;	// Record the executed instructions for the vm_bench command
+	Common::Array<RecordedInstruction> recordedInstructions;
+	bool spanDrawing;			// Draw cels in runs of pixels instead of pixel by pixel, see GfxView::draw()
+
+	void recordInstruction(reg32_t pc, int scriptNr) {
+		RecordedInstruction instruction = { pc, scriptNr };
+		recordedInstructions.push_back(instruction);
+		if (recordedInstructions.size() >= kMaxRecordedInstructions)
+			recordInstructions = false;
+	}
 };
 
 // Various global variables used for debugging are declared here
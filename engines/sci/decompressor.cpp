@@ -33,7 +33,7 @@
 #include "sci/resource.h"
 
 namespace Sci {
-int Decompressor::unpack(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked) {
+int Decompressor::unpack(Common::SeekableReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked) {
 	uint32 chunk;
 	while (nPacked && !(src->eos() || src->err())) {
 		chunk = MIN<uint32>(1024, nPacked);
@@ -44,7 +44,7 @@ int Decompressor::unpack(Common::ReadStream *src, byte *dest, uint32 nPacked, ui
 	return (src->eos() || src->err()) ? 1 : 0;
 }
 
-void Decompressor::init(Common::ReadStream *src, byte *dest, uint32 nPacked,
+void Decompressor::init(Common::SeekableReadStream *src, byte *dest, uint32 nPacked,
                         uint32 nUnpacked) {
 	_src = src;
 	_dest = dest;
@@ -53,13 +53,39 @@ void Decompressor::init(Common::ReadStream *src, byte *dest, uint32 nPacked,
 	_nBits = 0;
 	_dwRead = _dwWrote = 0;
 	_dwBits = 0;
+
+	delete[] _packed;
+	_packed = 0;
+
+	// Unpack straight from the stream's memory, if it has any
+	_in = src->readView(nPacked);
+	if (!_in) {
+		_packed = new byte[nPacked];
+		uint32 bytesRead = src->read(_packed, nPacked);
+		// Like reading past the end of the stream, missing data reads as zeroes
+		memset(_packed + bytesRead, 0, nPacked - bytesRead);
+		_in = _packed;
+	}
+	_inEnd = _in + nPacked;
 }
 
 void Decompressor::fetchBitsMSB() {
+	// Refill as many whole bytes as fit with one 32-bit read, if possible
+	if (_inEnd - _in >= 4) {
+		const uint count = (32 - _nBits) >> 3;
+		uint32 word = READ_BE_UINT32(_in);
+		if (count < 4)
+			word &= ~(0xFFFFFFFF >> (count << 3));
+		_dwBits |= word >> _nBits;
+		_nBits += count << 3;
+		_in += count;
+		_dwRead += count;
+		return;
+	}
+
 	while (_nBits <= 24) {
-		_dwBits |= ((uint32)_src->readByte()) << (24 - _nBits);
+		_dwBits |= ((uint32)getByte()) << (24 - _nBits);
 		_nBits += 8;
-		_dwRead++;
 	}
 }
 
@@ -78,10 +104,22 @@ byte Decompressor::getByteMSB() {
 }
 
 void Decompressor::fetchBitsLSB() {
+	// Refill as many whole bytes as fit with one 32-bit read, if possible
+	if (_inEnd - _in >= 4) {
+		const uint count = (32 - _nBits) >> 3;
+		uint32 word = READ_LE_UINT32(_in);
+		if (count < 4)
+			word &= (1 << (count << 3)) - 1;
+		_dwBits |= word << _nBits;
+		_nBits += count << 3;
+		_in += count;
+		_dwRead += count;
+		return;
+	}
+
 	while (_nBits <= 24) {
-		_dwBits |= ((uint32)_src->readByte()) << _nBits;
+		_dwBits |= ((uint32)getByte()) << _nBits;
 		_nBits += 8;
-		_dwRead++;
 	}
 }
 
@@ -99,23 +137,40 @@ byte Decompressor::getByteLSB() {
 	return getBitsLSB(8);
 }
 
-void Decompressor::putByte(byte b) {
-	_dest[_dwWrote++] = b;
+byte Decompressor::getByte() {
+	_dwRead++;
+	return (_in < _inEnd) ? *_in++ : 0;
+}
+
+void Decompressor::copyUnpacked(uint32 pos, uint32 length) {
+	byte *dst = _dest + _dwWrote;
+	const byte *src = _dest + pos;
+
+	if (pos + length <= _dwWrote) {
+		memcpy(dst, src, length);
+	} else {
+		// Overlapping copies repeat the data, so these have to be done byte by byte
+		for (uint32 i = 0; i < length; i++)
+			dst[i] = src[i];
+	}
+
+	_dwWrote += length;
 }
 //-------------------------------
 //  Huffman decompressor
 //-------------------------------
-int DecompressorHuffman::unpack(Common::ReadStream *src, byte *dest, uint32 nPacked,
+int DecompressorHuffman::unpack(Common::SeekableReadStream *src, byte *dest, uint32 nPacked,
 								uint32 nUnpacked) {
 	init(src, dest, nPacked, nUnpacked);
 	byte numnodes;
 	int16 c;
 	uint16 terminator;
 
-	numnodes = _src->readByte();
-	terminator = _src->readByte() | 0x100;
+	numnodes = getByte();
+	terminator = getByte() | 0x100;
 	_nodes = new byte [numnodes << 1];
-	_src->read(_nodes, numnodes << 1);
+	for (int i = 0; i < numnodes << 1; i++)
+		_nodes[i] = getByte();
 
 	while ((c = getc2()) != terminator && (c >= 0) && !isFinished())
 		putByte(c);
@@ -142,7 +197,7 @@ int16 DecompressorHuffman::getc2() {
 //-------------------------------
 // LZW Decompressor for SCI0/01/1
 //-------------------------------
-void DecompressorLZW::init(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked) {
+void DecompressorLZW::init(Common::SeekableReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked) {
 	Decompressor::init(src, dest, nPacked, nUnpacked);
 
 	_numbits = 9;
@@ -150,7 +205,7 @@ void DecompressorLZW::init(Common::ReadStream *src, byte *dest, uint32 nPacked,
 	_endtoken = 0x1ff;
 }
 
-int DecompressorLZW::unpack(Common::ReadStream *src, byte *dest, uint32 nPacked,
+int DecompressorLZW::unpack(Common::SeekableReadStream *src, byte *dest, uint32 nPacked,
 								uint32 nUnpacked) {
 	byte *buffer = NULL;
 
@@ -176,7 +231,7 @@ int DecompressorLZW::unpack(Common::ReadStream *src, byte *dest, uint32 nPacked,
 	return 0;
 }
 
-int DecompressorLZW::unpackLZW(Common::ReadStream *src, byte *dest, uint32 nPacked,
+int DecompressorLZW::unpackLZW(Common::SeekableReadStream *src, byte *dest, uint32 nPacked,
                                 uint32 nUnpacked) {
 	init(src, dest, nPacked, nUnpacked);
 
@@ -221,11 +276,9 @@ int DecompressorLZW::unpackLZW(Common::ReadStream *src, byte *dest, uint32 nPack
 					// For me this seems a normal situation, It's necessary to handle it
 					warning("unpackLZW: Trying to write beyond the end of array(len=%d, destctr=%d, tok_len=%d)",
 					        _szUnpacked, _dwWrote, tokenlastlength);
-					for (int i = 0; _dwWrote < _szUnpacked; i++)
-						putByte(dest[tokenlist[token] + i]);
+					copyUnpacked(tokenlist[token], _szUnpacked - _dwWrote);
 				} else
-					for (int i = 0; i < tokenlastlength; i++)
-						putByte(dest[tokenlist[token] + i]);
+					copyUnpacked(tokenlist[token], tokenlastlength);
 			} else {
 				tokenlastlength = 1;
 				if (_dwWrote >= _szUnpacked)
@@ -252,7 +305,7 @@ int DecompressorLZW::unpackLZW(Common::ReadStream *src, byte *dest, uint32 nPack
 	return _dwWrote == _szUnpacked ? 0 : SCI_ERROR_DECOMPRESSION_ERROR;
 }
 
-int DecompressorLZW::unpackLZW1(Common::ReadStream *src, byte *dest, uint32 nPacked,
+int DecompressorLZW::unpackLZW1(Common::SeekableReadStream *src, byte *dest, uint32 nPacked,
                                 uint32 nUnpacked) {
 	init(src, dest, nPacked, nUnpacked);
 
@@ -315,12 +368,12 @@ int DecompressorLZW::unpackLZW1(Common::ReadStream *src, byte *dest, uint32 nPac
 			}
 			lastchar = stak[stakptr++] = token & 0xff;
 			// put stack in buffer
-			while (stakptr > 0) {
-				putByte(stak[--stakptr]);
-				if (_dwWrote == _szUnpacked) {
+			{
+				uint32 count = MIN<uint32>(stakptr, _szUnpacked - _dwWrote);
+				while (count--)
+					putByte(stak[--stakptr]);
+				if (_dwWrote == _szUnpacked)
 					bExit = true;
-					continue;
-				}
 			}
 			// put token into record
 			if (_curtoken <= _endtoken) {
@@ -621,7 +674,7 @@ void DecompressorLZW::reorderView(byte *src, byte *dest) {
 // DCL decompressor for SCI1.1
 //----------------------------------------------
 
-int DecompressorDCL::unpack(Common::ReadStream *src, byte *dest, uint32 nPacked,
+int DecompressorDCL::unpack(Common::SeekableReadStream *src, byte *dest, uint32 nPacked,
                             uint32 nUnpacked) {
 	return Common::decompressDCL(src, dest, nPacked, nUnpacked) ? 0 : SCI_ERROR_DECOMPRESSION_ERROR;
 }
@@ -632,7 +685,7 @@ int DecompressorDCL::unpack(Common::ReadStream *src, byte *dest, uint32 nPacked,
 // STACpack/LZS decompressor for SCI32
 // Based on Andre Beck's code from http://micky.ibh.de/~beck/stuff/lzs4i4l/
 //----------------------------------------------
-int DecompressorLZS::unpack(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked) {
+int DecompressorLZS::unpack(Common::SeekableReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked) {
 	init(src, dest, nPacked, nUnpacked);
 	return unpackLZS();
 }
@@ -647,6 +700,10 @@ int DecompressorLZS::unpackLZS() {
 				offs = getBitsMSB(7);
 				if (!offs) // This is the end marker - a 7 bit offset of zero
 					break;
+				if (offs > _dwWrote) {
+					warning("lzsDecomp: offset out of bounds");
+					return SCI_ERROR_DECOMPRESSION_ERROR;
+				}
 				if (!(clen = getCompLen())) {
 					warning("lzsDecomp: length mismatch");
 					return SCI_ERROR_DECOMPRESSION_ERROR;
@@ -654,6 +711,10 @@ int DecompressorLZS::unpackLZS() {
 				copyComp(offs, clen);
 			} else { // Eleven bit offset follows
 				offs = getBitsMSB(11);
+				if (offs > _dwWrote) {
+					warning("lzsDecomp: offset out of bounds");
+					return SCI_ERROR_DECOMPRESSION_ERROR;
+				}
 				if (!(clen = getCompLen())) {
 					warning("lzsDecomp: length mismatch");
 					return SCI_ERROR_DECOMPRESSION_ERROR;
@@ -698,10 +759,7 @@ uint32 DecompressorLZS::getCompLen() {
 }
 
 void DecompressorLZS::copyComp(int offs, uint32 clen) {
-	int hpos = _dwWrote - offs;
-
-	while (clen--)
-		putByte(_dest[hpos++]);
+	copyUnpacked(_dwWrote - offs, MIN<uint32>(clen, _szUnpacked - _dwWrote));
 }
 
 #endif	// #ifdef ENABLE_SCI32
@@ -27,6 +27,7 @@
 
 namespace Common {
 class ReadStream;
+class SeekableReadStream;
 }
 
 namespace Sci {
@@ -51,22 +52,26 @@ enum ResourceCompression {
  */
 class Decompressor {
 public:
-	Decompressor() {}
-	virtual ~Decompressor() {}
+	Decompressor() : _packed(0) {}
+	virtual ~Decompressor() { delete[] _packed; }
 
 
-	virtual int unpack(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
+	virtual int unpack(Common::SeekableReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
 
 protected:
 	/**
 	 * Initialize decompressor.
+	 * The bit readers work on the packed data as a whole in memory, so that
+	 * they don't have to go through the stream for every byte. The data is
+	 * used in place if the stream offers a view of it, or else read into a
+	 * buffer.
 	 * @param src		source stream to read from
 	 * @param dest		destination stream to write to
 	 * @param nPacked	size of packed data
 	 * @param nUnpacket	size of unpacked data
 	 * @return 0 on success, non-zero on error
 	 */
-	virtual void init(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
+	virtual void init(Common::SeekableReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
 
 	/**
 	 * Get a number of bits from _src stream, starting with the most
@@ -91,6 +96,13 @@ protected:
 	byte getByteMSB();
 	byte getByteLSB();
 
+	/**
+	 * Get one byte from the packed data, bypassing the bits buffer.
+	 * Only valid before any bits have been read.
+	 * @return byte
+	 */
+	byte getByte();
+
 	void fetchBitsMSB();
 	void fetchBitsLSB();
 
@@ -98,8 +110,17 @@ protected:
 	 * Write one byte into _dest stream
 	 * @param b byte to put
 	 */
+	void putByte(byte b) {
+		_dest[_dwWrote++] = b;
+	}
 
-	virtual void putByte(byte b);
+	/**
+	 * Append a copy of already unpacked data to _dest. The data may overlap
+	 * the bytes being written, in which case it is repeated.
+	 * @param pos		position of the data to copy in _dest
+	 * @param length	number of bytes to copy
+	 */
+	void copyUnpacked(uint32 pos, uint32 length);
 
 	/**
 	 * Returns true if all expected data has been unpacked to _dest
@@ -117,6 +138,9 @@ protected:
 	uint32 _dwWrote;	///< number of bytes written to _dest
 	Common::ReadStream *_src;
 	byte *_dest;
+	byte *_packed;		///< packed data read from _src, unless it was used in place
+	const byte *_in;	///< next byte of packed data to read
+	const byte *_inEnd;	///< end of the packed data
 };
 
 /**
@@ -124,7 +148,7 @@ protected:
  */
 class DecompressorHuffman : public Decompressor {
 public:
-	int unpack(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
+	int unpack(Common::SeekableReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
 
 protected:
 	int16 getc2();
@@ -141,8 +165,8 @@ public:
 	DecompressorLZW(int nCompression) {
 		_compression = nCompression;
 	}
-	void init(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
-	int unpack(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
+	void init(Common::SeekableReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
+	int unpack(Common::SeekableReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
 
 protected:
 	enum {
@@ -152,8 +176,8 @@ protected:
 	};
 	// unpacking procedures
 	// TODO: unpackLZW and unpackLZW1 are similar and should be merged
-	int unpackLZW1(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
-	int unpackLZW(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
+	int unpackLZW1(Common::SeekableReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
+	int unpackLZW(Common::SeekableReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
 
 	// functions to post-process view and pic resources
 	void reorderPic(byte *src, byte *dest, int dsize);
@@ -177,7 +201,7 @@ protected:
  */
 class DecompressorDCL : public Decompressor {
 public:
-	int unpack(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
+	int unpack(Common::SeekableReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
 };
 
 #ifdef ENABLE_SCI32
@@ -186,7 +210,7 @@ public:
  */
 class DecompressorLZS : public Decompressor {
 public:
-	int unpack(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
+	int unpack(Common::SeekableReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
 protected:
 	int unpackLZS();
 	uint32 getCompLen();
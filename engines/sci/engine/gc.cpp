@@ -80,7 +80,7 @@ static AddrSet *normalizeAddresses(SegManager *segMan, const AddrSet &nonnormal_
 	return normal_map;
 }
 
-static void processWorkList(SegManager *segMan, WorklistManager &wm, const Common::Array<SegmentObj *> &heap) {
+static void processWorkList(SegManager *segMan, WorklistManager &wm, const Common::Array<SegmentObj *> &heap, uint budget = 0) {
 	SegmentId stackSegment = segMan->findSegmentByType(SEG_TYPE_STACK);
 	while (!wm._worklist.empty()) {
 		reg_t reg = wm._worklist.back();
@@ -88,18 +88,28 @@ static void processWorkList(SegManager *segMan, WorklistManager &wm, const Commo
 		if (reg.getSegment() != stackSegment) { // No need to repeat this one
 			debugC(kDebugLevelGC, "[GC] Checking %04x:%04x", PRINT_REG(reg));
 			if (reg.getSegment() < heap.size() && heap[reg.getSegment()]) {
+				SegmentObj *mobj = heap[reg.getSegment()];
+
+				// During an incremental collection, the worklist may still
+				// contain addresses that have been freed in the meantime
+				if (budget && !mobj->isValidOffset(reg.getOffset()))
+					continue;
+
 				// Valid heap object? Find its outgoing references!
-				wm.pushArray(heap[reg.getSegment()]->listAllOutgoingReferences(reg));
+				wm._scratch.resize(0);
+				mobj->listAllOutgoingReferences(reg, wm._scratch);
+				wm.pushArray(wm._scratch);
 			}
 		}
+
+		if (budget && !--budget)
+			break;
 	}
 }
 
-AddrSet *findAllActiveReferences(EngineState *s) {
+static void pushRootReferences(EngineState *s, WorklistManager &wm) {
 	assert(!s->_executionStack.empty());
 
-	WorklistManager wm;
-
 	// Initialize registers
 	wm.push(s->r_acc);
 	wm.push(s->r_prev);
@@ -151,8 +161,14 @@ AddrSet *findAllActiveReferences(EngineState *s) {
 	}
 
 	debugC(kDebugLevelGC, "[GC] -- Finished explicitly loaded scripts, done with root set");
+}
 
-	processWorkList(s->_segMan, wm, heap);
+AddrSet *findAllActiveReferences(EngineState *s) {
+	WorklistManager wm;
+
+	pushRootReferences(s, wm);
+
+	processWorkList(s->_segMan, wm, s->_segMan->getSegments());
 
 	if (g_sci->_gfxPorts)
 		g_sci->_gfxPorts->processEngineHunkList(wm);
@@ -160,11 +176,8 @@ AddrSet *findAllActiveReferences(EngineState *s) {
 	return normalizeAddresses(s->_segMan, wm._map);
 }
 
-void run_gc(EngineState *s) {
-	SegManager *segMan = s->_segMan;
-
+static void freeUnreachableObjects(SegManager *segMan, const AddrSet &activeRefs) {
 	// Some debug stuff
-	debugC(kDebugLevelGC, "[GC] Running...");
 #ifdef GC_DEBUG_CODE
 	const char *segnames[SEG_TYPE_MAX + 1];
 	int segcount[SEG_TYPE_MAX + 1];
@@ -172,9 +185,6 @@ void run_gc(EngineState *s) {
 	memset(segcount, 0, sizeof(segcount));
 #endif
 
-	// Compute the set of all segments references currently in use.
-	AddrSet *activeRefs = findAllActiveReferences(s);
-
 	// Iterate over all segments, and check for each whether it
 	// contains stuff that can be collected.
 	const Common::Array<SegmentObj *> &heap = segMan->getSegments();
@@ -192,7 +202,7 @@ void run_gc(EngineState *s) {
 			const Common::Array<reg_t> tmp = mobj->listAllDeallocatable(seg);
 			for (Common::Array<reg_t>::const_iterator it = tmp.begin(); it != tmp.end(); ++it) {
 				const reg_t addr = *it;
-				if (!activeRefs->contains(addr)) {
+				if (!activeRefs.contains(addr)) {
 					// Not found -> we can free it
 					mobj->freeAtAddress(segMan, addr);
 					debugC(kDebugLevelGC, "[GC] Deallocating %04x:%04x", PRINT_REG(addr));
@@ -205,8 +215,6 @@ void run_gc(EngineState *s) {
 		}
 	}
 
-	delete activeRefs;
-
 #ifdef GC_DEBUG_CODE
 	// Output debug summary of garbage collection
 	debugC(kDebugLevelGC, "[GC] Summary:");
@@ -216,4 +224,96 @@ void run_gc(EngineState *s) {
 #endif
 }
 
+void run_gc(EngineState *s) {
+	SegManager *segMan = s->_segMan;
+
+	// A full collection supersedes an incremental one
+	segMan->getGarbageCollector()->cancel();
+
+	debugC(kDebugLevelGC, "[GC] Running...");
+
+	// Compute the set of all segments references currently in use.
+	AddrSet *activeRefs = findAllActiveReferences(s);
+
+	freeUnreachableObjects(segMan, *activeRefs);
+
+	delete activeRefs;
+}
+
+GarbageCollector::GarbageCollector() : _marking(false) {
+}
+
+void GarbageCollector::start(EngineState *s) {
+	cancel();
+
+	debugC(kDebugLevelGC, "[GC] Starting incremental collection");
+
+	_marking = true;
+	pushRootReferences(s, _wm);
+}
+
+bool GarbageCollector::step(EngineState *s, uint budget) {
+	if (!_marking)
+		return true;
+
+	SegManager *segMan = s->_segMan;
+	processWorkList(segMan, _wm, segMan->getSegments(), budget);
+	if (!_wm._worklist.empty())
+		return false;
+
+	// All reachable objects have been marked. The registers, the stacks and
+	// the locked scripts have been changing without write barriers, so they
+	// are scanned again before anything is freed.
+	pushRootReferences(s, _wm);
+	processWorkList(segMan, _wm, segMan->getSegments());
+
+	if (g_sci->_gfxPorts)
+		g_sci->_gfxPorts->processEngineHunkList(_wm);
+
+	_marking = false;
+
+	debugC(kDebugLevelGC, "[GC] Finishing incremental collection");
+
+	AddrSet *activeRefs = normalizeAddresses(segMan, _wm._map);
+	_wm._map.clear();
+
+	freeUnreachableObjects(segMan, *activeRefs);
+
+	delete activeRefs;
+	return true;
+}
+
+void GarbageCollector::cancel() {
+	_marking = false;
+	_wm._worklist.resize(0);
+	_wm._map.clear();
+}
+
+void GarbageCollector::rescan(reg_t object) {
+	if (!_marking || !object.getSegment())
+		return;
+
+	_wm._map.setVal(object, true);
+	_wm._worklist.push_back(object);
+}
+
+void GarbageCollector::forget(reg_t addr) {
+	if (_marking)
+		_wm._map.erase(addr);
+}
+
+void GarbageCollector::forgetSegment(SegmentId seg) {
+	if (!_marking)
+		return;
+
+	Common::Array<reg_t> addrs;
+	for (AddrSet::const_iterator i = _wm._map.begin(); i != _wm._map.end(); ++i) {
+		if (i->_key.getSegment() == seg)
+			addrs.push_back(i->_key);
+	}
+
+	for (Common::Array<reg_t>::const_iterator it = addrs.begin(); it != addrs.end(); ++it)
+		_wm._map.erase(*it);
+}
+
 } // End of namespace Sci
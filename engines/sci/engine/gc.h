@@ -58,11 +58,68 @@ void run_gc(EngineState *s);
 struct WorklistManager {
 	Common::Array<reg_t> _worklist;
 	AddrSet _map;	// used for 2 contains() calls, inside push() and run_gc()
+	Common::Array<reg_t> _scratch;	// outgoing references of the object being processed
 
 	void push(reg_t reg);
 	void pushArray(const Common::Array<reg_t> &tmp);
 };
 
+/**
+ * Incremental garbage collector.
+ *
+ * Instead of marking the whole heap at once like run_gc(), the marking work
+ * is spread over several kernel calls, each of which only processes a limited
+ * number of references. While a collection is in progress, the VM keeps
+ * running; every reference it stores into a heap object has to be reported
+ * through writeBarrier(), and objects passed to kernel functions (which may
+ * modify them in arbitrary ways) through rescan(). Once the worklist is empty,
+ * the root set is scanned again and the collection is finished in one go.
+ */
+class GarbageCollector {
+public:
+	GarbageCollector();
+
+	/** Returns true while a collection is in progress. */
+	bool isMarking() const { return _marking; }
+
+	/**
+	 * Starts a new collection by adding the root set to the worklist.
+	 * @param s The state to collect garbage in
+	 */
+	void start(EngineState *s);
+
+	/**
+	 * Processes up to the given number of references. When no work is left,
+	 * the collection is finished and all unreachable objects are freed.
+	 * @param s			The state to collect garbage in
+	 * @param budget	Maximum number of references to process
+	 * @return true if the collection has been finished
+	 */
+	bool step(EngineState *s, uint budget);
+
+	/** Cancels the collection in progress, if any. */
+	void cancel();
+
+	/** Must be called whenever a reference is stored into a heap object. */
+	void writeBarrier(reg_t value) {
+		if (_marking && value.getSegment())
+			_wm.push(value);
+	}
+
+	/** Scans the given object again, even if it has already been marked. */
+	void rescan(reg_t object);
+
+	/** Drops a freed address from the set of marked addresses. */
+	void forget(reg_t addr);
+
+	/** Drops all addresses in a freed or reinitialized segment. */
+	void forgetSegment(SegmentId seg);
+
+private:
+	WorklistManager _wm;
+	bool _marking;
+};
+
 
 } // End of namespace Sci
 
@@ -34,6 +34,7 @@
 
 namespace Sci {
 
+class Console;
 struct Node;	// from segment.h
 struct List;	// from segment.h
 struct SelectorCache;	// from selector.h
@@ -259,6 +260,12 @@ private:
 	const Common::String _invalid;
 };
 
+/**
+ * Replays the most recent kAvoidPath calls and prints how long they take,
+ * with and without reusing the visibility graph between calls.
+ */
+void benchmarkAvoidPath(EngineState *s, Console *con, int iterations);
+
 /******************** Kernel functions ********************/
 
 reg_t kStrLen(EngineState *s, int argc, reg_t *argv);
@@ -26,6 +26,7 @@
 #include "sci/engine/state.h"
 #include "sci/engine/selector.h"
 #include "sci/engine/kernel.h"
+#include "sci/engine/gc.h"
 #include "sci/graphics/animate.h"
 #include "sci/graphics/screen.h"
 
@@ -352,8 +353,10 @@ reg_t kDoBresen(EngineState *s, int argc, reg_t *argv) {
 
 		if (collision) {
 			// We restore the backup of the client variables
-			for (uint i = 0; i < clientVarNum; ++i)
+			for (uint i = 0; i < clientVarNum; ++i) {
 				clientObject->getVariableRef(i) = clientBackup[i];
+				s->_segMan->getGarbageCollector()->writeBarrier(clientBackup[i]);
+			}
 
 			mover_i1 = mover_org_i1;
 			mover_i2 = mover_org_i2;
@@ -21,6 +21,7 @@
  */
 
 #include "sci/sci.h"
+#include "sci/console.h"
 #include "sci/engine/state.h"
 #include "sci/engine/selector.h"
 #include "sci/engine/kernel.h"
@@ -67,6 +68,13 @@ enum {
 	PF_FATAL = -2
 };
 
+// A* vertex states
+enum {
+	VERTEX_UNVISITED = 0,
+	VERTEX_OPEN = 1,
+	VERTEX_CLOSED = 2
+};
+
 // Floating point struct
 struct FloatPoint {
 	FloatPoint() : x(0), y(0) {}
@@ -91,25 +99,120 @@ struct Vertex {
 	uint32 costF;
 	uint32 costG;
 
+	// A* state, position in the open set and the order in which the vertex
+	// was added to the open set
+	int state;
+	uint heapIndex;
+	uint openOrder;
+
+	// Position in the vertex index of the pathfinding state
+	int index;
+
 	// Previous vertex in shortest path
 	Vertex *path_prev;
 
 public:
 	Vertex(const Common::Point &p) : v(p) {
 		costG = HUGE_DISTANCE;
+		state = VERTEX_UNVISITED;
+		heapIndex = 0;
+		openOrder = 0;
+		index = -1;
 		path_prev = NULL;
 	}
 };
 
-class VertexList: public Common::List<Vertex *> {
+typedef Common::Array<Vertex *> VertexArray;
+
+/**
+ * The open set of the A* search. This is a binary heap ordered by F cost,
+ * where ties are broken in favor of the vertex that was added last. That
+ * is the order in which the linear search over the open list that was used
+ * before picked the vertices, so the paths found are the same.
+ */
+class OpenSet {
 public:
-	bool contains(Vertex *v) {
-		for (iterator it = begin(); it != end(); ++it) {
-			if (v == *it)
-				return true;
+	OpenSet() : _counter(0) {}
+
+	bool empty() const {
+		return _heap.empty();
+	}
+
+	void push(Vertex *vertex) {
+		vertex->state = VERTEX_OPEN;
+		vertex->openOrder = _counter++;
+		vertex->heapIndex = _heap.size();
+		_heap.push_back(vertex);
+		siftUp(vertex->heapIndex);
+	}
+
+	/**
+	 * Removes the vertex with the lowest F cost from the open set.
+	 */
+	Vertex *pop() {
+		Vertex *vertex_min = _heap[0];
+		Vertex *last = _heap.back();
+		_heap.pop_back();
+
+		if (!_heap.empty()) {
+			_heap[0] = last;
+			last->heapIndex = 0;
+			siftDown(0);
 		}
-		return false;
+
+		return vertex_min;
 	}
+
+	/**
+	 * Restores the order of the heap after the F cost of a vertex in the
+	 * open set has been lowered.
+	 */
+	void update(Vertex *vertex) {
+		siftUp(vertex->heapIndex);
+	}
+
+private:
+	static bool before(const Vertex *a, const Vertex *b) {
+		return (a->costF < b->costF) || ((a->costF == b->costF) && (a->openOrder > b->openOrder));
+	}
+
+	void siftUp(uint pos) {
+		Vertex *vertex = _heap[pos];
+
+		while (pos > 0) {
+			uint parent = (pos - 1) / 2;
+			if (!before(vertex, _heap[parent]))
+				break;
+			_heap[pos] = _heap[parent];
+			_heap[pos]->heapIndex = pos;
+			pos = parent;
+		}
+
+		_heap[pos] = vertex;
+		vertex->heapIndex = pos;
+	}
+
+	void siftDown(uint pos) {
+		Vertex *vertex = _heap[pos];
+		const uint size = _heap.size();
+
+		while (2 * pos + 1 < size) {
+			uint child = 2 * pos + 1;
+			if ((child + 1 < size) && before(_heap[child + 1], _heap[child]))
+				child++;
+			if (!before(_heap[child], vertex))
+				break;
+			_heap[pos] = _heap[child];
+			_heap[pos]->heapIndex = pos;
+			pos = child;
+		}
+
+		_heap[pos] = vertex;
+		vertex->heapIndex = pos;
+	}
+
+	VertexArray _heap;
+	uint _counter;
 };
 
 /* Circular list definitions. */
@@ -228,6 +331,14 @@ struct PathfindingState {
 	// Total number of vertices
 	int vertices;
 
+	// Visibility graph shared with previous calls, or NULL if it can't be
+	// used for this polygon set
+	PathfindingCache *_cache;
+
+	// Number of vertices at the start of the vertex index which aren't part
+	// of the cached visibility graph (start and end point)
+	int _cacheFirst;
+
 	// Point to prepend and append to final path
 	Common::Point *_prependPoint;
 	Common::Point *_appendPoint;
@@ -242,6 +353,8 @@ struct PathfindingState {
 		_prependPoint = NULL;
 		_appendPoint = NULL;
 		vertices = 0;
+		_cache = NULL;
+		_cacheFirst = 0;
 	}
 
 	~PathfindingState() {
@@ -258,6 +371,7 @@ struct PathfindingState {
 	bool pointOnScreenBorder(const Common::Point &p);
 	bool edgeOnScreenBorder(const Common::Point &p, const Common::Point &q);
 	int findNearPoint(const Common::Point &p, Polygon *polygon, Common::Point *ret);
+	void visibleVertices(Vertex *vertex, VertexArray &visVerts);
 };
 
 static Common::Point readPoint(SegmentRef list_r, int offset) {
@@ -638,45 +752,91 @@ static int inside(const Common::Point &p, Vertex *vertex) {
 }
 
 /**
- * Returns a list of all vertices that are visible from a particular vertex.
+ * Determines whether or not a vertex is visible from another one. Note that
+ * this is symmetric.
  * @param s				the pathfinding state
- * @param vertex_cur	the vertex
- * @return list of vertices that are visible from vert
+ * @param vertex_cur	the vertex to look from
+ * @param vertex		the vertex to look at
+ * @return true if vertex can be seen from vertex_cur, false otherwise
  */
-static VertexList *visible_vertices(PathfindingState *s, Vertex *vertex_cur) {
-	VertexList *visVerts = new VertexList();
+static bool vertex_visible(PathfindingState *s, Vertex *vertex_cur, Vertex *vertex) {
+	// Make sure we don't intersect a polygon locally at the vertices
+	if ((vertex == vertex_cur) || (inside(vertex->v, vertex_cur)) || (inside(vertex_cur->v, vertex)))
+		return false;
+
+	// Check for intersecting edges
+	for (int j = 0; j < s->vertices; j++) {
+		Vertex *edge = s->vertex_index[j];
+		if (VERTEX_HAS_EDGES(edge)) {
+			if (between(vertex_cur->v, vertex->v, edge->v)) {
+				// If we hit a vertex, make sure we can pass through it without intersecting its polygon
+				if ((inside(vertex_cur->v, edge)) || (inside(vertex->v, edge)))
+					return false;
 
-	for (int i = 0; i < s->vertices; i++) {
+				// This edge won't properly intersect, so we continue
+				continue;
+			}
+
+			if (intersect_proper(vertex_cur->v, vertex->v, edge->v, CLIST_NEXT(edge)->v))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Adds the vertices of the vertex index from a given position onwards that
+ * are visible from a particular vertex to a list, in reverse index order.
+ * @param s				the pathfinding state
+ * @param vertex_cur	the vertex
+ * @param first			the first vertex index to consider
+ * @param visVerts		the list to add the visible vertices to
+ */
+static void visible_vertices(PathfindingState *s, Vertex *vertex_cur, int first, VertexArray &visVerts) {
+	for (int i = s->vertices - 1; i >= first; i--) {
 		Vertex *vertex = s->vertex_index[i];
 
-		// Make sure we don't intersect a polygon locally at the vertices
-		if ((vertex == vertex_cur) || (inside(vertex->v, vertex_cur)) || (inside(vertex_cur->v, vertex)))
-			continue;
+		if (vertex_visible(s, vertex_cur, vertex))
+			visVerts.push_back(vertex);
+	}
+}
 
-		// Check for intersecting edges
-		int j;
-		for (j = 0; j < s->vertices; j++) {
-			Vertex *edge = s->vertex_index[j];
-			if (VERTEX_HAS_EDGES(edge)) {
-				if (between(vertex_cur->v, vertex->v, edge->v)) {
-					// If we hit a vertex, make sure we can pass through it without intersecting its polygon
-					if ((inside(vertex_cur->v, edge)) || (inside(vertex->v, edge)))
-						break;
-
-					// This edge won't properly intersect, so we continue
-					continue;
-				}
+/**
+ * Returns all vertices that are visible from a particular vertex. The
+ * visibility between the vertices of the polygons is taken from the cache
+ * when possible, and added to it otherwise. Only the start and end point,
+ * which are at the start of the vertex index, are checked every time.
+ * @param vertex	the vertex
+ * @param visVerts	the list to add the visible vertices to
+ */
+void PathfindingState::visibleVertices(Vertex *vertex, VertexArray &visVerts) {
+	visVerts.resize(0);
 
-				if (intersect_proper(vertex_cur->v, vertex->v, edge->v, CLIST_NEXT(edge)->v))
-					break;
-			}
-		}
+	if (!_cache || vertex->index < _cacheFirst) {
+		visible_vertices(this, vertex, 0, visVerts);
+		return;
+	}
 
-		if (j == s->vertices)
-			visVerts->push_front(vertex);
+	const uint entry = vertex->index - _cacheFirst;
+	Common::Array<uint16> &visible = _cache->visible[entry];
+
+	if (!_cache->computed[entry]) {
+		visible_vertices(this, vertex, _cacheFirst, visVerts);
+
+		visible.resize(visVerts.size());
+		for (uint i = 0; i < visVerts.size(); i++)
+			visible[i] = visVerts[i]->index - _cacheFirst;
+		_cache->computed[entry] = true;
+	} else {
+		for (uint i = 0; i < visible.size(); i++)
+			visVerts.push_back(vertex_index[_cacheFirst + visible[i]]);
 	}
 
-	return visVerts;
+	for (int i = _cacheFirst - 1; i >= 0; i--) {
+		if (vertex_visible(this, vertex, vertex_index[i]))
+			visVerts.push_back(vertex_index[i]);
+	}
 }
 
 /**
@@ -1164,39 +1324,92 @@ static void change_polygons_opt_0(PathfindingState *s) {
 }
 
 /**
- * Converts the SCI input data for pathfinding
- * Parameters: (EngineState *) s: The game state
- *             (reg_t) poly_list: Polygon list
- *             (Common::Point) start: The start point
- *             (Common::Point) end: The end point
- *             (int) opt: Optimization level (0, 1 or 2)
- * Returns   : (PathfindingState *) On success a newly allocated pathfinding state,
- *                            NULL otherwise
+ * Stores the vertices of a polygon set in an array
+ * Parameters: (const PolygonList &) polygons: The polygons
+ *             (bool) withType: Whether to store the polygon types as well
+ *             (Common::Array<int16> &) data: The array to fill
  */
-static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Common::Point start, Common::Point end, int width, int height, int opt) {
-	SegManager *segMan = s->_segMan;
-	Polygon *polygon;
-	int count = 0;
-	PathfindingState *pf_s = new PathfindingState(width, height);
+static void save_polygons(const PolygonList &polygons, bool withType, Common::Array<int16> &data) {
+	data.resize(0);
 
-	// Convert all polygons
-	if (poly_list.getSegment()) {
-		List *list = s->_segMan->lookupList(poly_list);
-		Node *node = s->_segMan->lookupNode(list->first);
+	for (PolygonList::const_iterator it = polygons.begin(); it != polygons.end(); ++it) {
+		Vertex *vertex;
 
-		while (node) {
-			// The node value might be null, in which case there's no polygon to parse.
-			// Happens in LB2 floppy - refer to bug #3041232
-			polygon = !node->value.isNull() ? convert_polygon(s, node->value) : NULL;
+		if (withType)
+			data.push_back((*it)->type);
+		data.push_back((*it)->vertices.size());
 
-			if (polygon) {
-				pf_s->polygons.push_back(polygon);
-				count += readSelectorValue(segMan, node->value, SELECTOR(size));
-			}
+		CLIST_FOREACH(vertex, &(*it)->vertices) {
+			data.push_back(vertex->v.x);
+			data.push_back(vertex->v.y);
+		}
+	}
+}
 
-			node = s->_segMan->lookupNode(node->succ);
+/**
+ * Checks whether a polygon set equals one stored by save_polygons() without types
+ * Parameters: (const PolygonList &) polygons: The polygons
+ *             (const Common::Array<int16> &) data: The stored polygons
+ * Returns   : (bool) true if the vertices are the same, false otherwise
+ */
+static bool same_polygons(const PolygonList &polygons, const Common::Array<int16> &data) {
+	uint pos = 0;
+
+	for (PolygonList::const_iterator it = polygons.begin(); it != polygons.end(); ++it) {
+		Vertex *vertex;
+
+		if (pos >= data.size() || data[pos++] != (int16)(*it)->vertices.size())
+			return false;
+
+		CLIST_FOREACH(vertex, &(*it)->vertices) {
+			if (pos + 2 > data.size() || data[pos] != vertex->v.x || data[pos + 1] != vertex->v.y)
+				return false;
+			pos += 2;
+		}
+	}
+
+	return pos == data.size();
+}
+
+/**
+ * Recreates a polygon set stored by save_polygons() with types
+ * Parameters: (const Common::Array<int16> &) data: The stored polygons
+ *             (PolygonList &) polygons: The list to add the polygons to
+ */
+static void load_polygons(const Common::Array<int16> &data, PolygonList &polygons) {
+	uint pos = 0;
+
+	while (pos < data.size()) {
+		Polygon *polygon = new Polygon(data[pos++]);
+		int size = data[pos++];
+		Vertex *last = NULL;
+
+		for (int i = 0; i < size; i++, pos += 2) {
+			Vertex *vertex = new Vertex(Common::Point(data[pos], data[pos + 1]));
+
+			if (last)
+				CircularVertexList::insertAfter(last, vertex);
+			else
+				polygon->vertices.insertHead(vertex);
+			last = vertex;
 		}
+
+		polygons.push_back(polygon);
 	}
+}
+
+/**
+ * Prepares converted polygons for pathfinding
+ * Parameters: (EngineState *) s: The game state
+ *             (PathfindingState *) pf_s: The pathfinding state with the polygons
+ *             (Common::Point) start: The start point
+ *             (Common::Point) end: The end point
+ *             (int) opt: Optimization level (0, 1 or 2)
+ *             (PathfindingCache *) cache: The visibility graph to reuse, or NULL
+ * Returns   : (bool) true on success, false otherwise
+ */
+static bool prepare_polygon_set(EngineState *s, PathfindingState *pf_s, Common::Point start, Common::Point end, int opt, PathfindingCache *cache) {
+	Polygon *polygon;
 
 	if (opt == 0)
 		change_polygons_opt_0(pf_s);
@@ -1205,8 +1418,7 @@ static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Co
 
 	if (!new_start) {
 		warning("AvoidPath: Couldn't fixup start position for pathfinding");
-		delete pf_s;
-		return NULL;
+		return false;
 	}
 
 	Common::Point *new_end = fixup_end_point(pf_s, end);
@@ -1214,8 +1426,7 @@ static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Co
 	if (!new_end) {
 		warning("AvoidPath: Couldn't fixup end position for pathfinding");
 		delete new_start;
-		delete pf_s;
-		return NULL;
+		return false;
 	}
 
 	if (opt == 0) {
@@ -1237,8 +1448,7 @@ static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Co
 				warning("AvoidPath: error finding nearest intersection");
 				delete new_start;
 				delete new_end;
-				delete pf_s;
-				return NULL;
+				return false;
 			}
 
 			if (err == PF_OK)
@@ -1254,6 +1464,24 @@ static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Co
 		}
 	}
 
+	// Check whether the cached visibility graph belongs to the polygons
+	// before the start and end points are added. Only a new set of
+	// polygons is stored, for the next call.
+	Common::Array<int16> polygonData;
+	bool polygonsChanged = false;
+	uint polygonCount = pf_s->polygons.size();
+	int polygonVertices = 0;
+
+	if (cache) {
+		for (PolygonList::iterator it = pf_s->polygons.begin(); it != pf_s->polygons.end(); ++it)
+			polygonVertices += (*it)->vertices.size();
+
+		if (!same_polygons(pf_s->polygons, cache->polygons)) {
+			save_polygons(pf_s->polygons, false, polygonData);
+			polygonsChanged = true;
+		}
+	}
+
 	// Merge start and end points into polygon set
 	pf_s->vertex_start = merge_point(pf_s, *new_start);
 	pf_s->vertex_end = merge_point(pf_s, *new_end);
@@ -1262,7 +1490,12 @@ static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Co
 	delete new_end;
 
 	// Allocate and build vertex index
-	pf_s->vertex_index = (Vertex**)malloc(sizeof(Vertex *) * (count + 2));
+	int count = 0;
+
+	for (PolygonList::iterator it = pf_s->polygons.begin(); it != pf_s->polygons.end(); ++it)
+		count += (*it)->vertices.size();
+
+	pf_s->vertex_index = (Vertex**)malloc(sizeof(Vertex *) * count);
 
 	count = 0;
 
@@ -1271,12 +1504,98 @@ static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Co
 		Vertex *vertex;
 
 		CLIST_FOREACH(vertex, &polygon->vertices) {
+			vertex->index = count;
 			pf_s->vertex_index[count++] = vertex;
 		}
 	}
 
 	pf_s->vertices = count;
 
+	// The start and end points are added as single-vertex polygons at the
+	// front, unless they coincide with existing vertices. They don't change
+	// the visibility between the other vertices then, so the cache can be
+	// used. If they have split up an edge instead, it can't.
+	if (cache) {
+		int added = pf_s->polygons.size() - polygonCount;
+
+		if (count == polygonVertices + added) {
+			if (polygonsChanged) {
+				cache->polygons = polygonData;
+				cache->visible.clear();
+				cache->visible.resize(polygonVertices);
+				cache->computed.clear();
+				cache->computed.resize(polygonVertices);
+				for (int i = 0; i < polygonVertices; i++)
+					cache->computed[i] = false;
+			}
+
+			pf_s->_cache = cache;
+			pf_s->_cacheFirst = added;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Converts the SCI input data for pathfinding
+ * Parameters: (EngineState *) s: The game state
+ *             (reg_t) poly_list: Polygon list
+ *             (Common::Point) start: The start point
+ *             (Common::Point) end: The end point
+ *             (int) opt: Optimization level (0, 1 or 2)
+ * Returns   : (PathfindingState *) On success a newly allocated pathfinding state,
+ *                            NULL otherwise
+ */
+static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Common::Point start, Common::Point end, int width, int height, int opt) {
+	Polygon *polygon;
+	PathfindingState *pf_s = new PathfindingState(width, height);
+
+	// Convert all polygons
+	if (poly_list.getSegment()) {
+		List *list = s->_segMan->lookupList(poly_list);
+		Node *node = s->_segMan->lookupNode(list->first);
+
+		while (node) {
+			// The node value might be null, in which case there's no polygon to parse.
+			// Happens in LB2 floppy - refer to bug #3041232
+			polygon = !node->value.isNull() ? convert_polygon(s, node->value) : NULL;
+
+			if (polygon)
+				pf_s->polygons.push_back(polygon);
+
+			node = s->_segMan->lookupNode(node->succ);
+		}
+	}
+
+	PathfindingCache &cache = s->_pathfindingCache;
+
+	// Record the input for the avoidpath_bench console command
+	if (cache.recording) {
+		PathfindingCache::Input *input;
+
+		if (cache.recorded.size() < PathfindingCache::kMaxRecorded) {
+			cache.recorded.push_back(PathfindingCache::Input());
+			input = &cache.recorded.back();
+		} else {
+			// Overwrite the oldest call
+			input = &cache.recorded[cache.recordNext];
+			cache.recordNext = (cache.recordNext + 1) % PathfindingCache::kMaxRecorded;
+		}
+
+		save_polygons(pf_s->polygons, true, input->polygons);
+		input->start = start;
+		input->end = end;
+		input->width = width;
+		input->height = height;
+		input->opt = opt;
+	}
+
+	if (!prepare_polygon_set(s, pf_s, start, end, opt, &cache)) {
+		delete pf_s;
+		return NULL;
+	}
+
 	return pf_s;
 }
 
@@ -1288,53 +1607,35 @@ static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Co
  * Parameters: (PathfindingState *) s: The pathfinding state
  */
 static void AStar(PathfindingState *s) {
-	// Vertices of which the shortest path is known
-	VertexList closedSet;
-
-	// The remaining vertices
-	VertexList openSet;
+	// The vertices which still have to be looked at. Vertices of which the
+	// shortest path is known are marked as closed.
+	OpenSet openSet;
+	VertexArray visVerts;
 
-	openSet.push_front(s->vertex_start);
 	s->vertex_start->costG = 0;
 	s->vertex_start->costF = (uint32)sqrt((float)s->vertex_start->v.sqrDist(s->vertex_end->v));
+	openSet.push(s->vertex_start);
 
 	while (!openSet.empty()) {
 		// Find vertex in open set with lowest F cost
-		VertexList::iterator vertex_min_it = openSet.end();
-		Vertex *vertex_min = 0;
-		uint32 min = HUGE_DISTANCE;
-
-		for (VertexList::iterator it = openSet.begin(); it != openSet.end(); ++it) {
-			Vertex *vertex = *it;
-			if (vertex->costF < min) {
-				vertex_min_it = it;
-				vertex_min = *vertex_min_it;
-				min = vertex->costF;
-			}
-		}
-
-		assert(vertex_min != 0);	// the vertex cost should never be bigger than HUGE_DISTANCE
+		Vertex *vertex_min = openSet.pop();
 
 		// Check if we are done
 		if (vertex_min == s->vertex_end)
-			break;
+			return;
 
 		// Move vertex from set open to set closed
-		closedSet.push_front(vertex_min);
-		openSet.erase(vertex_min_it);
+		vertex_min->state = VERTEX_CLOSED;
 
-		VertexList *visVerts = visible_vertices(s, vertex_min);
+		s->visibleVertices(vertex_min, visVerts);
 
-		for (VertexList::iterator it = visVerts->begin(); it != visVerts->end(); ++it) {
+		for (VertexArray::iterator it = visVerts.begin(); it != visVerts.end(); ++it) {
 			uint32 new_dist;
 			Vertex *vertex = *it;
 
-			if (closedSet.contains(vertex))
+			if (vertex->state == VERTEX_CLOSED)
 				continue;
 
-			if (!openSet.contains(vertex))
-				openSet.push_front(vertex);
-
 			new_dist = vertex_min->costG + (uint32)sqrt((float)vertex_min->v.sqrDist(vertex->v));
 
 			// When travelling to a vertex on the screen edge, we
@@ -1352,13 +1653,15 @@ static void AStar(PathfindingState *s) {
 				vertex->costF = vertex->costG + (uint32)sqrt((float)vertex->v.sqrDist(s->vertex_end->v));
 				vertex->path_prev = vertex_min;
 			}
-		}
 
-		delete visVerts;
+			if (vertex->state == VERTEX_UNVISITED)
+				openSet.push(vertex);
+			else
+				openSet.update(vertex);
+		}
 	}
 
-	if (openSet.empty())
-		debugC(kDebugLevelAvoidPath, "AvoidPath: End point (%i, %i) is unreachable", s->vertex_end->v.x, s->vertex_end->v.y);
+	debugC(kDebugLevelAvoidPath, "AvoidPath: End point (%i, %i) is unreachable", s->vertex_end->v.x, s->vertex_end->v.y);
 }
 
 static reg_t allocateOutputArray(SegManager *segMan, int size) {
@@ -1548,6 +1851,42 @@ reg_t kAvoidPath(EngineState *s, int argc, reg_t *argv) {
 	}
 }
 
+void benchmarkAvoidPath(EngineState *s, Console *con, int iterations) {
+	const Common::Array<PathfindingCache::Input> &recorded = s->_pathfindingCache.recorded;
+
+	if (recorded.empty()) {
+		con->DebugPrintf("No pathfinding calls have been recorded yet, see \"avoidpath_bench record\"\n");
+		return;
+	}
+
+	con->DebugPrintf("Replaying %d recorded pathfinding calls %d times\n", recorded.size(), iterations);
+
+	// Use a separate cache, so that the one of the game isn't disturbed
+	PathfindingCache cache;
+
+	for (int pass = 0; pass < 2; pass++) {
+		uint32 startTime = g_system->getMillis();
+
+		for (int i = 0; i < iterations; i++) {
+			// Replay the calls in the order they were made
+			for (uint j = 0; j < recorded.size(); j++) {
+				const PathfindingCache::Input &input = recorded[(s->_pathfindingCache.recordNext + j) % recorded.size()];
+				PathfindingState *p = new PathfindingState(input.width, input.height);
+
+				load_polygons(input.polygons, p->polygons);
+				if (prepare_polygon_set(s, p, input.start, input.end, input.opt, pass ? &cache : NULL))
+					AStar(p);
+
+				delete p;
+			}
+		}
+
+		uint32 elapsed = g_system->getMillis() - startTime;
+		con->DebugPrintf("%s visibility cache: %d ms, %.3f ms per call\n", pass ? "With" : "Without",
+			elapsed, (double)elapsed / (iterations * recorded.size()));
+	}
+}
+
 static bool PointInRect(const Common::Point &point, int16 rectX1, int16 rectY1, int16 rectX2, int16 rectY2) {
 	int16 top = MIN<int16>(rectY1, rectY2);
 	int16 left = MIN<int16>(rectX1, rectX2);
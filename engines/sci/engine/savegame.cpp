@@ -242,6 +242,8 @@ void SegManager::saveLoadWithSerializer(Common::Serializer &s) {
 			}
 		}
 	}
+
+	_selectorLookupCache.invalidate();
 }
 
 
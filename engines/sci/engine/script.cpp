@@ -28,11 +28,12 @@
 #include "sci/engine/kernel.h"
 #include "sci/engine/script.h"
 
+#include "common/stack.h"
 #include "common/util.h"
 
 namespace Sci {
 
-Script::Script() : SegmentObj(SEG_TYPE_SCRIPT), _buf(NULL) {
+Script::Script() : SegmentObj(SEG_TYPE_SCRIPT), _buf(NULL), _codeMap(NULL) {
 	freeScript();
 }
 
@@ -63,6 +64,153 @@ void Script::freeScript() {
 	_lockers = 1;
 	_markedAsDeleted = false;
 	_objects.clear();
+
+	invalidateInstructions();
+}
+
+void Script::invalidateInstructions() {
+	_code.clear();
+	free(_codeMap);
+	_codeMap = NULL;
+	_codeStart = _codeEnd = 0;
+}
+
+int Script::findInstruction(uint32 offset) {
+	if (offset >= _scriptSize)
+		return -1;
+
+	if (!_codeMap) {
+		_codeMap = (int32 *)malloc(_scriptSize * sizeof(int32));
+		memset(_codeMap, 0xff, _scriptSize * sizeof(int32));
+	}
+
+	if (_codeMap[offset] < 0)
+		decodeInstructions(offset);
+
+	const int index = _codeMap[offset];
+	if (index < 0 || _code[index].offset != offset)
+		return -1;
+	return index;
+}
+
+/**
+ * Return the length of the instruction at the given offset, or 0 if it can't
+ * be decoded: readPMachineInstruction() errors out on invalid opcodes, which
+ * a branch that is never taken may well point to.
+ */
+uint Script::getDecodableSize(uint32 offset) const {
+	const byte extOpcode = _buf[offset];
+	const byte opcode = extOpcode >> 1;
+	uint size = 1;
+
+	for (int i = 0; i < 4 && g_sci->_opcode_formats[opcode][i]; ++i) {
+		switch (g_sci->_opcode_formats[opcode][i]) {
+		case Script_Byte:
+		case Script_SByte:
+			size++;
+			break;
+		case Script_Word:
+		case Script_SWord:
+			size += 2;
+			break;
+		case Script_Variable:
+		case Script_Property:
+		case Script_Local:
+		case Script_Temp:
+		case Script_Global:
+		case Script_Param:
+		case Script_Offset:
+		case Script_SVariable:
+		case Script_SRelative:
+			size += (extOpcode & 1) ? 1 : 2;
+			break;
+		case Script_End:
+			break;
+		default:
+			return 0;
+		}
+	}
+
+	if (offset + size > _scriptSize)
+		return 0;
+
+	// op_file is followed by a file name, see readPMachineInstruction()
+	if (opcode == op_pushSelf && (extOpcode & 1) && g_sci->getGameId() != GID_FANMADE) {
+		do {
+			if (offset + size >= _scriptSize)
+				return 0;
+		} while (_buf[offset + size++]);
+	}
+
+	// Don't decode instructions that overlap ones decoded before
+	for (uint i = 0; i < size; i++) {
+		if (_codeMap[offset + i] >= 0)
+			return 0;
+	}
+
+	return size;
+}
+
+void Script::decodeInstructions(uint32 entry) {
+	const uint first = _code.size();
+	Common::Stack<uint32> pending;
+	pending.push(entry);
+
+	while (!pending.empty()) {
+		uint32 offset = pending.pop();
+
+		while (offset < _scriptSize && _codeMap[offset] < 0) {
+			const uint size = getDecodableSize(offset);
+			if (!size)
+				break;
+
+			PMachineInstruction instruction;
+			readPMachineInstruction(_buf + offset, instruction.extOpcode, instruction.opparams);
+			instruction.offset = offset;
+			instruction.size = size;
+			instruction.next = instruction.branch = -1;
+
+			for (uint i = 0; i < size; i++)
+				_codeMap[offset + i] = _code.size();
+			_code.push_back(instruction);
+
+			if (_codeStart == _codeEnd) {
+				_codeStart = offset;
+				_codeEnd = offset + size;
+			} else {
+				_codeStart = MIN(_codeStart, offset);
+				_codeEnd = MAX(_codeEnd, offset + size);
+			}
+
+			const byte opcode = instruction.extOpcode >> 1;
+			if (opcode == op_bt || opcode == op_bnt || opcode == op_jmp) {
+				const int32 target = (int32)(offset + size) + instruction.opparams[0];
+				if (target >= 0 && target < (int32)_scriptSize)
+					pending.push(target);
+			}
+
+			// Calls return to the following instruction, so only jumps and
+			// returns end a run of code
+			if (opcode == op_jmp || opcode == op_ret)
+				break;
+			offset += size;
+		}
+	}
+
+	// Resolve the instructions that may run after the new ones to indices
+	for (uint i = first; i < _code.size(); i++) {
+		PMachineInstruction &instruction = _code[i];
+		const uint32 next = instruction.offset + instruction.size;
+		if (next < _scriptSize && _codeMap[next] >= 0 && _code[_codeMap[next]].offset == next)
+			instruction.next = _codeMap[next];
+
+		const byte opcode = instruction.extOpcode >> 1;
+		if (opcode == op_bt || opcode == op_bnt || opcode == op_jmp) {
+			const int32 target = (int32)next + instruction.opparams[0];
+			if (target >= 0 && target < (int32)_scriptSize && _codeMap[target] >= 0 && _code[_codeMap[target]].offset == (uint32)target)
+				instruction.branch = _codeMap[target];
+		}
+	}
 }
 
 void Script::load(int script_nr, ResourceManager *resMan) {
@@ -463,6 +611,7 @@ void Script::mcpyInOut(int dst, const void *src, size_t n) {
 	if (_buf) {
 		assert(dst + n <= _bufSize);
 		memcpy(_buf + dst, src, n);
+		invalidateInstructions();
 	}
 }
 
@@ -728,17 +877,16 @@ Common::Array<reg_t> Script::listAllDeallocatable(SegmentId segId) const {
 	return Common::Array<reg_t>(&r, 1);
 }
 
-Common::Array<reg_t> Script::listAllOutgoingReferences(reg_t addr) const {
-	Common::Array<reg_t> tmp;
+void Script::listAllOutgoingReferences(reg_t addr, Common::Array<reg_t> &refs) const {
 	if (addr.getOffset() <= _bufSize && addr.getOffset() >= (uint)-SCRIPT_OBJECT_MAGIC_OFFSET && offsetIsObject(addr.getOffset())) {
 		const Object *obj = getObject(addr.getOffset());
 		if (obj) {
 			// Note all local variables, if we have a local variable environment
 			if (_localsSegment)
-				tmp.push_back(make_reg(_localsSegment, 0));
+				refs.push_back(make_reg(_localsSegment, 0));
 
 			for (uint i = 0; i < obj->getVarCount(); i++)
-				tmp.push_back(obj->getVariable(i));
+				refs.push_back(obj->getVariable(i));
 		} else {
 			error("Request for outgoing script-object reference at %04x:%04x failed", PRINT_REG(addr));
 		}
@@ -746,7 +894,6 @@ Common::Array<reg_t> Script::listAllOutgoingReferences(reg_t addr) const {
 		/*		warning("Unexpected request for outgoing script-object references at %04x:%04x", PRINT_REG(addr));*/
 		/* Happens e.g. when we're looking into strings */
 	}
-	return tmp;
 }
 
 Common::Array<reg_t> Script::listObjectReferences() const {
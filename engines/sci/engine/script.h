@@ -74,6 +74,11 @@ private:
 
 	ObjMap _objects;	/**< Table for objects, contains property variables */
 
+	Common::Array<PMachineInstruction> _code;	/**< Instructions decoded so far, in the order they were decoded */
+	int32 *_codeMap;	/**< Index in _code of the instruction covering each byte of the script, or -1 */
+	uint32 _codeStart;	/**< Offset of the first byte covered by a decoded instruction */
+	uint32 _codeEnd;	/**< Offset just past the last byte covered by a decoded instruction */
+
 public:
 	int getLocalsOffset() const { return _localsOffset; }
 	uint16 getLocalsCount() const { return _localsCount; }
@@ -91,6 +96,54 @@ public:
 	const ObjMap &getObjectMap() const { return _objects; }
 	bool offsetIsObject(uint16 offset) const;
 
+	/**
+	 * Return the index of the decoded instruction starting at the given
+	 * offset, or -1 if no valid instruction starts there. The first time an
+	 * offset is looked up, all code reachable from it through branches is
+	 * decoded, up to the returns and calls that leave it.
+	 */
+	int findInstruction(uint32 offset);
+
+	/**
+	 * Return the decoded instruction starting at the given offset, or NULL
+	 * if no valid instruction starts there. nextIndex and branchIndex are the
+	 * indices of the instructions run_vm() may execute next, as returned by
+	 * the previous call; they are checked before any lookup, and are then set
+	 * for the returned instruction.
+	 */
+	const PMachineInstruction *fetchInstruction(uint32 offset, int &nextIndex, int &branchIndex) {
+		int index = nextIndex;
+		if (!isInstructionAt(index, offset))
+			index = isInstructionAt(branchIndex, offset) ? branchIndex : findInstruction(offset);
+		if (index < 0)
+			return NULL;
+
+		const PMachineInstruction &instruction = _code[index];
+		nextIndex = instruction.next;
+		branchIndex = instruction.branch;
+		return &instruction;
+	}
+
+	/**
+	 * Check whether the given offset lies in the part of the script that
+	 * instructions have been decoded from.
+	 */
+	bool isDecodedCode(uint32 offset) const { return offset >= _codeStart && offset < _codeEnd; }
+
+	/**
+	 * Forget all decoded instructions. Must be called whenever the code of
+	 * the script may have been written to.
+	 */
+	void invalidateInstructions();
+
+private:
+	bool isInstructionAt(int index, uint32 offset) const {
+		return index >= 0 && index < (int)_code.size() && _code[index].offset == offset;
+	}
+
+	uint getDecodableSize(uint32 offset) const;
+	void decodeInstructions(uint32 entry);
+
 public:
 	Script();
 	~Script();
@@ -107,7 +160,7 @@ public:
 	virtual reg_t findCanonicAddress(SegManager *segMan, reg_t sub_addr) const;
 	virtual void freeAtAddress(SegManager *segMan, reg_t sub_addr);
 	virtual Common::Array<reg_t> listAllDeallocatable(SegmentId segId) const;
-	virtual Common::Array<reg_t> listAllOutgoingReferences(reg_t object) const;
+	virtual void listAllOutgoingReferences(reg_t object, Common::Array<reg_t> &refs) const;
 
 	/**
 	 * Return a list of all references to objects in this script
@@ -24,12 +24,16 @@
 #include "sci/engine/seg_manager.h"
 #include "sci/engine/state.h"
 #include "sci/engine/script.h"
+#include "sci/engine/gc.h"
 
 namespace Sci {
 
 
 SegManager::SegManager(ResourceManager *resMan) {
+	_gc = new GarbageCollector();
+
 	_heap.push_back(0);
+	_scriptSegMap.setStatsName("sci.scriptSegments");
 
 	_clonesSegId = 0;
 	_listsSegId = 0;
@@ -48,9 +52,12 @@ SegManager::SegManager(ResourceManager *resMan) {
 
 SegManager::~SegManager() {
 	resetSegMan();
+	delete _gc;
 }
 
 void SegManager::resetSegMan() {
+	_gc->cancel();
+
 	// Free memory
 	for (uint i = 0; i < _heap.size(); i++) {
 		if (_heap[i])
@@ -166,6 +173,11 @@ void SegManager::deallocate(SegmentId seg) {
 		}
 	}
 
+	if (mobj->getType() == SEG_TYPE_SCRIPT)
+		_selectorLookupCache.invalidate();
+
+	_gc->forgetSegment(seg);
+
 	delete mobj;
 	_heap[seg] = NULL;
 }
@@ -368,6 +380,7 @@ void SegManager::freeHunkEntry(reg_t addr) {
 	}
 
 	ht->freeEntryContents(addr.getOffset());
+	_gc->forget(addr);
 }
 
 reg_t SegManager::allocateHunkEntry(const char *hunk_type, int size) {
@@ -873,6 +886,7 @@ void SegManager::freeArray(reg_t addr) {
 
 	arrayTable->_table[addr.getOffset()].destroy();
 	arrayTable->freeEntry(addr.getOffset());
+	_gc->forget(addr);
 }
 
 SciString *SegManager::allocateString(reg_t *addr) {
@@ -913,6 +927,7 @@ void SegManager::freeString(reg_t addr) {
 
 	stringTable->_table[addr.getOffset()].destroy();
 	stringTable->freeEntry(addr.getOffset());
+	_gc->forget(addr);
 }
 
 #endif
@@ -978,6 +993,8 @@ int SegManager::instantiateScript(int scriptNum) {
 	scr->initializeLocals(this);
 	scr->initializeClasses(this);
 	scr->initializeObjects(this, segmentId);
+	_selectorLookupCache.invalidate();
+	_gc->forgetSegment(segmentId);
 
 	return segmentId;
 }
@@ -42,6 +42,7 @@ enum ScriptLoadType {
 };
 
 class Script;
+class GarbageCollector;
 
 class SegManager : public Common::Serializable {
 	friend class Console;
@@ -441,6 +442,10 @@ public:
 
 	const Common::Array<SegmentObj *> &getSegments() const { return _heap; }
 
+	SelectorLookupCache &getSelectorLookupCache() { return _selectorLookupCache; }
+
+	GarbageCollector *getGarbageCollector() { return _gc; }
+
 private:
 	Common::Array<SegmentObj *> _heap;
 	Common::Array<Class> _classTable; /**< Table of all classes */
@@ -458,6 +463,9 @@ private:
 	reg_t _saveDirPtr;
 	reg_t _parserPtr;
 
+	SelectorLookupCache _selectorLookupCache;
+	GarbageCollector *_gc; ///< State of the incremental garbage collector
+
 #ifdef ENABLE_SCI32
 	SegmentId _arraysSegId;
 	SegmentId _stringSegId;
@@ -89,8 +89,7 @@ SegmentRef SegmentObj::dereference(reg_t pointer) {
 
 //-------------------- clones --------------------
 
-Common::Array<reg_t> CloneTable::listAllOutgoingReferences(reg_t addr) const {
-	Common::Array<reg_t> tmp;
+void CloneTable::listAllOutgoingReferences(reg_t addr, Common::Array<reg_t> &refs) const {
 //	assert(addr.segment == _segId);
 
 	if (!isValidEntry(addr.getOffset())) {
@@ -101,13 +100,11 @@ Common::Array<reg_t> CloneTable::listAllOutgoingReferences(reg_t addr) const {
 
 	// Emit all member variables (including references to the 'super' delegate)
 	for (uint i = 0; i < clone->getVarCount(); i++)
-		tmp.push_back(clone->getVariable(i));
+		refs.push_back(clone->getVariable(i));
 
 	// Note that this also includes the 'base' object, which is part of the script and therefore also emits the locals.
-	tmp.push_back(clone->getPos());
+	refs.push_back(clone->getPos());
 	//debugC(kDebugLevelGC, "[GC] Reporting clone-pos %04x:%04x", PRINT_REG(clone->pos));
-
-	return tmp;
 }
 
 void CloneTable::freeAtAddress(SegManager *segMan, reg_t addr) {
@@ -167,12 +164,9 @@ reg_t LocalVariables::findCanonicAddress(SegManager *segMan, reg_t addr) const {
 	return make_reg(owner_seg, 0);
 }
 
-Common::Array<reg_t> LocalVariables::listAllOutgoingReferences(reg_t addr) const {
-	Common::Array<reg_t> tmp;
+void LocalVariables::listAllOutgoingReferences(reg_t addr, Common::Array<reg_t> &refs) const {
 	for (uint i = 0; i < _locals.size(); i++)
-		tmp.push_back(_locals[i]);
-
-	return tmp;
+		refs.push_back(_locals[i]);
 }
 
 
@@ -192,36 +186,29 @@ SegmentRef DataStack::dereference(reg_t pointer) {
 	return ret;
 }
 
-Common::Array<reg_t> DataStack::listAllOutgoingReferences(reg_t object) const {
-	Common::Array<reg_t> tmp;
+void DataStack::listAllOutgoingReferences(reg_t object, Common::Array<reg_t> &refs) const {
 	for (int i = 0; i < _capacity; i++)
-		tmp.push_back(_entries[i]);
-
-	return tmp;
+		refs.push_back(_entries[i]);
 }
 
 //-------------------- lists --------------------
 
-Common::Array<reg_t> ListTable::listAllOutgoingReferences(reg_t addr) const {
-	Common::Array<reg_t> tmp;
+void ListTable::listAllOutgoingReferences(reg_t addr, Common::Array<reg_t> &refs) const {
 	if (!isValidEntry(addr.getOffset())) {
 		error("Invalid list referenced for outgoing references: %04x:%04x", PRINT_REG(addr));
 	}
 
 	const List *list = &(_table[addr.getOffset()]);
 
-	tmp.push_back(list->first);
-	tmp.push_back(list->last);
+	refs.push_back(list->first);
+	refs.push_back(list->last);
 	// We could probably get away with just one of them, but
 	// let's be conservative here.
-
-	return tmp;
 }
 
 //-------------------- nodes --------------------
 
-Common::Array<reg_t> NodeTable::listAllOutgoingReferences(reg_t addr) const {
-	Common::Array<reg_t> tmp;
+void NodeTable::listAllOutgoingReferences(reg_t addr, Common::Array<reg_t> &refs) const {
 	if (!isValidEntry(addr.getOffset())) {
 		error("Invalid node referenced for outgoing references: %04x:%04x", PRINT_REG(addr));
 	}
@@ -229,12 +216,10 @@ Common::Array<reg_t> NodeTable::listAllOutgoingReferences(reg_t addr) const {
 
 	// We need all four here. Can't just stick with 'pred' OR 'succ' because node operations allow us
 	// to walk around from any given node
-	tmp.push_back(node->pred);
-	tmp.push_back(node->succ);
-	tmp.push_back(node->key);
-	tmp.push_back(node->value);
-
-	return tmp;
+	refs.push_back(node->pred);
+	refs.push_back(node->succ);
+	refs.push_back(node->key);
+	refs.push_back(node->value);
 }
 
 //-------------------- dynamic memory --------------------
@@ -262,8 +247,7 @@ void ArrayTable::freeAtAddress(SegManager *segMan, reg_t sub_addr) {
 	freeEntry(sub_addr.getOffset());
 }
 
-Common::Array<reg_t> ArrayTable::listAllOutgoingReferences(reg_t addr) const {
-	Common::Array<reg_t> tmp;
+void ArrayTable::listAllOutgoingReferences(reg_t addr, Common::Array<reg_t> &refs) const {
 	if (!isValidEntry(addr.getOffset())) {
 		error("Invalid array referenced for outgoing references: %04x:%04x", PRINT_REG(addr));
 	}
@@ -273,10 +257,8 @@ Common::Array<reg_t> ArrayTable::listAllOutgoingReferences(reg_t addr) const {
 	for (uint32 i = 0; i < array->getSize(); i++) {
 		reg_t value = array->getValue(i);
 		if (value.getSegment() != 0)
-			tmp.push_back(value);
+			refs.push_back(value);
 	}
-
-	return tmp;
 }
 
 Common::String SciString::toString() const {
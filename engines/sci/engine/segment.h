@@ -132,12 +132,13 @@ public:
 	 * Iterates over all references reachable from the specified object.
 	 * Used by the garbage collector.
 	 * @param  object	object (within the current segment) to analyze
-	 * @return a list of outgoing references within the object
+	 * @param  refs		array the outgoing references within the object are
+	 *					appended to; existing entries are kept, so that the
+	 *					garbage collector can reuse the same array for all objects
 	 *
 	 * @note This function may also choose to report numbers (segment 0) as adresses
 	 */
-	virtual Common::Array<reg_t> listAllOutgoingReferences(reg_t object) const {
-		return Common::Array<reg_t>();
+	virtual void listAllOutgoingReferences(reg_t object, Common::Array<reg_t> &refs) const {
 	}
 };
 
@@ -153,7 +154,7 @@ public:
 	}
 	virtual SegmentRef dereference(reg_t pointer);
 	virtual reg_t findCanonicAddress(SegManager *segMan, reg_t sub_addr) const;
-	virtual Common::Array<reg_t> listAllOutgoingReferences(reg_t object) const;
+	virtual void listAllOutgoingReferences(reg_t object, Common::Array<reg_t> &refs) const;
 
 	virtual void saveLoadWithSerializer(Common::Serializer &ser);
 };
@@ -177,7 +178,7 @@ public:
 	virtual reg_t findCanonicAddress(SegManager *segMan, reg_t addr) const {
 		return make_reg(addr.getSegment(), 0);
 	}
-	virtual Common::Array<reg_t> listAllOutgoingReferences(reg_t object) const;
+	virtual void listAllOutgoingReferences(reg_t object, Common::Array<reg_t> &refs) const;
 
 	virtual void saveLoadWithSerializer(Common::Serializer &ser);
 };
@@ -280,7 +281,7 @@ struct CloneTable : public SegmentObjTable<Clone> {
 	CloneTable() : SegmentObjTable<Clone>(SEG_TYPE_CLONES) {}
 
 	virtual void freeAtAddress(SegManager *segMan, reg_t sub_addr);
-	virtual Common::Array<reg_t> listAllOutgoingReferences(reg_t object) const;
+	virtual void listAllOutgoingReferences(reg_t object, Common::Array<reg_t> &refs) const;
 
 	virtual void saveLoadWithSerializer(Common::Serializer &ser);
 };
@@ -293,7 +294,7 @@ struct NodeTable : public SegmentObjTable<Node> {
 	virtual void freeAtAddress(SegManager *segMan, reg_t sub_addr) {
 		freeEntry(sub_addr.getOffset());
 	}
-	virtual Common::Array<reg_t> listAllOutgoingReferences(reg_t object) const;
+	virtual void listAllOutgoingReferences(reg_t object, Common::Array<reg_t> &refs) const;
 
 	virtual void saveLoadWithSerializer(Common::Serializer &ser);
 };
@@ -306,7 +307,7 @@ struct ListTable : public SegmentObjTable<List> {
 	virtual void freeAtAddress(SegManager *segMan, reg_t sub_addr) {
 		freeEntry(sub_addr.getOffset());
 	}
-	virtual Common::Array<reg_t> listAllOutgoingReferences(reg_t object) const;
+	virtual void listAllOutgoingReferences(reg_t object, Common::Array<reg_t> &refs) const;
 
 	virtual void saveLoadWithSerializer(Common::Serializer &ser);
 };
@@ -492,7 +493,7 @@ struct ArrayTable : public SegmentObjTable<SciArray<reg_t> > {
 	ArrayTable() : SegmentObjTable<SciArray<reg_t> >(SEG_TYPE_ARRAY) {}
 
 	virtual void freeAtAddress(SegManager *segMan, reg_t sub_addr);
-	virtual Common::Array<reg_t> listAllOutgoingReferences(reg_t object) const;
+	virtual void listAllOutgoingReferences(reg_t object, Common::Array<reg_t> &refs) const;
 
 	void saveLoadWithSerializer(Common::Serializer &ser);
 	SegmentRef dereference(reg_t pointer);
@@ -24,6 +24,7 @@
 #include "sci/engine/kernel.h"
 #include "sci/engine/state.h"
 #include "sci/engine/selector.h"
+#include "sci/engine/gc.h"
 
 namespace Sci {
 
@@ -211,8 +212,10 @@ void writeSelector(SegManager *segMan, reg_t object, Selector selectorId, reg_t
 	if (lookupSelector(segMan, object, selectorId, &address, NULL) != kSelectorVariable)
 		error("Selector '%s' of object at %04x:%04x could not be"
 		         " written to", g_sci->getKernel()->getSelectorName(selectorId).c_str(), PRINT_REG(object));
-	else
+	else {
 		*address.getPointer(segMan) = value;
+		segMan->getGarbageCollector()->writeBarrier(value);
+	}
 }
 
 void invokeSelector(EngineState *s, reg_t object, int selectorId,
@@ -250,9 +253,33 @@ void invokeSelector(EngineState *s, reg_t object, int selectorId,
 	run_vm(s); // Start a new vm
 }
 
+static void lookupSelectorUncached(SegManager *segMan, const Object *obj, Selector selectorId, SelectorLookupCache::Entry &entry) {
+	int index = obj->locateVarSelector(segMan, selectorId);
+
+	if (index >= 0) {
+		// Found it as a variable
+		entry.type = kSelectorVariable;
+		entry.varIndex = index;
+		return;
+	}
+
+	// Check if it's a method, with recursive lookup in superclasses
+	while (obj) {
+		index = obj->funcSelectorPosition(selectorId);
+		if (index >= 0) {
+			entry.type = kSelectorMethod;
+			entry.function = obj->getFunction(index);
+			return;
+		}
+
+		obj = segMan->getObject(obj->getSuperClassSelector());
+	}
+
+	entry.type = kSelectorNone;
+}
+
 SelectorType lookupSelector(SegManager *segMan, reg_t obj_location, Selector selectorId, ObjVarRef *varp, reg_t *fptr) {
 	const Object *obj = segMan->getObject(obj_location);
-	int index;
 	bool oldScriptHeader = (getSciVersion() == SCI_VERSION_0_EARLY);
 
 	// Early SCI versions used the LSB in the selector ID as a read/write
@@ -265,34 +292,29 @@ SelectorType lookupSelector(SegManager *segMan, reg_t obj_location, Selector sel
 				PRINT_REG(obj_location));
 	}
 
-	index = obj->locateVarSelector(segMan, selectorId);
+	SelectorLookupCache &cache = segMan->getSelectorLookupCache();
+	const reg_t superClass = obj->getSuperClassSelector();
+	SelectorLookupCache::Entry &entry = cache.getEntry(obj->getPos(), selectorId);
 
-	if (index >= 0) {
-		// Found it as a variable
+	if (!cache.isValid(entry, obj->getPos(), superClass, selectorId)) {
+		entry.object = obj->getPos();
+		entry.superClass = superClass;
+		entry.selector = selectorId;
+		lookupSelectorUncached(segMan, obj, selectorId, entry);
+		cache.validate(entry);
+	}
+
+	if (entry.type == kSelectorVariable) {
 		if (varp) {
 			varp->obj = obj_location;
-			varp->varindex = index;
-		}
-		return kSelectorVariable;
-	} else {
-		// Check if it's a method, with recursive lookup in superclasses
-		while (obj) {
-			index = obj->funcSelectorPosition(selectorId);
-			if (index >= 0) {
-				if (fptr)
-					*fptr = obj->getFunction(index);
-
-				return kSelectorMethod;
-			} else {
-				obj = segMan->getObject(obj->getSuperClassSelector());
-			}
+			varp->varindex = entry.varIndex;
 		}
-
-		return kSelectorNone;
+	} else if (entry.type == kSelectorMethod) {
+		if (fptr)
+			*fptr = entry.function;
 	}
 
-
-//	return _lookupSelector_function(segMan, obj, selectorId, fptr);
+	return entry.type;
 }
 
 } // End of namespace Sci
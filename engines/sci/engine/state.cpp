@@ -119,8 +119,10 @@ void EngineState::reset(bool isRestoring) {
 
 	scriptStepCounter = 0;
 	scriptGCInterval = GC_INTERVAL;
+	incrementalGC = false;
 
 	_videoState.reset();
+	_pathfindingCache.reset();
 	_syncedAudioOptions = false;
 
 	_vmdPalStart = 0;
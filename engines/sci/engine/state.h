@@ -25,6 +25,7 @@
 
 #include "common/scummsys.h"
 #include "common/array.h"
+#include "common/rect.h"
 #include "common/serializer.h"
 #include "common/str-array.h"
 
@@ -95,6 +96,42 @@ struct VideoState {
 	}
 };
 
+/**
+ * Data kept by kAvoidPath between calls. The visibility graph of the last
+ * polygon set is reused as long as the polygons don't change, which is the
+ * common case of an actor being moved around in the same room.
+ */
+struct PathfindingCache {
+	enum {
+		kMaxRecorded = 32
+	};
+
+	/** The input of a kAvoidPath call, as used by the avoidpath_bench console command */
+	struct Input {
+		Common::Array<int16> polygons; ///< Type, vertex count and points of each polygon
+		Common::Point start, end;
+		int width, height;
+		int opt;
+	};
+
+	Common::Array<int16> polygons; ///< Vertex count and points of each polygon of the cached set
+	Common::Array<Common::Array<uint16> > visible; ///< Vertices visible from each vertex of the set
+	Common::Array<bool> computed; ///< Whether the corresponding entry of visible is valid
+	bool recording; ///< Whether calls are recorded, only while the benchmark asks for it
+	Common::Array<Input> recorded; ///< The input of the most recent calls, used as a ring buffer
+	uint recordNext; ///< Entry of recorded to overwrite next, once it is full
+
+	PathfindingCache() : recording(false), recordNext(0) {}
+
+	void reset() {
+		polygons.clear();
+		visible.clear();
+		computed.clear();
+		recorded.clear();
+		recordNext = 0;
+	}
+};
+
 struct EngineState : public Common::Serializable {
 public:
 	EngineState(SegManager *segMan);
@@ -168,6 +205,7 @@ public:
 
 	int scriptStepCounter; // Counts the number of steps executed
 	int scriptGCInterval; // Number of steps in between gcs
+	bool incrementalGC; // Spread the gc marking work over several kernel calls
 
 	uint16 currentRoomNumber() const;
 	void setRoomNumber(uint16 roomNumber);
@@ -196,6 +234,7 @@ public:
 	byte _memorySegment[kMemorySegmentMax];
 
 	VideoState _videoState;
+	PathfindingCache _pathfindingCache;
 	uint16 _vmdPalStart, _vmdPalEnd;
 	bool _syncedAudioOptions;
 
@@ -22,6 +22,7 @@
 
 #include "common/debug.h"
 #include "common/debug-channels.h"
+#include "common/system.h"
 
 #include "sci/sci.h"
 #include "sci/console.h"
@@ -187,6 +188,7 @@ static void write_var(EngineState *s, int type, int index, reg_t value) {
 				if (lookupSelector(s->_segMan, stopGroopPos, SELECTOR(client), &varp, NULL) == kSelectorVariable) {
 					reg_t *clientVar = varp.getPointer(s->_segMan);
 					*clientVar = value;
+					s->_segMan->getGarbageCollector()->writeBarrier(value);
 				}
 			}
 		}
@@ -200,6 +202,10 @@ static void write_var(EngineState *s, int type, int index, reg_t value) {
 
 		s->variables[type][index] = value;
 
+		// Globals and locals live in the heap, temps and parameters on the stack
+		if (type == VAR_GLOBAL || type == VAR_LOCAL)
+			s->_segMan->getGarbageCollector()->writeBarrier(value);
+
 		// If the game is trying to change its speech/subtitle settings, apply the ScummVM audio
 		// options first, if they haven't been applied yet
 		if (type == VAR_GLOBAL && index == 90 && !g_sci->getEngineState()->_syncedAudioOptions) {
@@ -250,6 +256,7 @@ static void _exec_varselectors(EngineState *s) {
 			// varselector access?
 			if (xs.argc) { // write?
 				*var = xs.variables_argp[1];
+				s->_segMan->getGarbageCollector()->writeBarrier(*var);
 
 			} else // No, read
 				s->r_acc = *var;
@@ -336,6 +343,21 @@ static void addKernelCallToExecStack(EngineState *s, int kernelCallNr, int argc,
 // from scriptdebug.cpp
 extern void logKernelCall(const KernelFunction *kernelCall, const KernelSubFunction *kernelSubCall, EngineState *s, int argc, reg_t *argv, reg_t result);
 
+/**
+ * Kernel functions only write to script buffers through the pointers passed
+ * to them, so forget the decoded instructions of the scripts these point into.
+ */
+static void invalidateWrittenCode(SegManager *segMan, int argc, const reg_t *argv) {
+	for (int i = 0; i < argc; i++) {
+		if (!argv[i].getSegment())
+			continue;
+
+		Script *scr = segMan->getScriptIfLoaded(argv[i].getSegment());
+		if (scr && scr->isDecodedCode(argv[i].getOffset()))
+			scr->invalidateInstructions();
+	}
+}
+
 static void callKernelFunc(EngineState *s, int kernelCallNr, int argc) {
 	Kernel *kernel = g_sci->getKernel();
 
@@ -374,6 +396,7 @@ static void callKernelFunc(EngineState *s, int kernelCallNr, int argc) {
 	if (!kernelCall.subFunctionCount) {
 		addKernelCallToExecStack(s, kernelCallNr, argc, argv);
 		s->r_acc = kernelCall.function(s, argc, argv);
+		invalidateWrittenCode(s->_segMan, argc, argv);
 
 		if (kernelCall.debugLogging)
 			logKernelCall(&kernelCall, NULL, s, argc, argv, s->r_acc);
@@ -429,6 +452,7 @@ static void callKernelFunc(EngineState *s, int kernelCallNr, int argc) {
 			error("[VM] k%s: subfunction ID %d requested, but not available", kernelCall.name, subId);
 		addKernelCallToExecStack(s, kernelCallNr, argc, argv);
 		s->r_acc = kernelSubCall.function(s, argc, argv);
+		invalidateWrittenCode(s->_segMan, argc, argv);
 
 		if (kernelSubCall.debugLogging)
 			logKernelCall(&kernelCall, &kernelSubCall, s, argc, argv, s->r_acc);
@@ -542,6 +566,7 @@ void run_vm(EngineState *s) {
 	ExecStack *xs_new = NULL;
 	Object *obj = s->_segMan->getObject(s->xs->objp);
 	Script *scr = 0;
+	int nextIndex = -1, branchIndex = -1; // Decoded instructions of scr that may run next
 	Script *local_script = s->_segMan->getScriptIfLoaded(s->xs->local_segment);
 	int old_executionStackBase = s->executionStackBase;
 	// Used to detect the stack bottom, for "physical" returns
@@ -574,6 +599,7 @@ void run_vm(EngineState *s) {
 			scr = s->_segMan->getScriptIfLoaded(s->xs->addr.pc.getSegment());
 			if (!scr)
 				error("No script in segment %d",  s->xs->addr.pc.getSegment());
+			nextIndex = branchIndex = -1;
 			s->xs = &(s->_executionStack.back());
 			s->_executionStackPosChanged = false;
 
@@ -614,9 +640,21 @@ void run_vm(EngineState *s) {
 			error("run_vm(): program counter gone astray, addr: %d, code buffer size: %d",
 			s->xs->addr.pc.getOffset(), scr->getBufSize());
 
+		if (g_sci->_debugState.recordInstructions)
+			g_sci->_debugState.recordInstruction(s->xs->addr.pc, scr->getScriptNumber());
+
 		// Get opcode
 		byte extOpcode;
-		s->xs->addr.pc.incOffset(readPMachineInstruction(scr->getBuf(s->xs->addr.pc.getOffset()), extOpcode, opparams));
+		const PMachineInstruction *instruction = NULL;
+		if (g_sci->_debugState.predecodeScripts)
+			instruction = scr->fetchInstruction(s->xs->addr.pc.getOffset(), nextIndex, branchIndex);
+		if (instruction) {
+			extOpcode = instruction->extOpcode;
+			memcpy(opparams, instruction->opparams, sizeof(opparams));
+			s->xs->addr.pc.incOffset(instruction->size);
+		} else {
+			s->xs->addr.pc.incOffset(readPMachineInstruction(scr->getBuf(s->xs->addr.pc.getOffset()), extOpcode, opparams));
+		}
 		const byte opcode = extOpcode >> 1;
 		//debug("%s: %d, %d, %d, %d, acc = %04x:%04x, script %d, local script %d", opcodeNames[opcode], opparams[0], opparams[1], opparams[2], opparams[3], PRINT_REG(s->r_acc), scr->getScriptNumber(), local_script->getScriptNumber());
 
@@ -839,9 +877,15 @@ void run_vm(EngineState *s) {
 
 		case op_callk: { // 0x21 (33)
 			// Run the garbage collector, if needed
-			if (s->gcCountDown-- <= 0) {
+			GarbageCollector *gc = s->_segMan->getGarbageCollector();
+			if (gc->isMarking()) {
+				gc->step(s, GC_INCREMENTAL_STEP);
+			} else if (s->gcCountDown-- <= 0) {
 				s->gcCountDown = s->scriptGCInterval;
-				run_gc(s);
+				if (s->incrementalGC)
+					gc->start(s);
+				else
+					run_gc(s);
 			}
 
 			// Call kernel function
@@ -856,6 +900,13 @@ void run_vm(EngineState *s) {
 			if (!oldScriptHeader)
 				argc += s->r_rest;
 
+			// Kernel functions may change the objects passed to them in
+			// arbitrary ways, so these have to be scanned again
+			if (gc->isMarking()) {
+				for (int i = 1; i <= argc; i++)
+					gc->rescan(s->xs->sp[i]);
+			}
+
 			callKernelFunc(s, opparams[0], argc);
 
 			if (!oldScriptHeader)
@@ -921,9 +972,10 @@ void run_vm(EngineState *s) {
 				if (old_xs->type == EXEC_STACK_TYPE_VARSELECTOR) {
 					// varselector access?
 					reg_t *var = old_xs->getVarPointer(s->_segMan);
-					if (old_xs->argc) // write?
+					if (old_xs->argc) { // write?
 						*var = old_xs->variables_argp[1];
-					else // No, read
+						s->_segMan->getGarbageCollector()->writeBarrier(*var);
+					} else // No, read
 						s->r_acc = *var;
 				}
 
@@ -1079,6 +1131,7 @@ void run_vm(EngineState *s) {
 		case op_aTop: // 0x32 (50)
 			// Accumulator To Property
 			validate_property(s, obj, opparams[0]) = s->r_acc;
+			s->_segMan->getGarbageCollector()->writeBarrier(s->r_acc);
 			break;
 
 		case op_pTos: // 0x33 (51)
@@ -1088,7 +1141,9 @@ void run_vm(EngineState *s) {
 
 		case op_sTop: // 0x34 (52)
 			// Stack To Property
-			validate_property(s, obj, opparams[0]) = POP32();
+			r_temp = POP32();
+			validate_property(s, obj, opparams[0]) = r_temp;
+			s->_segMan->getGarbageCollector()->writeBarrier(r_temp);
 			break;
 
 		case op_ipToa: // 0x35 (53)
@@ -1333,6 +1388,65 @@ void run_vm(EngineState *s) {
 	}
 }
 
+void benchmarkVM(EngineState *s, Console *con, int iterations) {
+	const Common::Array<RecordedInstruction> &recorded = g_sci->_debugState.recordedInstructions;
+
+	// Skip the instructions of scripts that have been unloaded since
+	Common::Array<Script *> scripts;
+	Common::Array<uint32> offsets;
+	for (uint i = 0; i < recorded.size(); i++) {
+		Script *scr = s->_segMan->getScriptIfLoaded(recorded[i].pc.getSegment());
+		if (scr && scr->getScriptNumber() == recorded[i].scriptNr && scr->findInstruction(recorded[i].pc.getOffset()) >= 0) {
+			scripts.push_back(scr);
+			offsets.push_back(recorded[i].pc.getOffset());
+		}
+	}
+
+	if (scripts.empty()) {
+		con->DebugPrintf("No instructions of loaded scripts have been recorded yet, see \"vm_bench record\"\n");
+		return;
+	}
+
+	con->DebugPrintf("Replaying %d of %d recorded instructions %d times\n", scripts.size(), recorded.size(), iterations);
+
+	uint32 checksum[2] = { 0, 0 };
+	for (int pass = 0; pass < 2; pass++) {
+		const uint32 startTime = g_system->getMillis();
+
+		for (int i = 0; i < iterations; i++) {
+			Script *scr = NULL;
+			int nextIndex = -1, branchIndex = -1;
+
+			for (uint j = 0; j < scripts.size(); j++) {
+				byte extOpcode;
+				int16 opparams[4];
+
+				if (pass) {
+					// Like run_vm(), which forgets the indices on every call and return
+					if (scripts[j] != scr) {
+						scr = scripts[j];
+						nextIndex = branchIndex = -1;
+					}
+					const PMachineInstruction *instruction = scr->fetchInstruction(offsets[j], nextIndex, branchIndex);
+					extOpcode = instruction->extOpcode;
+					memcpy(opparams, instruction->opparams, sizeof(opparams));
+				} else {
+					readPMachineInstruction(scripts[j]->getBuf(offsets[j]), extOpcode, opparams);
+				}
+
+				checksum[pass] += extOpcode + opparams[0] + opparams[1];
+			}
+		}
+
+		const uint32 elapsed = g_system->getMillis() - startTime;
+		con->DebugPrintf("%s: %d ms, %.1f ns per instruction\n", pass ? "Pre-decoded" : "Decoding   ",
+			elapsed, elapsed * 1000000.0 / ((double)iterations * scripts.size()));
+	}
+
+	if (checksum[0] != checksum[1])
+		con->DebugPrintf("Warning: the pre-decoded instructions differ from the decoded ones\n");
+}
+
 reg_t *ObjVarRef::getPointer(SegManager *segMan) const {
 	Object *o = segMan->getObject(obj);
 	return o ? &o->getVariableRef(varindex) : 0;
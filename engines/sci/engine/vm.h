@@ -36,6 +36,7 @@ class SegManager;
 struct EngineState;
 class Object;
 class ResourceManager;
+class Console;
 
 /** Number of bytes to be allocated for the stack */
 #define VM_STACK_SIZE 0x1000
@@ -134,7 +135,10 @@ enum {
 
 /** Number of kernel calls in between gcs; should be < 50000 */
 enum {
-	GC_INTERVAL = 0x8000
+	GC_INTERVAL = 0x8000,
+
+	/** Number of references marked per kernel call by the incremental gc */
+	GC_INCREMENTAL_STEP = 256
 };
 
 enum SciOpcodes {
@@ -348,6 +352,67 @@ void script_debug(EngineState *s);
 SelectorType lookupSelector(SegManager *segMan, reg_t obj, Selector selectorid,
 		ObjVarRef *varp, reg_t *fptr);
 
+/**
+ * Cache for the results of lookupSelector(), so that sending to an object
+ * does not need to search the selector tables of the object and all of
+ * its superclasses every time.
+ *
+ * The cache is keyed by the script object an object is based on (clones
+ * share the selector tables of the object they were cloned from) and the
+ * selector. It is a direct mapped table, so a lookup costs a single probe.
+ * All entries are invalidated whenever scripts are loaded or unloaded.
+ */
+class SelectorLookupCache {
+public:
+	struct Entry {
+		reg_t object;		///< Position of the script object, see Object::getPos()
+		reg_t superClass;	///< Superclass of the object at the time of the lookup
+		Selector selector;
+		uint32 generation;
+		SelectorType type;
+		int varIndex;		///< Variable index, for kSelectorVariable
+		reg_t function;		///< Method address, for kSelectorMethod
+	};
+
+	SelectorLookupCache() : _generation(1) {
+		invalidateAll();
+	}
+
+	/** Return the slot for the given object and selector, which may contain another entry. */
+	Entry &getEntry(reg_t object, Selector selector) {
+		uint hash = (object.getSegment() * 0x9E37u) ^ (object.getOffset() * 0x45D9u) ^ (selector * 0x2F31u);
+		return _entries[(hash ^ (hash >> 12)) & (kSize - 1)];
+	}
+
+	/** Check whether the given slot contains a valid entry for the object and selector. */
+	bool isValid(const Entry &entry, reg_t object, reg_t superClass, Selector selector) const {
+		return entry.generation == _generation && entry.selector == selector &&
+			entry.object == object && entry.superClass == superClass;
+	}
+
+	void validate(Entry &entry) { entry.generation = _generation; }
+
+	/** Invalidate all entries, to be called when any objects change. */
+	void invalidate() {
+		if (++_generation == 0)
+			invalidateAll();
+	}
+
+private:
+	enum {
+		kSize = 4096
+	};
+
+	void invalidateAll() {
+		for (uint i = 0; i < kSize; ++i)
+			_entries[i].generation = 0;
+		_generation = 1;
+	}
+
+	uint32 _generation;
+	Entry _entries[kSize];
+};
+
 /**
  * Read a PMachine instruction from a memory buffer and return its length.
  *
@@ -366,6 +431,26 @@ SelectorType lookupSelector(SegManager *segMan, reg_t obj, Selector selectorid,
  */
 int readPMachineInstruction(const byte *src, byte &extOpcode, int16 opparams[4]);
 
+/**
+ * A PMachine instruction as decoded by readPMachineInstruction(), see
+ * Script::findInstruction().
+ */
+struct PMachineInstruction {
+	int16 opparams[4];
+	uint32 offset;	///< Offset of the instruction in its script
+	int32 next;		///< Index of the instruction that follows, or -1 if not decoded
+	int32 branch;	///< Index of the target of bt, bnt and jmp, or -1 if not decoded
+	uint16 size;	///< Length of the instruction in bytes
+	byte extOpcode;
+};
+
+/**
+ * Replay the instructions recorded by the vm_bench console command, once
+ * decoding every instruction with readPMachineInstruction() and once
+ * fetching the pre-decoded instructions the way run_vm() does.
+ */
+void benchmarkVM(EngineState *s, Console *con, int iterations);
+
 } // End of namespace Sci
 
 #endif // SCI_ENGINE_VM_H
@@ -327,7 +327,9 @@ void SciEngine::sleep(uint32 msecs) {
 		_eventMan->getSciEvent(SCI_EVENT_PEEK);
 		time = g_system->getMillis();
 		if (time + 10 < wakeup_time) {
-			g_system->delayMillis(10);
+			// Use the spare time to load resources which will be needed soon
+			if (!_resMan->prefetchResource())
+				g_system->delayMillis(10);
 		} else {
 			if (time < wakeup_time)
 				g_system->delayMillis(wakeup_time - time);
@@ -20,11 +20,13 @@
  *
  */
 
+#include "common/config-manager.h"
 #include "common/util.h"
 #include "common/stack.h"
 #include "graphics/primitives.h"
 
 #include "sci/sci.h"
+#include "sci/console.h"
 #include "sci/engine/state.h"
 #include "sci/engine/selector.h"
 #include "sci/graphics/cache.h"
@@ -36,11 +38,25 @@ namespace Sci {
 
 GfxCache::GfxCache(ResourceManager *resMan, GfxScreen *screen, GfxPalette *palette)
 	: _resMan(resMan), _screen(screen), _palette(palette) {
+	_cachedFonts.setStatsName("sci.fontCache");
+	_cachedViews.setStatsName("sci.viewCache");
+	_cachedCels.setStatsName("sci.celCache");
+
+	_celLruFirst = 0;
+	_celLruLast = 0;
+	_celMemory = 0;
+	_maxCelMemory = MAX_CACHED_CEL_MEMORY;
+	if (ConfMan.hasKey("sci_cel_cache_size"))
+		_maxCelMemory = ConfMan.getInt("sci_cel_cache_size") * 1024;
+	_celHits = 0;
+	_celMisses = 0;
+	_celEvictions = 0;
 }
 
 GfxCache::~GfxCache() {
 	purgeFontCache();
 	purgeViewCache();
+	purgeCelCache();
 }
 
 void GfxCache::purgeFontCache() {
@@ -61,6 +77,87 @@ void GfxCache::purgeViewCache() {
 	_cachedViews.clear();
 }
 
+void GfxCache::purgeCelCache() {
+	while (_celLruFirst)
+		removeCachedCel(_celLruFirst);
+}
+
+void GfxCache::removeCachedCel(CachedCel *cel) {
+	if (cel->prev)
+		cel->prev->next = cel->next;
+	else
+		_celLruFirst = cel->next;
+	if (cel->next)
+		cel->next->prev = cel->prev;
+	else
+		_celLruLast = cel->prev;
+
+	_cachedCels.erase(cel->key);
+	_celMemory -= cel->size;
+	delete[] cel->bitmap;
+	delete cel;
+}
+
+const byte *GfxCache::getCachedCel(uint32 key) {
+	CelCache::iterator it = _cachedCels.find(key);
+	if (it == _cachedCels.end()) {
+		_celMisses++;
+		return 0;
+	}
+
+	_celHits++;
+
+	// Move the cel to the front of the LRU list
+	CachedCel *cel = it->_value;
+	if (cel != _celLruFirst) {
+		cel->prev->next = cel->next;
+		if (cel->next)
+			cel->next->prev = cel->prev;
+		else
+			_celLruLast = cel->prev;
+		cel->prev = 0;
+		cel->next = _celLruFirst;
+		_celLruFirst->prev = cel;
+		_celLruFirst = cel;
+	}
+
+	return cel->bitmap;
+}
+
+void GfxCache::addCachedCel(uint32 key, byte *bitmap, uint32 size) {
+	assert(!_cachedCels.contains(key));
+
+	CachedCel *cel = new CachedCel;
+	cel->key = key;
+	cel->bitmap = bitmap;
+	cel->size = size;
+	cel->prev = 0;
+	cel->next = _celLruFirst;
+	if (_celLruFirst)
+		_celLruFirst->prev = cel;
+	else
+		_celLruLast = cel;
+	_celLruFirst = cel;
+
+	_cachedCels[key] = cel;
+	_celMemory += size;
+
+	// Free the least recently used cels, but never the one just added
+	while (_celMemory > _maxCelMemory && _celLruLast != cel) {
+		removeCachedCel(_celLruLast);
+		_celEvictions++;
+	}
+}
+
+void GfxCache::printCelCacheStats(Console *con) {
+	uint32 lookups = _celHits + _celMisses;
+
+	con->DebugPrintf("Cel cache: %d cels, %d of %d KB used\n", _cachedCels.size(), _celMemory / 1024, _maxCelMemory / 1024);
+	con->DebugPrintf("%d lookups, %d hits (%d%%), %d misses, %d cels evicted\n", lookups, _celHits,
+		lookups ? _celHits * 100 / lookups : 0, _celMisses, _celEvictions);
+	con->DebugPrintf("View cache: %d views\n", _cachedViews.size());
+}
+
 GfxFont *GfxCache::getFont(GuiResourceId fontId) {
 	if (_cachedFonts.size() >= MAX_CACHED_FONTS)
 		purgeFontCache();
@@ -81,7 +178,7 @@ GfxView *GfxCache::getView(GuiResourceId viewId) {
 		purgeViewCache();
 
 	if (!_cachedViews.contains(viewId))
-		_cachedViews[viewId] = new GfxView(_resMan, _screen, _palette, viewId);
+		_cachedViews[viewId] = new GfxView(_resMan, _screen, _palette, viewId, this);
 
 	return _cachedViews[viewId];
 }
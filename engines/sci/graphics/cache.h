@@ -27,11 +27,24 @@
 
 namespace Sci {
 
+class Console;
 class GfxFont;
 class GfxView;
 
+/**
+ * An unpacked cel in the cel cache
+ */
+struct CachedCel {
+	uint32 key;
+	byte *bitmap;
+	uint32 size;
+	CachedCel *prev; ///< The next more recently used cel
+	CachedCel *next; ///< The next less recently used cel
+};
+
 typedef Common::HashMap<int, GfxFont *> FontCache;
 typedef Common::HashMap<int, GfxView *> ViewCache;
+typedef Common::HashMap<uint32, CachedCel *> CelCache;
 
 /**
  * Cache class, handles caching of views/fonts
@@ -51,9 +64,31 @@ public:
 
 	byte kernelViewGetColorAtCoordinate(GuiResourceId viewId, int16 loopNo, int16 celNo, int16 x, int16 y);
 
+	/**
+	 * Looks up an unpacked cel in the cel cache, which is shared by all views
+	 * and survives them being purged from the view cache.
+	 * @param key	The key of the cel, as built by GfxView
+	 * @return The bitmap of the cel, or NULL if it isn't cached
+	 */
+	const byte *getCachedCel(uint32 key);
+
+	/**
+	 * Adds an unpacked cel to the cel cache, which takes over the bitmap.
+	 * Less recently used cels are freed when the cache gets too large. The
+	 * bitmap stays valid at least until the next cel is added.
+	 * @param key		The key of the cel, as built by GfxView
+	 * @param bitmap	The bitmap of the cel, allocated with new[]
+	 * @param size		The size of the bitmap in bytes
+	 */
+	void addCachedCel(uint32 key, byte *bitmap, uint32 size);
+
+	void printCelCacheStats(Console *con);
+
 private:
 	void purgeFontCache();
 	void purgeViewCache();
+	void purgeCelCache();
+	void removeCachedCel(CachedCel *cel);
 
 	ResourceManager *_resMan;
 	GfxScreen *_screen;
@@ -61,6 +96,15 @@ private:
 
 	FontCache _cachedFonts;
 	ViewCache _cachedViews;
+
+	CelCache _cachedCels;
+	CachedCel *_celLruFirst; ///< The most recently used cel
+	CachedCel *_celLruLast; ///< The least recently used cel
+	uint32 _celMemory; ///< Memory used by the cached cels
+	uint32 _maxCelMemory;
+	uint32 _celHits;
+	uint32 _celMisses;
+	uint32 _celEvictions;
 };
 
 } // End of namespace Sci
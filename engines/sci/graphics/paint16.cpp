@@ -20,7 +20,10 @@
  *
  */
 
+#include "common/config-manager.h"
+
 #include "sci/sci.h"
+#include "sci/console.h"
 #include "sci/engine/features.h"
 #include "sci/engine/state.h"
 #include "sci/engine/selector.h"
@@ -43,9 +46,18 @@ namespace Sci {
 
 GfxPaint16::GfxPaint16(ResourceManager *resMan, SegManager *segMan, Kernel *kernel, GfxCache *cache, GfxPorts *ports, GfxCoordAdjuster *coordAdjuster, GfxScreen *screen, GfxPalette *palette, GfxTransitions *transitions, AudioPlayer *audio)
 	: _resMan(resMan), _segMan(segMan), _kernel(kernel), _cache(cache), _ports(ports), _coordAdjuster(coordAdjuster), _screen(screen), _palette(palette), _transitions(transitions), _audio(audio) {
+	_pictureMemory = 0;
+	_maxPictureMemory = MAX_CACHED_PICTURE_MEMORY;
+	if (ConfMan.hasKey("sci_picture_cache_size"))
+		_maxPictureMemory = ConfMan.getInt("sci_picture_cache_size") * 1024;
+	_pictureHits = 0;
+	_pictureMisses = 0;
+	_pictureEvictions = 0;
 }
 
 GfxPaint16::~GfxPaint16() {
+	while (!_cachedPictures.empty())
+		removeCachedPicture(_cachedPictures.begin());
 }
 
 void GfxPaint16::init(GfxAnimate *animate, GfxText16 *text16) {
@@ -60,14 +72,25 @@ void GfxPaint16::debugSetEGAdrawingVisualize(bool state) {
 }
 
 void GfxPaint16::drawPicture(GuiResourceId pictureId, int16 animationNr, bool mirroredFlag, bool addToFlag, GuiResourceId paletteId) {
-	GfxPicture *picture = new GfxPicture(_resMan, _coordAdjuster, _ports, _screen, _palette, pictureId, _EGAdrawingVisualize);
-
-	// do we add to a picture? if not -> clear screen with white
-	if (!addToFlag)
-		clearScreen(_screen->getColorWhite());
-
-	picture->draw(animationNr, mirroredFlag, addToFlag, paletteId);
-	delete picture;
+	// Drawing over a picture depends on what is already on screen, so only
+	// pictures drawn onto a cleared screen get cached. Those may touch
+	// anything from the picture port to the end of the screen.
+	Common::Rect pictureRect(_ports->_curPort->left, _ports->_curPort->top, _screen->getWidth(), _screen->getHeight());
+	pictureRect.clip(_screen->getWidth(), _screen->getHeight());
+	bool useCache = !addToFlag && !_EGAdrawingVisualize && _maxPictureMemory && !pictureRect.isEmpty();
+
+	if (!useCache || !drawCachedPicture(pictureId, mirroredFlag, paletteId, pictureRect)) {
+		GfxPicture *picture = new GfxPicture(_resMan, _coordAdjuster, _ports, _screen, _palette, pictureId, _EGAdrawingVisualize);
+
+		// do we add to a picture? if not -> clear screen with white
+		if (!addToFlag)
+			clearScreen(_screen->getColorWhite());
+
+		picture->draw(animationNr, mirroredFlag, addToFlag, paletteId);
+		if (useCache && picture->isCacheable())
+			addCachedPicture(picture, pictureId, mirroredFlag, paletteId, pictureRect);
+		delete picture;
+	}
 
 	// We make a call to SciPalette here, for increasing sys timestamp and also loading targetpalette, if palvary active
 	//  (SCI1.1 only)
@@ -75,6 +98,101 @@ void GfxPaint16::drawPicture(GuiResourceId pictureId, int16 animationNr, bool mi
 		_palette->drewPicture(pictureId);
 }
 
+bool GfxPaint16::drawCachedPicture(GuiResourceId pictureId, bool mirroredFlag, int16 EGApaletteNo, const Common::Rect &rect) {
+	bool undithering = _screen->isUnditheringEnabled();
+	PictureCache::iterator it;
+
+	for (it = _cachedPictures.begin(); it != _cachedPictures.end(); ++it) {
+		CachedPicture *cached = *it;
+		if (cached->pictureId == pictureId && cached->mirroredFlag == mirroredFlag && cached->EGApaletteNo == EGApaletteNo
+			&& cached->undithering == undithering && cached->rect == rect)
+			break;
+	}
+	if (it == _cachedPictures.end()) {
+		_pictureMisses++;
+		return false;
+	}
+	_pictureHits++;
+
+	// Move the picture to the front, so that it gets evicted last
+	CachedPicture *cached = *it;
+	if (it != _cachedPictures.begin()) {
+		_cachedPictures.erase(it);
+		_cachedPictures.push_front(cached);
+	}
+
+	// Replay everything drawing the picture did
+	_screen->bitsRestore(cached->bits);
+	if (cached->paletteChanged)
+		_palette->set(&cached->palette, true);
+	if (cached->priorityBandsChanged)
+		_ports->priorityBandsRecall(cached->priorityBands);
+	if (cached->ditheredBgColors)
+		memcpy(_screen->unditherGetDitheredBgColors(), cached->ditheredBgColors, DITHERED_BG_COLORS_SIZE * sizeof(int16));
+	return true;
+}
+
+void GfxPaint16::addCachedPicture(GfxPicture *picture, GuiResourceId pictureId, bool mirroredFlag, int16 EGApaletteNo, const Common::Rect &rect) {
+	const byte mask = GFX_SCREEN_MASK_VISUAL | GFX_SCREEN_MASK_PRIORITY | GFX_SCREEN_MASK_CONTROL;
+	uint32 size = _screen->bitsGetDataSize(rect, mask);
+	if (size > _maxPictureMemory)
+		return;
+
+	CachedPicture *cached = new CachedPicture;
+	cached->pictureId = pictureId;
+	cached->mirroredFlag = mirroredFlag;
+	cached->EGApaletteNo = EGApaletteNo;
+	cached->undithering = _screen->isUnditheringEnabled();
+	cached->rect = rect;
+
+	cached->bits = new byte[size];
+	_screen->bitsSave(rect, mask, cached->bits);
+
+	const Palette *palette = picture->getChangedPalette();
+	cached->paletteChanged = (palette != 0);
+	if (palette)
+		cached->palette = *palette;
+
+	cached->priorityBandsChanged = picture->hasChangedPriorityBands();
+	if (cached->priorityBandsChanged)
+		_ports->priorityBandsMemorize(cached->priorityBands);
+
+	// EGA pictures remember their dither combinations for undithering cels
+	cached->ditheredBgColors = 0;
+	if (cached->undithering && _resMan->getViewType() == kViewEga) {
+		cached->ditheredBgColors = new int16[DITHERED_BG_COLORS_SIZE];
+		memcpy(cached->ditheredBgColors, _screen->unditherGetDitheredBgColors(), DITHERED_BG_COLORS_SIZE * sizeof(int16));
+		size += DITHERED_BG_COLORS_SIZE * sizeof(int16);
+	}
+	cached->size = size;
+
+	_cachedPictures.push_front(cached);
+	_pictureMemory += size;
+
+	// Free the least recently drawn pictures, but never the one just added
+	while (_pictureMemory > _maxPictureMemory && _cachedPictures.back() != cached) {
+		removeCachedPicture(--_cachedPictures.end());
+		_pictureEvictions++;
+	}
+}
+
+void GfxPaint16::removeCachedPicture(PictureCache::iterator it) {
+	CachedPicture *cached = *it;
+	_cachedPictures.erase(it);
+	_pictureMemory -= cached->size;
+	delete[] cached->bits;
+	delete[] cached->ditheredBgColors;
+	delete cached;
+}
+
+void GfxPaint16::printPictureCacheStats(Console *con) {
+	uint32 lookups = _pictureHits + _pictureMisses;
+
+	con->DebugPrintf("Picture cache: %d pictures, %d of %d KB used\n", _cachedPictures.size(), _pictureMemory / 1024, _maxPictureMemory / 1024);
+	con->DebugPrintf("%d lookups, %d hits (%d%%), %d misses, %d pictures evicted\n", lookups, _pictureHits,
+		lookups ? _pictureHits * 100 / lookups : 0, _pictureMisses, _pictureEvictions);
+}
+
 // This one is the only one that updates screen!
 void GfxPaint16::drawCelAndShow(GuiResourceId viewId, int16 loopNo, int16 celNo, uint16 leftPos, uint16 topPos, byte priority, uint16 paletteNo, uint16 scaleX, uint16 scaleY) {
 	GfxView *view = _cache->getView(viewId);
@@ -23,16 +23,42 @@
 #ifndef SCI_GRAPHICS_PAINT16_H
 #define SCI_GRAPHICS_PAINT16_H
 
+#include "common/list.h"
+
 #include "sci/graphics/paint.h"
+#include "sci/graphics/ports.h"
 
 namespace Sci {
 
-class GfxPorts;
+class Console;
 class GfxScreen;
 class GfxPalette;
+class GfxPicture;
 class Font;
 class GfxView;
 
+/**
+ * A fully rendered picture in the picture cache, together with the side
+ * effects drawing it had
+ */
+struct CachedPicture {
+	GuiResourceId pictureId;
+	bool mirroredFlag;
+	int16 EGApaletteNo;
+	bool undithering;
+	Common::Rect rect; ///< The screen area that drawing the picture may touch
+
+	byte *bits; ///< The visual, priority and control planes, see GfxScreen::bitsSave()
+	uint32 size;
+	bool paletteChanged;
+	Palette palette;
+	bool priorityBandsChanged;
+	PriorityBands priorityBands;
+	int16 *ditheredBgColors; ///< Only set when undithering EGA pictures
+};
+
+typedef Common::List<CachedPicture *> PictureCache;
+
 /**
  * Paint16 class, handles painting/drawing for SCI16 (SCI0-SCI1.1) games
  */
@@ -44,6 +70,7 @@ public:
 	void init(GfxAnimate *animate, GfxText16 *text16);
 
 	void debugSetEGAdrawingVisualize(bool state);
+	void printPictureCacheStats(Console *con);
 
 	void drawPicture(GuiResourceId pictureId, int16 animationNr, bool mirroredFlag, bool addToFlag, GuiResourceId paletteId);
 	void drawCelAndShow(GuiResourceId viewId, int16 loopNo, int16 celNo, uint16 leftPos, uint16 topPos, byte priority, uint16 paletteNo, uint16 scaleX = 128, uint16 scaleY = 128);
@@ -102,6 +129,18 @@ private:
 
 	// true means make EGA picture drawing visible
 	bool _EGAdrawingVisualize;
+
+	bool drawCachedPicture(GuiResourceId pictureId, bool mirroredFlag, int16 EGApaletteNo, const Common::Rect &rect);
+	void addCachedPicture(GfxPicture *picture, GuiResourceId pictureId, bool mirroredFlag, int16 EGApaletteNo, const Common::Rect &rect);
+	void removeCachedPicture(PictureCache::iterator it);
+
+	// Rendered pictures, the most recently drawn one first
+	PictureCache _cachedPictures;
+	uint32 _pictureMemory;
+	uint32 _maxPictureMemory;
+	uint32 _pictureHits;
+	uint32 _pictureMisses;
+	uint32 _pictureEvictions;
 };
 
 } // End of namespace Sci
@@ -65,6 +65,7 @@ public:
 	bool isRemapped(byte color) const {
 		return _remapOn && (_remappingType[color] != kRemappingNone);
 	}
+	bool isRemapOn() const { return _remapOn; }
 	byte remapColor(byte remappedColor, byte screenColor);
 
 	void setOnScreen();
@@ -67,6 +67,9 @@ void GfxPicture::draw(int16 animationNr, bool mirroredFlag, bool addToFlag, int1
 	_addToFlag = addToFlag;
 	_EGApaletteNo = EGApaletteNo;
 	_priority = 0;
+	_cacheable = false;
+	_paletteChanged = false;
+	_priorityBandsChanged = false;
 
 	headerSize = READ_LE_UINT16(_resource->data);
 	switch (headerSize) {
@@ -83,6 +86,7 @@ void GfxPicture::draw(int16 animationNr, bool mirroredFlag, bool addToFlag, int1
 	default:
 		// VGA, EGA or Amiga vector data
 		_resourceType = SCI_PICTURE_TYPE_REGULAR;
+		_cacheable = !_EGAdrawingVisualize;
 		drawVectorData(_resource->data, _resource->size);
 	}
 }
@@ -743,6 +747,7 @@ void GfxPicture::drawVectorData(byte *data, int dataSize) {
 					break;
 				case PIC_OPX_EGA_SET_PRIORITY_TABLE:
 					_ports->priorityBandsInit(data + curPos);
+					_priorityBandsChanged = true;
 					curPos += 14;
 					break;
 				default:
@@ -766,6 +771,7 @@ void GfxPicture::drawVectorData(byte *data, int dataSize) {
 						} else {
 							// Setting half of the Amiga palette
 							_palette->modifyAmigaPalette(&data[curPos]);
+							_cacheable = false;
 							curPos += 32;
 						}
 					} else {
@@ -775,6 +781,8 @@ void GfxPicture::drawVectorData(byte *data, int dataSize) {
 							palette.colors[i].r = data[curPos++]; palette.colors[i].g = data[curPos++]; palette.colors[i].b = data[curPos++];
 						}
 						_palette->set(&palette, true);
+						_paletteChanged = true;
+						_changedPalette = palette;
 					}
 					break;
 				case PIC_OPX_VGA_EMBEDDED_VIEW: // draw cel
@@ -786,10 +794,12 @@ void GfxPicture::drawVectorData(byte *data, int dataSize) {
 					break;
 				case PIC_OPX_VGA_PRIORITY_TABLE_EQDIST:
 					_ports->priorityBandsInit(-1, READ_LE_UINT16(data + curPos), READ_LE_UINT16(data + curPos + 2));
+					_priorityBandsChanged = true;
 					curPos += 4;
 					break;
 				case PIC_OPX_VGA_PRIORITY_TABLE_EXPLICIT:
 					_ports->priorityBandsInit(data + curPos);
+					_priorityBandsChanged = true;
 					curPos += 14;
 					break;
 				default:
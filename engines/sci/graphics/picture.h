@@ -51,6 +51,16 @@ public:
 	GuiResourceId getResourceId();
 	void draw(int16 animationNr, bool mirroredFlag, bool addToFlag, int16 EGApaletteNo);
 
+	/**
+	 * Returns true, if the result of the last draw() only depends on its
+	 * parameters, so that it may be cached and replayed by the caller.
+	 */
+	bool isCacheable() const { return _cacheable; }
+	/** Returns the palette set by the last draw(), or NULL if it set none */
+	const Palette *getChangedPalette() const { return _paletteChanged ? &_changedPalette : 0; }
+	/** Returns true, if the last draw() changed the priority bands */
+	bool hasChangedPriorityBands() const { return _priorityBandsChanged; }
+
 #ifdef ENABLE_SCI32
 	int16 getSci32celCount();
 	int16 getSci32celY(int16 celNo);
@@ -98,6 +108,12 @@ private:
 
 	// If true, we will show the whole EGA drawing process...
 	bool _EGAdrawingVisualize;
+
+	// Side effects of the last draw(), needed for replaying it from a cache
+	bool _cacheable;
+	bool _paletteChanged;
+	Palette _changedPalette;
+	bool _priorityBandsChanged;
 };
 
 } // End of namespace Sci
@@ -669,6 +669,20 @@ void GfxPorts::priorityBandsInitSci11(byte *data) {
 	priorityBandsInit(priorityBands);
 }
 
+void GfxPorts::priorityBandsMemorize(PriorityBands &bands) const {
+	bands.top = _priorityTop;
+	bands.bottom = _priorityBottom;
+	bands.bandCount = _priorityBandCount;
+	memcpy(bands.bands, _priorityBands, sizeof(bands.bands));
+}
+
+void GfxPorts::priorityBandsRecall(const PriorityBands &bands) {
+	_priorityTop = bands.top;
+	_priorityBottom = bands.bottom;
+	_priorityBandCount = bands.bandCount;
+	memcpy(_priorityBands, bands.bands, sizeof(_priorityBands));
+}
+
 void GfxPorts::kernelInitPriorityBands() {
 	if (_usesOldGfxFunctions) {
 		priorityBandsInit(15, 42, 200);
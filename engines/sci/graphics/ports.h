@@ -43,6 +43,14 @@ enum {
 	SCI_WINDOWMGR_STYLE_USER        = (1 << 7)
 };
 
+/**
+ * The priority band setup, as set by pictures and kInitPriorityBands
+ */
+struct PriorityBands {
+	int16 top, bottom, bandCount;
+	byte bands[200];
+};
+
 typedef Common::List<Port *> PortList;
 typedef Common::Array<Port *> PortArray;
 
@@ -95,6 +103,8 @@ public:
 	void priorityBandsInit(int16 bandCount, int16 top, int16 bottom);
 	void priorityBandsInit(byte *data);
 	void priorityBandsInitSci11(byte *data);
+	void priorityBandsMemorize(PriorityBands &bands) const;
+	void priorityBandsRecall(const PriorityBands &bands);
 
 	void kernelInitPriorityBands();
 	void kernelGraphAdjustPriority(int top, int bottom);
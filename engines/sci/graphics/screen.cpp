@@ -242,6 +242,37 @@ void GfxScreen::putPixel(int x, int y, byte drawMask, byte color, byte priority,
 		_controlScreen[offset] = control;
 }
 
+/**
+ * Puts a horizontal run of pixels onto the screen. This does the same as
+ * calling putPixel() for each of them, but writes whole lines at once.
+ * The colors are taken from pixels after being looked up in colorMapping.
+ */
+void GfxScreen::putPixelSpan(int x, int y, int length, byte drawMask, const byte *pixels, const byte *colorMapping, byte priority, byte control) {
+	int offset = y * _pitch + x;
+
+	if (drawMask & GFX_SCREEN_MASK_VISUAL) {
+		byte *visualPtr = _visualScreen + offset;
+		for (int i = 0; i < length; i++)
+			visualPtr[i] = colorMapping[pixels[i]];
+
+		if (!_upscaledHires) {
+			memcpy(_displayScreen + offset, visualPtr, length);
+		} else {
+			byte *displayPtr = _displayScreen + _upscaledMapping[y] * _displayWidth + x * 2;
+			for (int i = 0; i < length; i++)
+				displayPtr[i * 2] = displayPtr[i * 2 + 1] = visualPtr[i];
+
+			int lineCount = _upscaledMapping[y + 1] - _upscaledMapping[y];
+			for (int line = 1; line < lineCount; line++)
+				memcpy(displayPtr + line * _displayWidth, displayPtr, length * 2);
+		}
+	}
+	if (drawMask & GFX_SCREEN_MASK_PRIORITY)
+		memset(_priorityScreen + offset, priority, length);
+	if (drawMask & GFX_SCREEN_MASK_CONTROL)
+		memset(_controlScreen + offset, control, length);
+}
+
 /**
  * This is used to put font pixels onto the screen - we adjust differently, so that we won't
  *  do triple pixel lines in any case on upscaled hires. That way the font will not get distorted
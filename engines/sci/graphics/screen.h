@@ -81,6 +81,7 @@ public:
 
 	byte getDrawingMask(byte color, byte prio, byte control);
 	void putPixel(int x, int y, byte drawMask, byte color, byte prio, byte control);
+	void putPixelSpan(int x, int y, int length, byte drawMask, const byte *pixels, const byte *colorMapping, byte prio, byte control);
 	void putFontPixel(int startingY, int x, int y, byte color);
 	void putPixelOnDisplay(int x, int y, byte color);
 	void drawLine(Common::Point startPoint, Common::Point endPoint, byte color, byte prio, byte control);
@@ -100,6 +101,7 @@ public:
 	void putKanjiChar(Graphics::FontSJIS *commonFont, int16 x, int16 y, uint16 chr, byte color);
 	byte getVisual(int x, int y);
 	byte getPriority(int x, int y);
+	const byte *getPriorityLine(int y) const { return _priorityScreen + y * _pitch; }
 	byte getControl(int x, int y);
 	byte isFillMatch(int16 x, int16 y, byte drawMask, byte t_color, byte t_pri, byte t_con, bool isEGA);
 
@@ -21,8 +21,10 @@
  */
 
 #include "sci/sci.h"
+#include "sci/debug.h"
 #include "sci/util.h"
 #include "sci/engine/state.h"
+#include "sci/graphics/cache.h"
 #include "sci/graphics/screen.h"
 #include "sci/graphics/palette.h"
 #include "sci/graphics/coordadjuster.h"
@@ -30,8 +32,8 @@
 
 namespace Sci {
 
-GfxView::GfxView(ResourceManager *resMan, GfxScreen *screen, GfxPalette *palette, GuiResourceId resourceId)
-	: _resMan(resMan), _screen(screen), _palette(palette), _resourceId(resourceId) {
+GfxView::GfxView(ResourceManager *resMan, GfxScreen *screen, GfxPalette *palette, GuiResourceId resourceId, GfxCache *celCache)
+	: _resMan(resMan), _screen(screen), _palette(palette), _celCache(celCache), _resourceId(resourceId) {
 	assert(resourceId != -1);
 	_coordAdjuster = g_sci->_gfxCoordAdjuster;
 	initData(resourceId);
@@ -43,6 +45,7 @@ GfxView::~GfxView() {
 		// and through the cells of each loop
 		for (uint16 celNum = 0; celNum < _loop[loopNum].celCount; celNum++) {
 			delete[] _loop[loopNum].cel[celNum].rawBitmap;
+			delete[] _loop[loopNum].cel[celNum].opaqueRuns;
 		}
 		delete[] _loop[loopNum].cel;
 	}
@@ -201,6 +204,7 @@ void GfxView::initData(GuiResourceId resourceId) {
 					}
 				}
 				cel->rawBitmap = 0;
+				cel->opaqueRuns = 0;
 				if (_loop[loopNo].mirrorFlag)
 					cel->displaceX = -cel->displaceX;
 			}
@@ -293,6 +297,7 @@ void GfxView::initData(GuiResourceId resourceId) {
 					SWAP(cel->offsetRLE, cel->offsetLiteral);
 
 				cel->rawBitmap = 0;
+				cel->opaqueRuns = 0;
 				if (_loop[loopNo].mirrorFlag)
 					cel->displaceX = -cel->displaceX;
 
@@ -585,12 +590,25 @@ const byte *GfxView::getBitmap(int16 loopNo, int16 celNo) {
 	if (_loop[loopNo].cel[celNo].rawBitmap)
 		return _loop[loopNo].cel[celNo].rawBitmap;
 
+	// Use the shared cel cache, if possible. EGA cels which may get undithered
+	// depend on the current picture, so these are kept in the view.
+	bool useCelCache = _celCache && _resourceId <= 0xFFFF && loopNo <= 0xFF && celNo <= 0xFF;
+	if (_resMan->getViewType() == kViewEga && _screen->unditherGetDitheredBgColors())
+		useCelCache = false;
+
+	const uint32 celKey = ((uint32)_resourceId << 16) | (loopNo << 8) | celNo;
+	if (useCelCache) {
+		const byte *cachedBitmap = _celCache->getCachedCel(celKey);
+		if (cachedBitmap)
+			return cachedBitmap;
+	}
+
 	uint16 width = _loop[loopNo].cel[celNo].width;
 	uint16 height = _loop[loopNo].cel[celNo].height;
 	// allocating memory to store cel's bitmap
 	int pixelCount = width * height;
-	_loop[loopNo].cel[celNo].rawBitmap = new byte[pixelCount];
-	byte *pBitmap = _loop[loopNo].cel[celNo].rawBitmap;
+	byte *bitmap = new byte[pixelCount];
+	byte *pBitmap = bitmap;
 
 	// unpack the actual cel bitmap data
 	unpackCel(loopNo, celNo, pBitmap, pixelCount);
@@ -604,7 +622,51 @@ const byte *GfxView::getBitmap(int16 loopNo, int16 celNo) {
 			for (int j = 0; j < width / 2; j++)
 				SWAP(pBitmap[j], pBitmap[width - j - 1]);
 	}
-	return _loop[loopNo].cel[celNo].rawBitmap;
+
+	if (useCelCache)
+		_celCache->addCachedCel(celKey, bitmap, pixelCount);
+	else
+		_loop[loopNo].cel[celNo].rawBitmap = bitmap;
+	return bitmap;
+}
+
+/**
+ * Returns where the opaque pixels of a cel are, as runs of pixels for each
+ * line. These are the same for all bitmaps of the cel, even if it has been
+ * undithered.
+ */
+const uint16 *GfxView::getOpaqueRuns(int16 loopNo, int16 celNo) {
+	loopNo = CLIP<int16>(loopNo, 0, _loopCount -1);
+	celNo = CLIP<int16>(celNo, 0, _loop[loopNo].celCount - 1);
+	CelInfo *celInfo = &_loop[loopNo].cel[celNo];
+	if (celInfo->opaqueRuns)
+		return celInfo->opaqueRuns;
+
+	const byte *bitmap = getBitmap(loopNo, celNo);
+	Common::Array<uint16> runs;
+
+	for (int16 y = 0; y < celInfo->height; y++, bitmap += celInfo->width) {
+		uint countPos = runs.size();
+		runs.push_back(0);
+
+		int16 x = 0;
+		while (x < celInfo->width) {
+			while (x < celInfo->width && bitmap[x] == celInfo->clearKey)
+				x++;
+			int16 start = x;
+			while (x < celInfo->width && bitmap[x] != celInfo->clearKey)
+				x++;
+			if (x > start) {
+				runs.push_back(start);
+				runs.push_back(x - start);
+				runs[countPos]++;
+			}
+		}
+	}
+
+	celInfo->opaqueRuns = new uint16[runs.size()];
+	memcpy(celInfo->opaqueRuns, runs.begin(), runs.size() * sizeof(uint16));
+	return celInfo->opaqueRuns;
 }
 
 /**
@@ -733,7 +795,26 @@ void GfxView::draw(const Common::Rect &rect, const Common::Rect &clipRect, const
 	if (g_sci->getGameId() == GID_ECOQUEST && g_sci->getEngineState()->currentRoomNumber() == 440 && priority == 15)
 		priority = 14;
 
-	if (!_EGAmapping) {
+	if (!_EGAmapping && !upscaledHires && !_palette->isRemapOn() && g_sci->_debugState.spanDrawing) {
+		// Draw the runs of opaque pixels at once. This does the same as the
+		// pixel by pixel code below.
+		const int16 offsetX = clipRect.left - rect.left;
+		const uint16 *runs = getOpaqueRuns(loopNo, celNo);
+
+		for (y = clipRect.top - rect.top; y > 0; y--)
+			runs += 1 + runs[0] * 2;
+
+		for (y = 0; y < height; y++, bitmap += celWidth) {
+			const uint16 runCount = *runs++;
+
+			for (uint16 run = 0; run < runCount; run++, runs += 2) {
+				const int start = MAX<int>(runs[0] - offsetX, 0);
+				const int end = MIN<int>(runs[0] + runs[1] - offsetX, width);
+				if (start < end)
+					drawSpan(clipRectTranslated.left + start, clipRectTranslated.top + y, end - start, bitmap + start, palette->mapping, priority, drawMask);
+			}
+		}
+	} else if (!_EGAmapping) {
 		for (y = 0; y < height; y++, bitmap += celWidth) {
 			for (x = 0; x < width; x++) {
 				const byte color = bitmap[x];
@@ -851,6 +932,30 @@ void GfxView::drawScaled(const Common::Rect &rect, const Common::Rect &clipRect,
 
 	assert(scaledHeight + offsetY <= ARRAYSIZE(scalingY));
 	assert(scaledWidth + offsetX <= ARRAYSIZE(scalingX));
+
+	if (!_palette->isRemapOn() && g_sci->_debugState.spanDrawing) {
+		// Scale each line first, then draw its runs of opaque pixels at once
+		byte scaledLine[ARRAYSIZE(scalingX)];
+
+		for (int y = 0; y < scaledHeight; y++) {
+			const byte *celLine = bitmap + scalingY[y + offsetY] * celWidth;
+			for (int x = 0; x < scaledWidth; x++)
+				scaledLine[x] = celLine[scalingX[x + offsetX]];
+
+			int x = 0;
+			while (x < scaledWidth) {
+				while (x < scaledWidth && scaledLine[x] == clearKey)
+					x++;
+				const int start = x;
+				while (x < scaledWidth && scaledLine[x] != clearKey)
+					x++;
+				if (x > start)
+					drawSpan(clipRectTranslated.left + start, clipRectTranslated.top + y, x - start, scaledLine + start, palette->mapping, priority, drawMask);
+			}
+		}
+		return;
+	}
+
 	for (int y = 0; y < scaledHeight; y++) {
 		for (int x = 0; x < scaledWidth; x++) {
 			const byte color = bitmap[scalingY[y + offsetY] * celWidth + scalingX[x + offsetX]];
@@ -868,6 +973,36 @@ void GfxView::drawScaled(const Common::Rect &rect, const Common::Rect &clipRect,
 	}
 }
 
+/**
+ * Draws a run of opaque pixels, leaving out the ones which are behind
+ * something with a higher priority.
+ */
+void GfxView::drawSpan(int x, int y, int length, const byte *pixels, const byte *colorMapping, byte priority, byte drawMask) {
+	const byte *priorityLine = _screen->getPriorityLine(y) + x;
+
+	// Usually nothing in front of the run, so check that first. This loop is
+	// simple enough for the compiler to vectorize it.
+	byte maxPriority = 0;
+	for (int i = 0; i < length; i++)
+		maxPriority = MAX(maxPriority, priorityLine[i]);
+
+	if (maxPriority <= priority) {
+		_screen->putPixelSpan(x, y, length, drawMask, pixels, colorMapping, priority, 0);
+		return;
+	}
+
+	int i = 0;
+	while (i < length) {
+		while (i < length && priorityLine[i] > priority)
+			i++;
+		const int start = i;
+		while (i < length && priorityLine[i] <= priority)
+			i++;
+		if (i > start)
+			_screen->putPixelSpan(x + start, y, i - start, drawMask, pixels + start, colorMapping, priority, 0);
+	}
+}
+
 void GfxView::adjustToUpscaledCoordinates(int16 &y, int16 &x) {
 	_screen->adjustToUpscaledCoordinates(y, x, _sci2ScaleRes);
 }
@@ -42,6 +42,7 @@ struct CelInfo {
 	uint32 offsetRLE;
 	uint32 offsetLiteral;
 	byte *rawBitmap;
+	uint16 *opaqueRuns; // per line: run count, then start and length of each run
 };
 
 struct LoopInfo {
@@ -53,6 +54,7 @@ struct LoopInfo {
 #define SCI_VIEW_EGAMAPPING_SIZE 16
 #define SCI_VIEW_EGAMAPPING_COUNT 8
 
+class GfxCache;
 class GfxScreen;
 class GfxPalette;
 
@@ -62,7 +64,7 @@ class GfxPalette;
  */
 class GfxView {
 public:
-	GfxView(ResourceManager *resMan, GfxScreen *screen, GfxPalette *palette, GuiResourceId resourceId);
+	GfxView(ResourceManager *resMan, GfxScreen *screen, GfxPalette *palette, GuiResourceId resourceId, GfxCache *celCache = 0);
 	~GfxView();
 
 	GuiResourceId getResourceId() const;
@@ -91,12 +93,17 @@ private:
 	void initData(GuiResourceId resourceId);
 	void unpackCel(int16 loopNo, int16 celNo, byte *outPtr, uint32 pixelCount);
 	void unditherBitmap(byte *bitmap, int16 width, int16 height, byte clearKey);
+	const uint16 *getOpaqueRuns(int16 loopNo, int16 celNo);
+	void drawSpan(int x, int y, int length, const byte *pixels, const byte *colorMapping, byte priority, byte drawMask);
 
 	ResourceManager *_resMan;
 	GfxCoordAdjuster *_coordAdjuster;
 	GfxScreen *_screen;
 	GfxPalette *_palette;
 
+	// if set, unpacked cels are kept in this cache instead of in the view
+	GfxCache *_celCache;
+
 	GuiResourceId _resourceId;
 	Resource *_resource;
 	byte *_resourceData;
@@ -32,6 +32,7 @@ namespace Sci {
 
 Vocabulary::Vocabulary(ResourceManager *resMan, bool foreign) : _resMan(resMan), _foreign(foreign) {
 	_parserRules = NULL;
+	_parserWords.setStatsName("sci.parserWords");
 
 	memset(_parserNodes, 0, sizeof(_parserNodes));
 	// Mark parse tree as unused
@@ -22,11 +22,15 @@
 
 // Resource library
 
+#include "common/config-manager.h"
 #include "common/file.h"
 #include "common/fs.h"
 #include "common/macresman.h"
+#include "common/memstream.h"
+#include "common/system.h"
 #include "common/textconsole.h"
 
+#include "sci/console.h"
 #include "sci/resource.h"
 #include "sci/resource_intern.h"
 #include "sci/util.h"
@@ -181,6 +185,40 @@ ResourceType ResourceManager::convertResType(byte type) {
 	return kResourceTypeInvalid;
 }
 
+/**
+ * A resource whose packed data has been read by prefetchResource(), to be
+ * decompressed the next time the engine is idle, or when the resource is
+ * needed.
+ */
+struct DecompressionJob {
+	Resource *res;
+	Decompressor *dec;
+	byte *packed;
+	uint32 packedSize;
+};
+
+static Decompressor *createDecompressor(ResourceCompression compression) {
+	switch (compression) {
+	case kCompNone:
+		return new Decompressor;
+	case kCompHuffman:
+		return new DecompressorHuffman;
+	case kCompLZW:
+	case kCompLZW1:
+	case kCompLZW1View:
+	case kCompLZW1Pic:
+		return new DecompressorLZW(compression);
+	case kCompDCL:
+		return new DecompressorDCL;
+#ifdef ENABLE_SCI32
+	case kCompSTACpack:
+		return new DecompressorLZS;
+#endif
+	default:
+		return NULL;
+	}
+}
+
 //-- Resource main functions --
 Resource::Resource(ResourceManager *resMan, ResourceId id) : _resMan(resMan), _id(id) {
 	data = NULL;
@@ -188,6 +226,8 @@ Resource::Resource(ResourceManager *resMan, ResourceId id) : _resMan(resMan), _i
 	_fileOffset = 0;
 	_status = kResStatusNoMalloc;
 	_lockers = 0;
+	_lruPrev = NULL;
+	_lruNext = NULL;
 	_source = NULL;
 	_header = NULL;
 	_headerSize = 0;
@@ -367,6 +407,9 @@ Common::SeekableReadStream *ResourceManager::getVolumeFile(ResourceSource *sourc
 }
 
 void ResourceManager::loadResource(Resource *res) {
+	if (_backgroundDecompression && finishDecompression(res))
+		return;
+
 	res->_source->loadResource(this, res);
 }
 
@@ -884,13 +927,28 @@ void ResourceManager::freeResourceSources() {
 }
 
 ResourceManager::ResourceManager() {
+	_resMap.setStatsName("sci.resources");
+	_backgroundDecompression = false;
 }
 
 void ResourceManager::init(bool initFromFallbackDetector) {
 	_memoryLocked = 0;
 	_memoryLRU = 0;
-	_LRU.clear();
+	_maxMemoryLRU = DEFAULT_MAX_MEMORY;
+	if (ConfMan.hasKey("sci_resource_cache_size")) {
+		const int configSize = ConfMan.getInt("sci_resource_cache_size");
+		const int cacheSize = CLIP<int>(configSize, MIN_MAX_MEMORY / 1024, MAX_MAX_MEMORY / 1024);
+		if (cacheSize != configSize)
+			warning("sci_resource_cache_size must be between %d and %d KB, using %d KB", MIN_MAX_MEMORY / 1024, MAX_MAX_MEMORY / 1024, cacheSize);
+		_maxMemoryLRU = cacheSize * 1024;
+	}
+	_lruFirst = NULL;
+	_lruLast = NULL;
+	_prefetchQueue.clear();
 	_resMap.clear();
+
+	_backgroundDecompression = ConfMan.hasKey("sci_background_decompression") &&
+			ConfMan.getBool("sci_background_decompression");
 	_audioMapSCI1 = NULL;
 
 	// FIXME: put this in an Init() function, so that we can error out if detection fails completely
@@ -972,6 +1030,12 @@ void ResourceManager::init(bool initFromFallbackDetector) {
 }
 
 ResourceManager::~ResourceManager() {
+	for (Common::List<DecompressionJob *>::iterator it = _decompressionJobs.begin(); it != _decompressionJobs.end(); ++it) {
+		delete (*it)->dec;
+		delete[] (*it)->packed;
+		delete *it;
+	}
+
 	// freeing resources
 	ResourceMap::iterator itr = _resMap.begin();
 	while (itr != _resMap.end()) {
@@ -992,7 +1056,17 @@ void ResourceManager::removeFromLRU(Resource *res) {
 		warning("resMan: trying to remove resource that isn't enqueued");
 		return;
 	}
-	_LRU.remove(res);
+
+	if (res->_lruPrev)
+		res->_lruPrev->_lruNext = res->_lruNext;
+	else
+		_lruFirst = res->_lruNext;
+	if (res->_lruNext)
+		res->_lruNext->_lruPrev = res->_lruPrev;
+	else
+		_lruLast = res->_lruPrev;
+	res->_lruPrev = res->_lruNext = NULL;
+
 	_memoryLRU -= res->size;
 	res->_status = kResStatusAllocated;
 }
@@ -1002,7 +1076,15 @@ void ResourceManager::addToLRU(Resource *res) {
 		warning("resMan: trying to enqueue resource with state %d", res->_status);
 		return;
 	}
-	_LRU.push_front(res);
+
+	res->_lruPrev = NULL;
+	res->_lruNext = _lruFirst;
+	if (_lruFirst)
+		_lruFirst->_lruPrev = res;
+	else
+		_lruLast = res;
+	_lruFirst = res;
+
 	_memoryLRU += res->size;
 #if SCI_VERBOSE_RESMAN
 	debug("Adding %s.%03d (%d bytes) to lru control: %d bytes total",
@@ -1015,24 +1097,20 @@ void ResourceManager::addToLRU(Resource *res) {
 void ResourceManager::printLRU() {
 	int mem = 0;
 	int entries = 0;
-	Common::List<Resource *>::iterator it = _LRU.begin();
-	Resource *res;
 
-	while (it != _LRU.end()) {
-		res = *it;
+	for (Resource *res = _lruFirst; res; res = res->_lruNext) {
 		debug("\t%s: %d bytes", res->_id.toString().c_str(), res->size);
 		mem += res->size;
 		++entries;
-		++it;
 	}
 
 	debug("Total: %d entries, %d bytes (mgr says %d)", entries, mem, _memoryLRU);
 }
 
 void ResourceManager::freeOldResources() {
-	while (MAX_MEMORY < _memoryLRU) {
-		assert(!_LRU.empty());
-		Resource *goner = *_LRU.reverse_begin();
+	while (_maxMemoryLRU < _memoryLRU) {
+		assert(_lruLast);
+		Resource *goner = _lruLast;
 		removeFromLRU(goner);
 		goner->unalloc();
 #ifdef SCI_VERBOSE_RESMAN
@@ -1060,7 +1138,7 @@ Resource *ResourceManager::findResource(ResourceId id, bool lock) {
 	if (!retval)
 		return NULL;
 
-	if (retval->_status == kResStatusNoMalloc)
+	if (retval->_status == kResStatusNoMalloc || retval->_status == kResStatusDecompressing)
 		loadResource(retval);
 	else if (retval->_status == kResStatusEnqueued)
 		removeFromLRU(retval);
@@ -1089,6 +1167,172 @@ Resource *ResourceManager::findResource(ResourceId id, bool lock) {
 	}
 }
 
+void ResourceManager::prefetchRoom(uint16 roomNumber) {
+	// Scripts, pictures and views can't tell which other resources they are
+	// going to use, but by convention, rooms use resources of the same number
+	static const ResourceType types[] = {
+		kResourceTypeScript, kResourceTypeHeap, kResourceTypePic, kResourceTypeView
+	};
+
+	_prefetchQueue.clear();
+	for (int i = 0; i < ARRAYSIZE(types); i++) {
+		ResourceId id(types[i], roomNumber);
+		Resource *res = testResource(id);
+		if (res && res->_status == kResStatusNoMalloc)
+			_prefetchQueue.push_back(id);
+	}
+}
+
+bool ResourceManager::prefetchResource() {
+	// Decompress the data read by an earlier call first. Doing the reading
+	// and the decompression in separate calls keeps each of them short.
+	if (!_decompressionJobs.empty()) {
+		Resource *res = _decompressionJobs.front()->res;
+		finishDecompression(res);
+		if (res->_status == kResStatusAllocated) {
+			addToLRU(res);
+			freeOldResources();
+		}
+		return true;
+	}
+
+	while (!_prefetchQueue.empty()) {
+		Resource *res = testResource(_prefetchQueue.front());
+		_prefetchQueue.pop_front();
+
+		// Skip resources which have been loaded in the meantime. Anything
+		// else may push older resources out of the cache, just like
+		// findResource() does, unless it doesn't fit into the cache at all.
+		// The size of resources in volumes is only known once their header
+		// has been read, so this is checked again afterwards.
+		if (!res || res->_status != kResStatusNoMalloc)
+			continue;
+		if ((int)res->size > _maxMemoryLRU)
+			continue;
+
+		// Only the reading happens here, if the resource can be decompressed
+		// separately
+		if (_backgroundDecompression && startDecompression(res)) {
+			if ((int)res->size > _maxMemoryLRU)
+				cancelDecompression(res);
+			return true;
+		}
+
+		loadResource(res);
+		if (res->_status == kResStatusAllocated) {
+			if ((int)res->size > _maxMemoryLRU) {
+				res->unalloc();
+				return true;
+			}
+			addToLRU(res);
+			freeOldResources();
+		}
+		return true;
+	}
+
+	return false;
+}
+
+bool ResourceManager::startDecompression(Resource *res) {
+	if (res->_source->getSourceType() != kSourceVolume)
+		return false;
+
+	Common::SeekableReadStream *fileStream = res->_source->getVolumeFile(this, res);
+	if (!fileStream)
+		return false;
+
+	fileStream->seek(res->_fileOffset, SEEK_SET);
+
+	uint32 szPacked = 0;
+	ResourceCompression compression = kCompUnknown;
+	Decompressor *dec = 0;
+	byte *packed = 0;
+
+	if (!res->readResourceInfo(_volVersion, fileStream, szPacked, compression) && compression != kCompNone)
+		dec = createDecompressor(compression);
+
+	if (dec) {
+		packed = new byte[szPacked];
+		if (fileStream->read(packed, szPacked) != szPacked) {
+			delete[] packed;
+			delete dec;
+			dec = 0;
+		}
+	}
+
+	if (res->_source->_resourceFile)
+		delete fileStream;
+
+	// Let the regular code handle anything unusual
+	if (!dec)
+		return false;
+
+	DecompressionJob *job = new DecompressionJob;
+	job->res = res;
+	job->dec = dec;
+	job->packed = packed;
+	job->packedSize = szPacked;
+
+	// The resource keeps this status until it has been decompressed, so that
+	// it is not queued again in the meantime
+	res->_status = kResStatusDecompressing;
+
+	_decompressionJobs.push_back(job);
+	return true;
+}
+
+DecompressionJob *ResourceManager::takeDecompressionJob(Resource *res) {
+	for (Common::List<DecompressionJob *>::iterator it = _decompressionJobs.begin(); it != _decompressionJobs.end(); ++it) {
+		if ((*it)->res == res) {
+			DecompressionJob *job = *it;
+			_decompressionJobs.erase(it);
+			return job;
+		}
+	}
+
+	return 0;
+}
+
+bool ResourceManager::finishDecompression(Resource *res) {
+	if (res->_status != kResStatusDecompressing)
+		return false;
+
+	DecompressionJob *job = takeDecompressionJob(res);
+	assert(job);
+
+	res->data = new byte[res->size];
+	Common::MemoryReadStream packedStream(job->packed, job->packedSize);
+	int errorNum = job->dec->unpack(&packedStream, res->data, job->packedSize, res->size);
+
+	delete job->dec;
+	delete[] job->packed;
+	delete job;
+
+	if (errorNum) {
+		warning("Error %d occurred while reading %s from resource file %s: %s",
+				errorNum, res->_id.toString().c_str(), res->getResourceLocation().c_str(),
+				s_errorDescriptions[errorNum]);
+		res->unalloc();
+	} else {
+		res->_status = kResStatusAllocated;
+	}
+
+	return true;
+}
+
+void ResourceManager::cancelDecompression(Resource *res) {
+	if (res->_status != kResStatusDecompressing)
+		return;
+
+	DecompressionJob *job = takeDecompressionJob(res);
+	assert(job);
+
+	delete job->dec;
+	delete[] job->packed;
+	delete job;
+	res->_status = kResStatusNoMalloc;
+}
+
 void ResourceManager::unlockResource(Resource *res) {
 	assert(res);
 
@@ -1851,6 +2095,10 @@ Resource *ResourceManager::updateResource(ResourceId resId, ResourceSource *src,
 
 	if (_resMap.contains(resId)) {
 		res = _resMap.getVal(resId);
+		if (res->_status == kResStatusEnqueued)
+			removeFromLRU(res);
+		else if (res->_status == kResStatusDecompressing)
+			cancelDecompression(res);
 	} else {
 		res = new Resource(this, resId);
 		_resMap.setVal(resId, res);
@@ -1976,35 +2224,17 @@ int Resource::decompress(ResVersion volVersion, Common::SeekableReadStream *file
 		return errorNum;
 
 	// getting a decompressor
-	Decompressor *dec = NULL;
-	switch (compression) {
-	case kCompNone:
-		dec = new Decompressor;
-		break;
-	case kCompHuffman:
-		dec = new DecompressorHuffman;
-		break;
-	case kCompLZW:
-	case kCompLZW1:
-	case kCompLZW1View:
-	case kCompLZW1Pic:
-		dec = new DecompressorLZW(compression);
-		break;
-	case kCompDCL:
-		dec = new DecompressorDCL;
-		break;
-#ifdef ENABLE_SCI32
-	case kCompSTACpack:
-		dec = new DecompressorLZS;
-		break;
-#endif
-	default:
+	Decompressor *dec = createDecompressor(compression);
+	if (!dec) {
 		error("Resource %s: Compression method %d not supported", _id.toString().c_str(), compression);
 		return SCI_ERROR_UNKNOWN_COMPRESSION;
 	}
 
 	data = new byte[size];
 	_status = kResStatusAllocated;
+
+	// If the volume is in memory, the decompressors unpack straight from
+	// there, see Decompressor::init()
 	errorNum = data ? dec->unpack(file, data, szPacked, size) : SCI_ERROR_RESOURCE_TOO_BIG;
 	if (errorNum)
 		unalloc();
@@ -2013,6 +2243,102 @@ int Resource::decompress(ResVersion volVersion, Common::SeekableReadStream *file
 	return errorNum;
 }
 
+static const char *getCompressionName(ResourceCompression compression) {
+	switch (compression) {
+	case kCompLZW:
+		return "LZW";
+	case kCompHuffman:
+		return "Huffman";
+	case kCompLZW1:
+		return "LZW1";
+	case kCompLZW1View:
+		return "LZW1 (view)";
+	case kCompLZW1Pic:
+		return "LZW1 (pic)";
+#ifdef ENABLE_SCI32
+	case kCompSTACpack:
+		return "STACpack";
+#endif
+	case kCompDCL:
+		return "DCL";
+	default:
+		return "none";
+	}
+}
+
+void ResourceManager::benchmarkDecompression(Console *con, int iterations) {
+	for (int i = kCompLZW; i <= kCompDCL; i++) {
+		ResourceCompression method = (ResourceCompression)i;
+		Common::Array<byte *> packedData;
+		Common::Array<uint32> packedSizes;
+		Common::Array<uint32> unpackedSizes;
+		uint32 maxUnpacked = 0;
+		uint32 totalUnpacked = 0;
+
+		// Read the packed data of all resources using this method first, so
+		// that only the decompression is timed
+		for (ResourceMap::iterator it = _resMap.begin(); it != _resMap.end(); ++it) {
+			ResourceSource *source = it->_value->_source;
+			if (!source || source->getSourceType() != kSourceVolume)
+				continue;
+
+			Common::SeekableReadStream *fileStream = source->getVolumeFile(this, 0);
+			if (!fileStream)
+				continue;
+
+			// Use a temporary resource, as reading the info changes the size
+			Resource info(this, it->_key);
+			uint32 szPacked = 0;
+			ResourceCompression compression = kCompUnknown;
+			fileStream->seek(it->_value->_fileOffset, SEEK_SET);
+			if (!info.readResourceInfo(_volVersion, fileStream, szPacked, compression) && compression == method) {
+				byte *packed = new byte[szPacked];
+				if (fileStream->read(packed, szPacked) == szPacked) {
+					packedData.push_back(packed);
+					packedSizes.push_back(szPacked);
+					unpackedSizes.push_back(info.size);
+					maxUnpacked = MAX(maxUnpacked, info.size);
+					totalUnpacked += info.size;
+				} else {
+					delete[] packed;
+				}
+			}
+
+			if (source->_resourceFile)
+				delete fileStream;
+		}
+
+		if (packedData.empty())
+			continue;
+
+		Decompressor *dec = createDecompressor(method);
+		byte *unpacked = new byte[maxUnpacked];
+		int errors = 0;
+
+		uint32 startTime = g_system->getMillis();
+		for (int j = 0; j < iterations; j++) {
+			for (uint k = 0; k < packedData.size(); k++) {
+				Common::MemoryReadStream packedStream(packedData[k], packedSizes[k]);
+				if (dec->unpack(&packedStream, unpacked, packedSizes[k], unpackedSizes[k]))
+					errors++;
+			}
+		}
+		uint32 elapsed = MAX<uint32>(g_system->getMillis() - startTime, 1);
+
+		con->DebugPrintf("%s: %d resources, %d KB unpacked, %d ms, %.2f MB/s", getCompressionName(method),
+			packedData.size(), totalUnpacked / 1024, elapsed,
+			(double)totalUnpacked * iterations / (1024 * 1024) / elapsed * 1000);
+		if (errors)
+			con->DebugPrintf(", %d errors", errors);
+		con->DebugPrintf("\n");
+
+		delete[] unpacked;
+		delete dec;
+		for (uint k = 0; k < packedData.size(); k++)
+			delete[] packedData[k];
+	}
+}
+
 ResourceCompression ResourceManager::getViewCompression() {
 	int viewsTested = 0;
 
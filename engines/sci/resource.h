@@ -51,7 +51,8 @@ enum ResourceStatus {
 	kResStatusNoMalloc = 0,
 	kResStatusAllocated,
 	kResStatusEnqueued, /**< In the LRU queue */
-	kResStatusLocked /**< Allocated and in use */
+	kResStatusLocked, /**< Allocated and in use */
+	kResStatusDecompressing /**< Not allocated yet, packed data read by prefetchResource() */
 };
 
 /** Resource error codes. Should be in sync with s_errorDescriptions */
@@ -129,6 +130,7 @@ enum ResVersion {
 	kResVersionSci3
 };
 
+class Console;
 class ResourceManager;
 class ResourceSource;
 
@@ -240,6 +242,8 @@ protected:
 	int32 _fileOffset; /**< Offset in file */
 	ResourceStatus _status;
 	uint16 _lockers; /**< Number of places where this resource was locked */
+	Resource *_lruPrev; /**< Next more recently used resource in the LRU list */
+	Resource *_lruNext; /**< Next less recently used resource in the LRU list */
 	ResourceSource *_source;
 	ResourceManager *_resMan;
 
@@ -254,6 +258,8 @@ protected:
 
 typedef Common::HashMap<ResourceId, Resource *, ResourceIdHash> ResourceMap;
 
+struct DecompressionJob;
+
 class ResourceManager {
 	// FIXME: These 'friend' declarations are meant to be a temporary hack to
 	// ease transition to the ResourceSource class system.
@@ -296,6 +302,25 @@ public:
 	 */
 	Resource *findResource(ResourceId id, bool lock);
 
+	/**
+	 * Queues the resources which are known to belong to a room (its script,
+	 * heap, picture and view), so that they can be loaded by prefetchResource()
+	 * before they are actually needed.
+	 * @param roomNumber	The number of the room
+	 */
+	void prefetchRoom(uint16 roomNumber);
+
+	/**
+	 * Loads the next resource queued by prefetchRoom() and puts it under LRU
+	 * control. This is meant to be called when the engine is idle. With the
+	 * "sci_background_decompression" option, reading a resource and
+	 * decompressing it are done by separate calls, so each call takes less
+	 * time.
+	 * @return true if a resource has been loaded, false if there was nothing
+	 *         left to do
+	 */
+	bool prefetchResource();
+
 	/**
 	 * Unlocks a previously locked resource.
 	 * @param res	The resource to free
@@ -334,6 +359,14 @@ public:
 	const char *getVolVersionDesc() const { return versionDescription(_volVersion); }
 	ResVersion getVolVersion() const { return _volVersion; }
 
+	/**
+	 * Decompresses all compressed resources of the game's volumes a number
+	 * of times and prints the throughput of each compression method.
+	 * @param con			The console to print to
+	 * @param iterations	How often each resource is decompressed
+	 */
+	void benchmarkDecompression(Console *con, int iterations);
+
 	/**
 	 * Adds the appropriate GM patch from the Sierra MIDI utility as 4.pat, without
 	 * requiring the user to rename the file to 4.pat. Thus, the original Sierra
@@ -379,19 +412,26 @@ public:
 	ResourceType convertResType(byte type);
 
 protected:
-	// Maximum number of bytes to allow being allocated for resources
-	// Note: maxMemory will not be interpreted as a hard limit, only as a restriction
-	// for resources which are not explicitly locked. However, a warning will be
-	// issued whenever this limit is exceeded.
+	// Default number of bytes to allow being allocated for resources, can be
+	// changed with the "sci_resource_cache_size" config key (in KB).
+	// Note: this will not be interpreted as a hard limit, only as a restriction
+	// for resources which are not explicitly locked.
 	enum {
-		MAX_MEMORY = 256 * 1024	// 256KB
+		DEFAULT_MAX_MEMORY = 4 * 1024 * 1024,	// 4MB
+		MIN_MAX_MEMORY = 256 * 1024,	// 256KB, the size used before it became configurable
+		MAX_MAX_MEMORY = 1024 * 1024 * 1024	// 1GB, keeps the byte count within an int
 	};
 
 	ViewType _viewType; // Used to determine if the game has EGA or VGA graphics
 	Common::List<ResourceSource *> _sources;
 	int _memoryLocked;	///< Amount of resource bytes in locked memory
 	int _memoryLRU;		///< Amount of resource bytes under LRU control
-	Common::List<Resource *> _LRU; ///< Last Resource Used list
+	int _maxMemoryLRU;	///< Amount of resource bytes kept under LRU control at most
+	Resource *_lruFirst;	///< Most recently used resource under LRU control
+	Resource *_lruLast;	///< Least recently used resource under LRU control
+	Common::List<ResourceId> _prefetchQueue; ///< Resources to load when idle
+	bool _backgroundDecompression; ///< Read and decompress prefetched resources in separate idle calls
+	Common::List<DecompressionJob *> _decompressionJobs; ///< Prefetched resources which are still packed
 	ResourceMap _resMap;
 	Common::List<Common::File *> _volumeFiles; ///< list of opened volume files
 	ResourceSource *_audioMapSCI1; ///< Currently loaded audio map for SCI1
@@ -446,6 +486,32 @@ protected:
 	Common::SeekableReadStream *getVolumeFile(ResourceSource *source);
 	void loadResource(Resource *res);
 	void freeOldResources();
+
+	/**
+	 * Reads the packed data of a resource, which the next call of
+	 * prefetchResource() decompresses. Only resources in volumes are supported.
+	 * @return true if the resource will be decompressed later on
+	 */
+	bool startDecompression(Resource *res);
+
+	/**
+	 * Decompresses a resource passed to startDecompression().
+	 * @return false if the packed data of the resource hasn't been read that way
+	 */
+	bool finishDecompression(Resource *res);
+
+	/**
+	 * Drops the packed data of a resource which is about to be replaced or
+	 * removed.
+	 */
+	void cancelDecompression(Resource *res);
+
+	/**
+	 * Removes the job of a resource from the decompression queue.
+	 * @return the job, or NULL if the resource isn't queued
+	 */
+	DecompressionJob *takeDecompressionJob(Resource *res);
+
 	void addResource(ResourceId resId, ResourceSource *src, uint32 offset, uint32 size = 0);
 	Resource *updateResource(ResourceId resId, ResourceSource *src, uint32 size);
 	void removeAudioResource(ResourceId resId);
@@ -214,6 +214,8 @@ void ResourceManager::removeAudioResource(ResourceId resId) {
 			} else {
 				if (res->_status == kResStatusEnqueued)
 					removeFromLRU(res);
+				else if (res->_status == kResStatusDecompressing)
+					cancelDecompression(res);
 
 				_resMap.erase(resId);
 				delete res;
@@ -571,7 +571,41 @@ bool ScummEngine::checkXYInBoxBounds(int boxnum, int x, int y) {
 	return true;
 }
 
+void ScummEngine::invalidateWalkGraph() {
+	if (_walkGraph)
+		_walkGraph->clear();
+}
+
+void ScummEngine::buildWalkGraph() {
+	if (_walkGraph->numBoxes != -1)
+		return;
+
+	const int num = getNumBoxes();
+
+	_walkGraph->coords.resize(num);
+	for (int i = 0; i < num; i++)
+		_walkGraph->coords[i] = readBoxCoordinates(i);
+
+	_walkGraph->nextBox.resize(num * num);
+	_walkGraph->clearRoutes();
+
+	_walkGraph->portals.resize(num * num);
+	for (int i = 0; i < num * num; i++)
+		_walkGraph->portals[i].type = BoxPortal::kUnknown;
+
+	_walkGraph->numBoxes = num;
+}
+
 BoxCoords ScummEngine::getBoxCoordinates(int boxnum) {
+	buildWalkGraph();
+
+	if (boxnum >= 0 && boxnum < _walkGraph->numBoxes)
+		return _walkGraph->coords[boxnum];
+
+	return readBoxCoordinates(boxnum);
+}
+
+BoxCoords ScummEngine::readBoxCoordinates(int boxnum) {
 	BoxCoords tmp, *box = &tmp;
 	Box *bp = getBoxBaseAddr(boxnum);
 	assert(bp);
@@ -699,10 +733,7 @@ byte *ScummEngine::getBoxMatrixBaseAddr() {
  * If there is no connection -1 is return.
  */
 int ScummEngine::getNextBox(byte from, byte to) {
-	const byte *boxm;
-	byte i;
 	const int numOfBoxes = getNumBoxes();
-	int dest = -1;
 
 	if (from == to)
 		return to;
@@ -716,6 +747,25 @@ int ScummEngine::getNextBox(byte from, byte to) {
 	assert(from < numOfBoxes);
 	assert(to < numOfBoxes);
 
+	buildWalkGraph();
+
+	int16 &dest = _walkGraph->nextBox[numOfBoxes * from + to];
+	if (dest == WalkGraph::kUnknownNextBox) {
+		_walkGraph->nextBoxMisses++;
+		dest = calcNextBox(from, to);
+	} else {
+		_walkGraph->nextBoxHits++;
+	}
+
+	return dest;
+}
+
+int ScummEngine::calcNextBox(byte from, byte to) {
+	const byte *boxm;
+	byte i;
+	const int numOfBoxes = getNumBoxes();
+	int dest = -1;
+
 	boxm = getBoxMatrixBaseAddr();
 
 	if (_game.version == 0) {
@@ -780,18 +830,35 @@ int ScummEngine::getNextBox(byte from, byte to) {
 	return dest;
 }
 
+BoxPortal ScummEngine::getBoxPortal(byte box1nr, byte box2nr) {
+	buildWalkGraph();
+
+	if (box1nr >= _walkGraph->numBoxes || box2nr >= _walkGraph->numBoxes)
+		return calcBoxPortal(box1nr, box2nr);
+
+	BoxPortal &portal = _walkGraph->portals[_walkGraph->numBoxes * box1nr + box2nr];
+	if (portal.type == BoxPortal::kUnknown) {
+		_walkGraph->portalMisses++;
+		portal = calcBoxPortal(box1nr, box2nr);
+	} else {
+		_walkGraph->portalHits++;
+	}
+
+	return portal;
+}
+
 /*
- * Computes the next point actor a has to walk towards in a straight
- * line in order to get from box1 to box3 via box2.
+ * Searches the sides of box1 and box2 for the first pair which lies on a
+ * common vertical or horizontal line and overlaps, i.e. the gate through
+ * which an actor walks from box1 into box2.
  */
-bool Actor::findPathTowards(byte box1nr, byte box2nr, byte box3nr, Common::Point &foundPath) {
-	assert(_vm->_game.version >= 3);
-	BoxCoords box1 = _vm->getBoxCoordinates(box1nr);
-	BoxCoords box2 = _vm->getBoxCoordinates(box2nr);
+BoxPortal ScummEngine::calcBoxPortal(byte box1nr, byte box2nr) {
+	BoxCoords box1 = getBoxCoordinates(box1nr);
+	BoxCoords box2 = getBoxCoordinates(box2nr);
 	Common::Point tmp;
+	BoxPortal portal;
 	int i, j;
 	int flag;
-	int q, pos;
 
 	for (i = 0; i < 4; i++) {
 		for (j = 0; j < 4; j++) {
@@ -815,38 +882,13 @@ bool Actor::findPathTowards(byte box1nr, byte box2nr, byte box3nr, Common::Point
 					if (flag & 2)
 						SWAP(box2.ul.y, box2.ur.y);
 				} else {
-					pos = _pos.y;
-					if (box2nr == box3nr) {
-						int diffX = _walkdata.dest.x - _pos.x;
-						int diffY = _walkdata.dest.y - _pos.y;
-						int boxDiffX = box1.ul.x - _pos.x;
-
-						if (diffX != 0) {
-							int t;
-
-							diffY *= boxDiffX;
-							t = diffY / diffX;
-							if (t == 0 && (diffY <= 0 || diffX <= 0)
-									&& (diffY >= 0 || diffX >= 0))
-								t = -1;
-							pos = _pos.y + t;
-						}
-					}
-
-					q = pos;
-					if (q < box2.ul.y)
-						q = box2.ul.y;
-					if (q > box2.ur.y)
-						q = box2.ur.y;
-					if (q < box1.ul.y)
-						q = box1.ul.y;
-					if (q > box1.ur.y)
-						q = box1.ur.y;
-					if (q == pos && box2nr == box3nr)
-						return true;
-					foundPath.y = q;
-					foundPath.x = box1.ul.x;
-					return false;
+					portal.type = BoxPortal::kVertical;
+					portal.line = box1.ul.x;
+					portal.min1 = box1.ul.y;
+					portal.max1 = box1.ur.y;
+					portal.min2 = box2.ul.y;
+					portal.max2 = box2.ur.y;
+					return portal;
 				}
 			}
 
@@ -870,34 +912,13 @@ bool Actor::findPathTowards(byte box1nr, byte box2nr, byte box3nr, Common::Point
 					if (flag & 2)
 						SWAP(box2.ul.x, box2.ur.x);
 				} else {
-
-					if (box2nr == box3nr) {
-						int diffX = _walkdata.dest.x - _pos.x;
-						int diffY = _walkdata.dest.y - _pos.y;
-						int boxDiffY = box1.ul.y - _pos.y;
-
-						pos = _pos.x;
-						if (diffY != 0) {
-							pos += diffX * boxDiffY / diffY;
-						}
-					} else {
-						pos = _pos.x;
-					}
-
-					q = pos;
-					if (q < box2.ul.x)
-						q = box2.ul.x;
-					if (q > box2.ur.x)
-						q = box2.ur.x;
-					if (q < box1.ul.x)
-						q = box1.ul.x;
-					if (q > box1.ur.x)
-						q = box1.ur.x;
-					if (q == pos && box2nr == box3nr)
-						return true;
-					foundPath.x = q;
-					foundPath.y = box1.ul.y;
-					return false;
+					portal.type = BoxPortal::kHorizontal;
+					portal.line = box1.ul.y;
+					portal.min1 = box1.ul.x;
+					portal.max1 = box1.ur.x;
+					portal.min2 = box2.ul.x;
+					portal.max2 = box2.ur.x;
+					return portal;
 				}
 			}
 			tmp = box1.ul;
@@ -912,6 +933,86 @@ bool Actor::findPathTowards(byte box1nr, byte box2nr, byte box3nr, Common::Point
 		box2.lr = box2.ll;
 		box2.ll = tmp;
 	}
+
+	portal.type = BoxPortal::kNone;
+	portal.line = portal.min1 = portal.max1 = portal.min2 = portal.max2 = 0;
+	return portal;
+}
+
+/*
+ * Computes the next point actor a has to walk towards in a straight
+ * line in order to get from box1 to box3 via box2.
+ */
+bool Actor::findPathTowards(byte box1nr, byte box2nr, byte box3nr, Common::Point &foundPath) {
+	assert(_vm->_game.version >= 3);
+	const BoxPortal portal = _vm->getBoxPortal(box1nr, box2nr);
+	int q, pos;
+
+	if (portal.type == BoxPortal::kVertical) {
+		pos = _pos.y;
+		if (box2nr == box3nr) {
+			int diffX = _walkdata.dest.x - _pos.x;
+			int diffY = _walkdata.dest.y - _pos.y;
+			int boxDiffX = portal.line - _pos.x;
+
+			if (diffX != 0) {
+				int t;
+
+				diffY *= boxDiffX;
+				t = diffY / diffX;
+				if (t == 0 && (diffY <= 0 || diffX <= 0)
+						&& (diffY >= 0 || diffX >= 0))
+					t = -1;
+				pos = _pos.y + t;
+			}
+		}
+
+		q = pos;
+		if (q < portal.min2)
+			q = portal.min2;
+		if (q > portal.max2)
+			q = portal.max2;
+		if (q < portal.min1)
+			q = portal.min1;
+		if (q > portal.max1)
+			q = portal.max1;
+		if (q == pos && box2nr == box3nr)
+			return true;
+		foundPath.y = q;
+		foundPath.x = portal.line;
+		return false;
+	}
+
+	if (portal.type == BoxPortal::kHorizontal) {
+		if (box2nr == box3nr) {
+			int diffX = _walkdata.dest.x - _pos.x;
+			int diffY = _walkdata.dest.y - _pos.y;
+			int boxDiffY = portal.line - _pos.y;
+
+			pos = _pos.x;
+			if (diffY != 0) {
+				pos += diffX * boxDiffY / diffY;
+			}
+		} else {
+			pos = _pos.x;
+		}
+
+		q = pos;
+		if (q < portal.min2)
+			q = portal.min2;
+		if (q > portal.max2)
+			q = portal.max2;
+		if (q < portal.min1)
+			q = portal.min1;
+		if (q > portal.max1)
+			q = portal.max1;
+		if (q == pos && box2nr == box3nr)
+			return true;
+		foundPath.x = q;
+		foundPath.y = portal.line;
+		return false;
+	}
+
 	return false;
 }
 
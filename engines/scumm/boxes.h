@@ -23,6 +23,7 @@
 #ifndef SCUMM_BOXES_H
 #define SCUMM_BOXES_H
 
+#include "common/array.h"
 #include "common/rect.h"
 
 namespace Scumm {
@@ -49,6 +50,61 @@ struct BoxCoords {			/* Box coordinates */
 	Common::Point lr;
 };
 
+/**
+ * The shared edge between two neighboring boxes, as used by
+ * Actor::findPathTowards. The edge lies on the vertical line x = 'line'
+ * or the horizontal line y = 'line'; walking through it is clipped to
+ * the extent of the edge in the second box, then in the first box.
+ */
+struct BoxPortal {
+	enum Type {
+		kUnknown,
+		kNone,
+		kVertical,
+		kHorizontal
+	};
+
+	byte type;
+	int16 line;
+	int16 min1, max1;
+	int16 min2, max2;
+};
+
+/**
+ * Walking data derived from the box resources of the current room. It
+ * is filled lazily while actors walk and thrown away whenever the box
+ * resources change.
+ */
+struct WalkGraph {
+	enum {
+		kUnknownNextBox = -2
+	};
+
+	int numBoxes;	///< number of boxes covered, -1 if not built yet
+	Common::Array<BoxCoords> coords;
+	Common::Array<int16> nextBox;	///< numBoxes x numBoxes, see ScummEngine::getNextBox
+	Common::Array<BoxPortal> portals;	///< numBoxes x numBoxes
+
+	uint32 nextBoxHits, nextBoxMisses;
+	uint32 portalHits, portalMisses;
+
+	WalkGraph() { clear(); }
+
+	void clear() {
+		numBoxes = -1;
+		coords.clear();
+		nextBox.clear();
+		portals.clear();
+		nextBoxHits = nextBoxMisses = 0;
+		portalHits = portalMisses = 0;
+	}
+
+	void clearRoutes() {
+		for (uint i = 0; i < nextBox.size(); i++)
+			nextBox[i] = kUnknownNextBox;
+	}
+};
+
 int getClosestPtOnBox(const BoxCoords &box, int x, int y, int16& outX, int16& outY);
 
 } // End of namespace Scumm
@@ -30,10 +30,15 @@
 #include "scumm/boxes.h"
 #include "scumm/debugger.h"
 #include "scumm/imuse/imuse.h"
+#ifdef ENABLE_SCUMM_7_8
+#include "scumm/imuse_digi/dimuse.h"
+#endif
 #include "scumm/object.h"
 #include "scumm/resource.h"
 #include "scumm/scumm.h"
+#include "scumm/scumm_v7.h"
 #include "scumm/sound.h"
+#include "scumm/smush/smush_player.h"
 
 namespace Scumm {
 
@@ -71,6 +76,7 @@ ScummDebugger::ScummDebugger(ScummEngine *s)
 	DCmd_Register("actors",    WRAP_METHOD(ScummDebugger, Cmd_PrintActor));
 	DCmd_Register("box",       WRAP_METHOD(ScummDebugger, Cmd_PrintBox));
 	DCmd_Register("matrix",    WRAP_METHOD(ScummDebugger, Cmd_PrintBoxMatrix));
+	DCmd_Register("walkgraph", WRAP_METHOD(ScummDebugger, Cmd_PrintWalkGraph));
 	DCmd_Register("camera",    WRAP_METHOD(ScummDebugger, Cmd_Camera));
 	DCmd_Register("room",      WRAP_METHOD(ScummDebugger, Cmd_Room));
 	DCmd_Register("objects",   WRAP_METHOD(ScummDebugger, Cmd_PrintObjects));
@@ -98,6 +104,15 @@ ScummDebugger::ScummDebugger(ScummEngine *s)
 	DCmd_Register("imuse",     WRAP_METHOD(ScummDebugger, Cmd_IMuse));
 
 	DCmd_Register("resetcursors",    WRAP_METHOD(ScummDebugger, Cmd_ResetCursors));
+
+	DCmd_Register("stripbench",      WRAP_METHOD(ScummDebugger, Cmd_StripBench));
+
+#ifdef ENABLE_SCUMM_7_8
+	if (_vm->_game.version >= 7) {
+		DCmd_Register("smushbench",  WRAP_METHOD(ScummDebugger, Cmd_SmushBench));
+		DCmd_Register("imuseblocks", WRAP_METHOD(ScummDebugger, Cmd_IMuseBlocks));
+	}
+#endif
 }
 
 ScummDebugger::~ScummDebugger() {
@@ -592,6 +607,45 @@ bool ScummDebugger::Cmd_PrintBoxMatrix(int argc, const char **argv) {
 	return true;
 }
 
+bool ScummDebugger::Cmd_PrintWalkGraph(int argc, const char **argv) {
+	const WalkGraph &graph = *_vm->_walkGraph;
+
+	if (graph.numBoxes == -1) {
+		DebugPrintf("The walk graph of room %d has not been built yet\n", _vm->_currentRoom);
+		return true;
+	}
+
+	const int num = graph.numBoxes;
+	int routes = 0, portals = 0, gates = 0;
+	for (int i = 0; i < num * num; i++) {
+		if (graph.nextBox[i] != WalkGraph::kUnknownNextBox)
+			routes++;
+		if (graph.portals[i].type != BoxPortal::kUnknown)
+			portals++;
+		if (graph.portals[i].type == BoxPortal::kVertical || graph.portals[i].type == BoxPortal::kHorizontal)
+			gates++;
+	}
+
+	DebugPrintf("Walk graph of room %d: %d boxes\n", _vm->_currentRoom, num);
+	DebugPrintf("Routes: %d of %d known, %d hits, %d misses\n", routes, num * num, graph.nextBoxHits, graph.nextBoxMisses);
+	DebugPrintf("Portals: %d of %d known (%d gates), %d hits, %d misses\n", portals, num * num, gates, graph.portalHits, graph.portalMisses);
+
+	// List the gates found so far
+	if (argc > 1 && !strcmp(argv[1], "portals")) {
+		for (int i = 0; i < num; i++) {
+			for (int j = 0; j < num; j++) {
+				const BoxPortal &portal = graph.portals[num * i + j];
+				if (portal.type == BoxPortal::kVertical)
+					DebugPrintf("%d -> %d: x = %d, y = [%d, %d] / [%d, %d]\n", i, j, portal.line, portal.min1, portal.max1, portal.min2, portal.max2);
+				else if (portal.type == BoxPortal::kHorizontal)
+					DebugPrintf("%d -> %d: y = %d, x = [%d, %d] / [%d, %d]\n", i, j, portal.line, portal.min1, portal.max1, portal.min2, portal.max2);
+			}
+		}
+	}
+
+	return true;
+}
+
 void ScummDebugger::printBox(int box) {
 	if (box < 0 || box >= _vm->getNumBoxes()) {
 		DebugPrintf("%d is not a valid box!\n", box);
@@ -868,4 +922,122 @@ bool ScummDebugger::Cmd_ResetCursors(int argc, const char **argv) {
 	return false;
 }
 
+bool ScummDebugger::Cmd_StripBench(int argc, const char **argv) {
+	if (_vm->_game.version < 5 || _vm->_game.version > 7 || _vm->_game.heversion || _vm->_bytesPerPixel != 1) {
+		DebugPrintf("The strip decoder benchmark only supports v5-v7 games\n");
+		return true;
+	}
+
+	int iterations = (argc > 1) ? atoi(argv[1]) : 1;
+	if (iterations < 1)
+		iterations = 1;
+
+	int rooms = 0, strips = 0, mismatches = 0;
+	uint32 bitwiseTime = 0, runTime = 0;
+
+	// Decode the background of every room, with both the bitwise and the
+	// run based decoders
+	for (ResId room = 1; room < _vm->_res->_types[rtRoom].size(); room++) {
+		if (!_vm->_res->_types[rtRoom][room]._roomno || _vm->_res->_types[rtRoom][room]._roomoffs == RES_INVALID_OFFSET)
+			continue;
+
+		const bool wasLoaded = _vm->_res->isResourceLoaded(rtRoom, room);
+		const byte *roomptr = _vm->getResourceAddress(rtRoom, room);
+		if (!roomptr)
+			continue;
+
+		const RoomHeader *rmhd = (const RoomHeader *)_vm->findResourceData(MKTAG('R','M','H','D'), roomptr);
+		const byte *rmim = _vm->findResource(MKTAG('R','M','I','M'), roomptr);
+		const byte *im00 = rmim ? _vm->findResource(MKTAG('I','M','0','0'), rmim) : 0;
+		const byte *smap = im00 ? _vm->findResource(MKTAG('S','M','A','P'), im00) : 0;
+		if (rmhd && smap) {
+			int width, height;
+			if (_vm->_game.version == 7) {
+				width = READ_LE_UINT16(&rmhd->v7.width);
+				height = READ_LE_UINT16(&rmhd->v7.height);
+			} else {
+				width = READ_LE_UINT16(&rmhd->old.width);
+				height = READ_LE_UINT16(&rmhd->old.height);
+			}
+
+			const int numStrips = width / 8;
+			if (numStrips > 0 && height > 0) {
+				byte *bitwise = new byte[numStrips * 8 * height];
+				byte *runs = new byte[numStrips * 8 * height];
+
+				for (int i = 0; i < iterations; i++) {
+					memset(bitwise, 0, numStrips * 8 * height);
+					memset(runs, 0, numStrips * 8 * height);
+					bitwiseTime += _vm->_gdi->decompressImage(smap, numStrips, height, bitwise, false);
+					runTime += _vm->_gdi->decompressImage(smap, numStrips, height, runs, true);
+				}
+
+				if (memcmp(bitwise, runs, numStrips * 8 * height)) {
+					DebugPrintf("Room %d decodes differently\n", room);
+					mismatches++;
+				}
+
+				delete[] bitwise;
+				delete[] runs;
+				rooms++;
+				strips += numStrips;
+			}
+		}
+
+		if (!wasLoaded && room != _vm->_roomResource)
+			_vm->_res->nukeResource(rtRoom, room);
+	}
+
+	DebugPrintf("Decoded %d strips in %d rooms %d times\n", strips, rooms, iterations);
+	DebugPrintf("Bitwise decoders: %d ms, run based decoders: %d ms, %d rooms differ\n", bitwiseTime, runTime, mismatches);
+	return true;
+}
+
+#ifdef ENABLE_SCUMM_7_8
+bool ScummDebugger::Cmd_SmushBench(int argc, const char **argv) {
+	if (argc < 2) {
+		DebugPrintf("Syntax: smushbench <file.san>\n");
+		return true;
+	}
+
+	int frames;
+	uint32 readTime, decodeTime;
+	if (!((ScummEngine_v7 *)_vm)->_splayer->benchmark(argv[1], frames, readTime, decodeTime)) {
+		DebugPrintf("Unable to open %s\n", argv[1]);
+		return true;
+	}
+
+	DebugPrintf("Read %d frames in %d ms and decoded them in %d ms", frames, readTime, decodeTime);
+	if (decodeTime)
+		DebugPrintf(" (%d frames per second)", frames * 1000 / decodeTime);
+	DebugPrintf("\n");
+	return true;
+}
+
+bool ScummDebugger::Cmd_IMuseBlocks(int argc, const char **argv) {
+	if (!_vm->_imuseDigital) {
+		DebugPrintf("This game does not use Digital iMUSE\n");
+		return true;
+	}
+
+	if (argc > 1 && !strcmp(argv[1], "reset")) {
+		_vm->_imuseDigital->resetBundleBlockStats();
+		DebugPrintf("Reset the bundle block counters\n");
+		return true;
+	} else if (argc > 1) {
+		DebugPrintf("Syntax: imuseblocks [reset]\n");
+		return true;
+	}
+
+	const BundleBlockStats stats = _vm->_imuseDigital->getBundleBlockStats();
+	const uint32 requested = stats.hits + stats.misses;
+
+	DebugPrintf("Requested %d bundle blocks, %d of them already decoded", requested, stats.hits);
+	if (requested)
+		DebugPrintf(" (%d%%)", stats.hits * 100 / requested);
+	DebugPrintf("\n%d blocks decoded ahead\n", stats.readAhead);
+	return true;
+}
+#endif
+
 } // End of namespace Scumm
@@ -46,6 +46,7 @@ private:
 	bool Cmd_PrintActor(int argc, const char **argv);
 	bool Cmd_PrintBox(int argc, const char **argv);
 	bool Cmd_PrintBoxMatrix(int argc, const char **argv);
+	bool Cmd_PrintWalkGraph(int argc, const char **argv);
 	bool Cmd_PrintObjects(int argc, const char **argv);
 	bool Cmd_Actor(int argc, const char **argv);
 	bool Cmd_Camera(int argc, const char **argv);
@@ -67,6 +68,12 @@ private:
 
 	bool Cmd_ResetCursors(int argc, const char **argv);
 
+	bool Cmd_StripBench(int argc, const char **argv);
+#ifdef ENABLE_SCUMM_7_8
+	bool Cmd_SmushBench(int argc, const char **argv);
+	bool Cmd_IMuseBlocks(int argc, const char **argv);
+#endif
+
 	void printBox(int box);
 	void drawBox(int box);
 };
@@ -214,22 +214,33 @@ Gdi::Gdi(ScummEngine *vm) : _vm(vm) {
 	_zbufferDisabled = false;
 	_objectMode = false;
 	_distaff = false;
+
+	_bgStripsPtr = 0;
+	_bgStripsHeight = 0;
+	_bgStripsNumZBuf = 0;
+	memset(_bgStripsPalette, 0, sizeof(_bgStripsPalette));
+	_bgStripsEnabled = true;
+	_fastStripDecoders = true;
 }
 
 Gdi::~Gdi() {
+	purgeBackgroundStrips();
 }
 
 GdiHE::GdiHE(ScummEngine *vm) : Gdi(vm), _tmskPtr(0) {
+	_bgStripsEnabled = false;
 }
 
 
 GdiNES::GdiNES(ScummEngine *vm) : Gdi(vm) {
 	memset(&_NES, 0, sizeof(_NES));
+	_bgStripsEnabled = false;
 }
 
 #ifdef USE_RGB_COLOR
 GdiPCEngine::GdiPCEngine(ScummEngine *vm) : Gdi(vm) {
 	memset(&_PCE, 0, sizeof(_PCE));
+	_bgStripsEnabled = false;
 }
 
 GdiPCEngine::~GdiPCEngine() {
@@ -241,10 +252,12 @@ GdiPCEngine::~GdiPCEngine() {
 
 GdiV1::GdiV1(ScummEngine *vm) : Gdi(vm) {
 	memset(&_V1, 0, sizeof(_V1));
+	_bgStripsEnabled = false;
 }
 
 GdiV2::GdiV2(ScummEngine *vm) : Gdi(vm) {
 	_roomStrips = 0;
+	_bgStripsEnabled = false;
 }
 
 GdiV2::~GdiV2() {
@@ -274,6 +287,7 @@ void Gdi::init() {
 }
 
 void Gdi::roomChanged(byte *roomptr) {
+	purgeBackgroundStrips();
 }
 
 void GdiNES::roomChanged(byte *roomptr) {
@@ -1007,7 +1021,7 @@ void ScummEngine::redrawBGStrip(int start, int num) {
 	else
 		room = getResourceAddress(rtRoom, _roomResource);
 
-	_gdi->drawBitmap(room + _IM00_offs, &_virtscr[kMainVirtScreen], s, 0, _roomWidth, _virtscr[kMainVirtScreen].h, s, num, 0);
+	_gdi->drawBitmap(room + _IM00_offs, &_virtscr[kMainVirtScreen], s, 0, _roomWidth, _virtscr[kMainVirtScreen].h, s, num, Gdi::dbRoomBackground);
 }
 
 void ScummEngine::restoreBackground(Common::Rect rect, byte backColor) {
@@ -1815,6 +1829,21 @@ void Gdi::drawBitmap(const byte *ptr, VirtScreen *vs, int x, const int y, const
 		limit = numstrip;
 	if (limit > _numStrips - sx)
 		limit = _numStrips - sx;
+
+	// The decoded room background only depends on the room image and the
+	// room palette, so its strips can be reused when scrolling or redrawing
+	// dirty strips, until the room changes.
+	const bool useBgStrips = _bgStripsEnabled && (flag & dbRoomBackground) && y == 0
+		&& vs->number == kMainVirtScreen && vs->format.bytesPerPixel == 1;
+	if (useBgStrips && (ptr != _bgStripsPtr || height != _bgStripsHeight || numzbuf != _bgStripsNumZBuf
+			|| memcmp(_bgStripsPalette, _vm->_roomPalette, sizeof(_bgStripsPalette)))) {
+		purgeBackgroundStrips();
+		_bgStripsPtr = ptr;
+		_bgStripsHeight = height;
+		_bgStripsNumZBuf = numzbuf;
+		memcpy(_bgStripsPalette, _vm->_roomPalette, sizeof(_bgStripsPalette));
+	}
+
 	for (int k = 0; k < limit; ++k, ++stripnr, ++sx, ++x) {
 		if (y < vs->tdirty[sx])
 			vs->tdirty[sx] = y;
@@ -1829,7 +1858,19 @@ void Gdi::drawBitmap(const byte *ptr, VirtScreen *vs, int x, const int y, const
 		else
 			dstPtr = (byte *)vs->pixels + y * vs->pitch + (x * 8 * vs->format.bytesPerPixel);
 
-		transpStrip = drawStrip(dstPtr, vs, x, y, width, height, stripnr, smap_ptr);
+		const byte *bgStrip = 0;
+		if (useBgStrips && stripnr < (int)_bgStrips.size())
+			bgStrip = _bgStrips[stripnr];
+
+		if (bgStrip) {
+			byte *dst = dstPtr;
+			for (int h = 0; h < height; h++, dst += vs->pitch, bgStrip += 8)
+				memcpy(dst, bgStrip, 8);
+			transpStrip = false;
+		} else {
+			transpStrip = drawStrip(dstPtr, vs, x, y, width, height, stripnr, smap_ptr);
+		}
+		const bool opaqueStrip = !transpStrip;
 
 		// COMI and HE games only uses flag value
 		if (_vm->_game.version == 8 || _vm->_game.heversion >= 60)
@@ -1843,7 +1884,22 @@ void Gdi::drawBitmap(const byte *ptr, VirtScreen *vs, int x, const int y, const
 				clear8Col(frontBuf, vs->pitch, height, vs->format.bytesPerPixel);
 		}
 
-		decodeMask(x, y, width, height, stripnr, numzbuf, zplane_list, transpStrip, flag);
+		if (bgStrip) {
+			for (int i = 1; i < numzbuf; i++, bgStrip += height) {
+				if (!zplane_list[i])
+					continue;
+				byte *mask_ptr = getMaskBuffer(x, y, i);
+				for (int h = 0; h < height; h++)
+					mask_ptr[h * _numStrips] = bgStrip[h];
+			}
+		} else {
+			decodeMask(x, y, width, height, stripnr, numzbuf, zplane_list, transpStrip, flag);
+
+			// Strips with transparent pixels keep parts of what was drawn
+			// before, so only opaque ones are worth remembering
+			if (useBgStrips && opaqueStrip)
+				storeBackgroundStrip(stripnr, dstPtr, vs->pitch, x, height, numzbuf, zplane_list);
+		}
 
 #if 0
 		// HACK: blit mask(s) onto normal screen. Useful to debug masking
@@ -1871,8 +1927,35 @@ void Gdi::drawBitmap(const byte *ptr, VirtScreen *vs, int x, const int y, const
 	}
 }
 
-bool Gdi::drawStrip(byte *dstPtr, VirtScreen *vs, int x, int y, const int width, const int height,
-					int stripnr, const byte *smap_ptr) {
+void Gdi::storeBackgroundStrip(int stripnr, const byte *src, int srcPitch, int x, int height,
+					int numzbuf, const byte *zplane_list[9]) {
+	if (stripnr >= (int)_bgStrips.size())
+		_bgStrips.resize(stripnr + 1);
+	assert(!_bgStrips[stripnr]);
+
+	byte *dst = new byte[8 * height + (numzbuf - 1) * height];
+	_bgStrips[stripnr] = dst;
+
+	for (int h = 0; h < height; h++, src += srcPitch, dst += 8)
+		memcpy(dst, src, 8);
+
+	for (int i = 1; i < numzbuf; i++, dst += height) {
+		if (!zplane_list[i])
+			continue;
+		const byte *mask_ptr = getMaskBuffer(x, 0, i);
+		for (int h = 0; h < height; h++)
+			dst[h] = mask_ptr[h * _numStrips];
+	}
+}
+
+void Gdi::purgeBackgroundStrips() {
+	for (uint i = 0; i < _bgStrips.size(); i++)
+		delete[] _bgStrips[i];
+	_bgStrips.clear();
+	_bgStripsPtr = 0;
+}
+
+const byte *Gdi::getStripData(const byte *smap_ptr, int stripnr) const {
 	// Do some input verification and make sure the strip/strip offset
 	// are actually valid. Normally, this should never be a problem,
 	// but if e.g. a savegame gets corrupted, we can easily get into
@@ -1894,6 +1977,13 @@ bool Gdi::drawStrip(byte *dstPtr, VirtScreen *vs, int x, int y, const int width,
 	}
 	assertRange(0, offset, smapLen-1, "screen strip");
 
+	return smap_ptr + offset;
+}
+
+bool Gdi::drawStrip(byte *dstPtr, VirtScreen *vs, int x, int y, const int width, const int height,
+					int stripnr, const byte *smap_ptr) {
+	const byte *src = getStripData(smap_ptr, stripnr);
+
 	// Indy4 Amiga always uses the room or verb palette map to match colors to
 	// the currently setup palette, thus we need to select it over here too.
 	// Done like the original interpreter.
@@ -1904,7 +1994,25 @@ bool Gdi::drawStrip(byte *dstPtr, VirtScreen *vs, int x, int y, const int width,
 			_roomPalette = _vm->_roomPalette;
 	}
 
-	return decompressBitmap(dstPtr, vs->pitch, smap_ptr + offset, height);
+	return decompressBitmap(dstPtr, vs->pitch, src, height);
+}
+
+uint32 Gdi::decompressImage(const byte *smap_ptr, int numStrips, int height, byte *dst, bool fast) {
+	const bool oldFastStripDecoders = _fastStripDecoders;
+	const uint32 oldVertStripNextInc = _vertStripNextInc;
+	const int dstPitch = numStrips * 8;
+
+	_fastStripDecoders = fast;
+	_vertStripNextInc = height * dstPitch - 1;
+
+	const uint32 start = g_system->getMillis();
+	for (int i = 0; i < numStrips; i++)
+		decompressBitmap(dst + i * 8, dstPitch, getStripData(smap_ptr, i), height);
+	const uint32 time = g_system->getMillis() - start;
+
+	_fastStripDecoders = oldFastStripDecoders;
+	_vertStripNextInc = oldVertStripNextInc;
+	return time;
 }
 
 bool GdiNES::drawStrip(byte *dstPtr, VirtScreen *vs, int x, int y, const int width, const int height,
@@ -3418,6 +3526,11 @@ void Gdi::drawStrip3DO(byte *dst, int dstPitch, const byte *src, int height, con
 	} while (0)
 
 void Gdi::drawStripComplex(byte *dst, int dstPitch, const byte *src, int height, const bool transpCheck) const {
+	if (_fastStripDecoders && _vm->_bytesPerPixel == 1) {
+		drawStripComplexRuns(dst, dstPitch, src, height, transpCheck);
+		return;
+	}
+
 	byte color = *src++;
 	uint bits = *src++;
 	byte cl = 8;
@@ -3470,6 +3583,11 @@ void Gdi::drawStripComplex(byte *dst, int dstPitch, const byte *src, int height,
 }
 
 void Gdi::drawStripBasicH(byte *dst, int dstPitch, const byte *src, int height, const bool transpCheck) const {
+	if (_fastStripDecoders && _vm->_bytesPerPixel == 1) {
+		drawStripBasicRuns(dst, dstPitch, src, height, transpCheck, false);
+		return;
+	}
+
 	byte color = *src++;
 	uint bits = *src++;
 	byte cl = 8;
@@ -3502,6 +3620,11 @@ void Gdi::drawStripBasicH(byte *dst, int dstPitch, const byte *src, int height,
 }
 
 void Gdi::drawStripBasicV(byte *dst, int dstPitch, const byte *src, int height, const bool transpCheck) const {
+	if (_fastStripDecoders && _vm->_bytesPerPixel == 1) {
+		drawStripBasicRuns(dst, dstPitch, src, height, transpCheck, true);
+		return;
+	}
+
 	byte color = *src++;
 	uint bits = *src++;
 	byte cl = 8;
@@ -3537,6 +3660,185 @@ void Gdi::drawStripBasicV(byte *dst, int dstPitch, const byte *src, int height,
 #undef READ_BIT
 #undef FILL_BITS
 
+/*
+ * Run based versions of drawStripBasicH, drawStripBasicV and
+ * drawStripComplex. A "0" code means that the next pixel has the same color
+ * as the current one, so instead of handling the codes a bit at a time,
+ * they look up how many "0" codes follow and write the whole run at once.
+ */
+
+// Number of 0 bits before the lowest 1 bit of a byte, 8 for 0
+static const byte zeroBitRun[256] = {
+	8, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+	4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+	5, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+	4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+	6, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+	4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+	5, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+	4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+	7, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+	4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+	5, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+	4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+	6, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+	4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+	5, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+	4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0
+};
+
+#define FILL_BITS do {                                 \
+		while (cl <= 16) {                             \
+			bits |= (uint32)(*src++) << cl;            \
+			cl += 8;                                   \
+		}                                              \
+	} while (0)
+
+#define SKIP_BITS(n) do {                              \
+		bits >>= (n);                                  \
+		cl -= (n);                                     \
+	} while (0)
+
+/**
+ * Writes runs of equally colored pixels into a strip, either row by row or
+ * column by column.
+ */
+class StripRunWriter {
+public:
+	StripRunWriter(byte *dst, int dstPitch, int height, bool vertical)
+		: _dst(dst), _dstPitch(dstPitch), _height(height), _vertical(vertical) {
+		_left = vertical ? height : 8;
+		_lines = vertical ? 8 : height;
+	}
+
+	/**
+	 * Writes count pixels, or skips over them if they are transparent.
+	 * @return false once the strip is complete
+	 */
+	bool write(int count, byte color, bool transparent) {
+		while (count) {
+			const int n = MIN(count, _left);
+			if (!_vertical) {
+				if (!transparent)
+					memset(_dst, color, n);
+				_dst += n;
+			} else if (transparent) {
+				_dst += n * _dstPitch;
+			} else {
+				for (int i = 0; i < n; i++, _dst += _dstPitch)
+					*_dst = color;
+			}
+			count -= n;
+			_left -= n;
+
+			if (!_left) {
+				if (!--_lines)
+					return false;
+				if (_vertical) {
+					_dst += 1 - _height * _dstPitch;
+					_left = _height;
+				} else {
+					_dst += _dstPitch - 8;
+					_left = 8;
+				}
+			}
+		}
+		return true;
+	}
+
+private:
+	byte *_dst;
+	const int _dstPitch;
+	const int _height;
+	const bool _vertical;
+	int _left; ///< Pixels left in the current row or column
+	int _lines; ///< Rows or columns left, including the current one
+};
+
+void Gdi::drawStripBasicRuns(byte *dst, int dstPitch, const byte *src, int height, const bool transpCheck, const bool vertical) const {
+	StripRunWriter writer(dst, dstPitch, height, vertical);
+	byte color = *src++;
+	uint32 bits = *src++;
+	int cl = 8;
+	int8 inc = -1;
+
+	while (true) {
+		FILL_BITS;
+
+		// Write the current pixel and one more for each "0" code
+		const int zeros = zeroBitRun[bits & 0xFF];
+		if (!writer.write(zeros == 8 ? 8 : zeros + 1, _roomPalette[(color + _paletteMod) & 0xFF], transpCheck && color == _transparentColor))
+			return;
+		SKIP_BITS(zeros);
+		if (zeros == 8)
+			continue;
+
+		// The next code starts with a 1 bit
+		if (!(bits & 2)) {
+			SKIP_BITS(2);
+			color = bits & _decomp_mask;
+			SKIP_BITS(_decomp_shr);
+			inc = -1;
+		} else if (!(bits & 4)) {
+			SKIP_BITS(3);
+			color += inc;
+		} else {
+			SKIP_BITS(3);
+			inc = -inc;
+			color += inc;
+		}
+	}
+}
+
+void Gdi::drawStripComplexRuns(byte *dst, int dstPitch, const byte *src, int height, const bool transpCheck) const {
+	StripRunWriter writer(dst, dstPitch, height, false);
+	byte color = *src++;
+	uint32 bits = *src++;
+	int cl = 8;
+
+	while (true) {
+		FILL_BITS;
+
+		// Write the current pixel and one more for each "0" code
+		const int zeros = zeroBitRun[bits & 0xFF];
+		if (!writer.write(zeros == 8 ? 8 : zeros + 1, _roomPalette[(color + _paletteMod) & 0xFF], transpCheck && color == _transparentColor))
+			return;
+		SKIP_BITS(zeros);
+		if (zeros == 8)
+			continue;
+
+		// Handle the next code, and the one after each run of repeated
+		// pixels, which doesn't write a pixel of its own first
+		while (true) {
+			FILL_BITS;
+			if (!(bits & 1)) {
+				SKIP_BITS(1);
+				break;
+			} else if (!(bits & 2)) {
+				SKIP_BITS(2);
+				color = bits & _decomp_mask;
+				SKIP_BITS(_decomp_shr);
+				break;
+			}
+
+			const byte incm = ((bits >> 2) & 7) - 4;
+			SKIP_BITS(5);
+			if (incm) {
+				color += incm;
+				break;
+			}
+
+			const int reps = bits & 0xFF;
+			SKIP_BITS(8);
+			if (!writer.write(reps ? reps : 256, _roomPalette[(color + _paletteMod) & 0xFF], transpCheck && color == _transparentColor))
+				return;
+		}
+	}
+}
+
+#undef FILL_BITS
+#undef SKIP_BITS
+
 /* Ender - Zak256/Indy256 decoders */
 #define READ_BIT_256                       \
 		do {                               \
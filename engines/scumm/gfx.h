@@ -24,6 +24,7 @@
 #define SCUMM_GFX_H
 
 #include "common/system.h"
+#include "common/array.h"
 #include "common/list.h"
 
 #include "graphics/surface.h"
@@ -197,6 +198,21 @@ protected:
 	/** Flag which is true when an object is being rendered, false otherwise. */
 	bool _objectMode;
 
+	/**
+	 * Decoded strips of the room background, indexed by strip number. Each
+	 * one holds the 8 pixel wide strip followed by a column of each z-plane
+	 * mask. Only used by the plain Gdi, for opaque strips.
+	 */
+	Common::Array<byte *> _bgStrips;
+	const byte *_bgStripsPtr; ///< The room image the strips were decoded from
+	int _bgStripsHeight;
+	int _bgStripsNumZBuf;
+	byte _bgStripsPalette[256]; ///< The room palette the strips were decoded with
+	bool _bgStripsEnabled;
+
+	/** Flag which is true when the run based strip decoders are used. */
+	bool _fastStripDecoders;
+
 public:
 	/** Flag which is true when loading objects or titles for distaff, in PCEngine version of Loom. */
 	bool _distaff;
@@ -214,6 +230,8 @@ protected:
 	void drawStripComplex(byte *dst, int dstPitch, const byte *src, int height, const bool transpCheck) const;
 	void drawStripBasicH(byte *dst, int dstPitch, const byte *src, int height, const bool transpCheck) const;
 	void drawStripBasicV(byte *dst, int dstPitch, const byte *src, int height, const bool transpCheck) const;
+	void drawStripBasicRuns(byte *dst, int dstPitch, const byte *src, int height, const bool transpCheck, const bool vertical) const;
+	void drawStripComplexRuns(byte *dst, int dstPitch, const byte *src, int height, const bool transpCheck) const;
 
 	void drawStripRaw(byte *dst, int dstPitch, const byte *src, int height, const bool transpCheck) const;
 	void unkDecode8(byte *dst, int dstPitch, const byte *src, int height) const;
@@ -231,6 +249,10 @@ protected:
 
 	/* Misc */
 	int getZPlanes(const byte *smap_ptr, const byte *zplane_list[9], bool bmapImage) const;
+	const byte *getStripData(const byte *smap_ptr, int stripnr) const;
+	void storeBackgroundStrip(int stripnr, const byte *src, int srcPitch, int x, int height,
+					int numzbuf, const byte *zplane_list[9]);
+	void purgeBackgroundStrips();
 
 	virtual bool drawStrip(byte *dstPtr, VirtScreen *vs,
 					int x, int y, const int width, const int height,
@@ -256,6 +278,15 @@ public:
 	void drawBitmap(const byte *ptr, VirtScreen *vs, int x, int y, const int width, const int height,
 	                int stripnr, int numstrip, byte flag);
 
+	/**
+	 * Decompresses the strips of an image into a buffer of 8 * numStrips
+	 * by height pixels, for comparing and benchmarking the strip decoders.
+	 * @param smap_ptr	The SMAP block of the image
+	 * @param fast		Whether to use the run based decoders
+	 * @return the time spent decompressing, in milliseconds
+	 */
+	uint32 decompressImage(const byte *smap_ptr, int numStrips, int height, byte *dst, bool fast);
+
 #ifdef ENABLE_HE
 	void drawBMAPBg(const byte *ptr, VirtScreen *vs);
 	void drawBMAPObject(const byte *ptr, VirtScreen *vs, int obj, int x, int y, int w, int h);
@@ -270,7 +301,8 @@ public:
 	enum DrawBitmapFlags {
 		dbAllowMaskOr   = 1 << 0,
 		dbDrawMaskOnAll = 1 << 1,
-		dbObjectMode    = 2 << 2
+		dbObjectMode    = 2 << 2,
+		dbRoomBackground = 1 << 4 ///< Drawing the room image itself, which allows caching its strips
 	};
 };
 
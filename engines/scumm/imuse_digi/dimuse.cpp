@@ -207,6 +207,35 @@ void IMuseDigital::saveOrLoad(Serializer *ser) {
 	}
 }
 
+/**
+ * Decode the next bundle blocks of the playing tracks, so that the callback
+ * only has to copy them. It is called from the main loop of the engine, and
+ * decodes at most one block per track each time, to keep the callback from
+ * waiting long for the mutex.
+ */
+void IMuseDigital::readAhead() {
+	Common::StackLock lock(_mutex, "IMuseDigital::readAhead()");
+
+	if (_pause)
+		return;
+
+	for (int l = 0; l < MAX_DIGITAL_TRACKS + MAX_DIGITAL_FADETRACKS; l++) {
+		Track *track = _track[l];
+		if (track->used && track->stream && track->soundDesc && !track->souStreamUsed)
+			_sound->readAhead(track->soundDesc);
+	}
+}
+
+BundleBlockStats IMuseDigital::getBundleBlockStats() {
+	Common::StackLock lock(_mutex, "IMuseDigital::getBundleBlockStats()");
+	return _sound->getBundleBlockStats();
+}
+
+void IMuseDigital::resetBundleBlockStats() {
+	Common::StackLock lock(_mutex, "IMuseDigital::resetBundleBlockStats()");
+	_sound->getBundleBlockStats().reset();
+}
+
 void IMuseDigital::callback() {
 	Common::StackLock lock(_mutex, "IMuseDigital::callback()");
 
@@ -138,8 +138,9 @@ int BundleDirCache::matchFile(const char *filename) {
 	}
 }
 
-BundleMgr::BundleMgr(BundleDirCache *cache) {
+BundleMgr::BundleMgr(BundleDirCache *cache, BundleBlockStats *stats) {
 	_cache = cache;
+	_stats = stats;
 	_bundleTable = NULL;
 	_compTable = NULL;
 	_numFiles = 0;
@@ -148,6 +149,8 @@ BundleMgr::BundleMgr(BundleDirCache *cache) {
 	_fileBundleId = -1;
 	_file = new ScummFile();
 	_compInputBuff = NULL;
+	_blockData = NULL;
+	purgeBlockCache();
 }
 
 BundleMgr::~BundleMgr() {
@@ -192,8 +195,7 @@ bool BundleMgr::open(const char *filename, bool &compressed, bool errorFlag) {
 	_indexTable = _cache->getIndexTable(slot);
 	assert(_bundleTable);
 	_compTableLoaded = false;
-	_outputSize = 0;
-	_lastBlock = -1;
+	purgeBlockCache();
 
 	return true;
 }
@@ -205,13 +207,14 @@ void BundleMgr::close() {
 		_numFiles = 0;
 		_numCompItems = 0;
 		_compTableLoaded = false;
-		_lastBlock = -1;
-		_outputSize = 0;
+		purgeBlockCache();
 		_curSampleId = -1;
 		free(_compTable);
 		_compTable = NULL;
 		free(_compInputBuff);
 		_compInputBuff = NULL;
+		free(_blockData);
+		_blockData = NULL;
 	}
 }
 
@@ -241,10 +244,51 @@ bool BundleMgr::loadCompTable(int32 index) {
 	// CMI hack: one more byte at the end of input buffer
 	_compInputBuff = (byte *)malloc(maxSize + 1);
 	assert(_compInputBuff);
+	_blockData = (byte *)malloc(kBlockCacheSize * kBlockSize);
+	assert(_blockData);
 
 	return true;
 }
 
+void BundleMgr::purgeBlockCache() {
+	for (int i = 0; i < kBlockCacheSize; i++) {
+		_blockCache[i].block = -1;
+		_blockCache[i].outputSize = 0;
+	}
+	_readBlock = -1;
+}
+
+void BundleMgr::decodeBlock(int32 block) {
+	const int slot = block % kBlockCacheSize;
+	CachedBlock &entry = _blockCache[slot];
+
+	// CMI hack: one more zero byte at the end of input buffer
+	_compInputBuff[_compTable[block].size] = 0;
+	_file->seek(_bundleTable[_curSampleId].offset + _compTable[block].offset, SEEK_SET);
+	_file->read(_compInputBuff, _compTable[block].size);
+	entry.outputSize = BundleCodecs::decompressCodec(_compTable[block].codec, _compInputBuff, _blockData + slot * kBlockSize, _compTable[block].size);
+	if (entry.outputSize > kBlockSize) {
+		error("_outputSize: %d", entry.outputSize);
+	}
+	entry.block = block;
+}
+
+bool BundleMgr::readAhead() {
+	if (!_file->isOpen() || !_compTableLoaded || _readBlock == -1)
+		return false;
+
+	for (int32 block = _readBlock + 1; block <= _readBlock + kReadAheadBlocks && block < _numCompItems; block++) {
+		if (_blockCache[block % kBlockCacheSize].block != block) {
+			decodeBlock(block);
+			if (_stats)
+				_stats->readAhead++;
+			return true;
+		}
+	}
+
+	return false;
+}
+
 int32 BundleMgr::decompressSampleByCurIndex(int32 offset, int32 size, byte **compFinal, int headerSize, bool headerOutside) {
 	return decompressSampleByIndex(_curSampleId, offset, size, compFinal, headerSize, headerOutside);
 }
@@ -286,19 +330,17 @@ int32 BundleMgr::decompressSampleByIndex(int32 index, int32 offset, int32 size,
 	skip = (offset + headerSize) % 0x2000;
 
 	for (i = firstBlock; i <= lastBlock; i++) {
-		if (_lastBlock != i) {
-			// CMI hack: one more zero byte at the end of input buffer
-			_compInputBuff[_compTable[i].size] = 0;
-			_file->seek(_bundleTable[index].offset + _compTable[i].offset, SEEK_SET);
-			_file->read(_compInputBuff, _compTable[i].size);
-			_outputSize = BundleCodecs::decompressCodec(_compTable[i].codec, _compInputBuff, _compOutputBuff, _compTable[i].size);
-			if (_outputSize > 0x2000) {
-				error("_outputSize: %d", _outputSize);
-			}
-			_lastBlock = i;
+		const CachedBlock &entry = _blockCache[i % kBlockCacheSize];
+		if (entry.block != i) {
+			decodeBlock(i);
+			if (_stats)
+				_stats->misses++;
+		} else if (_stats) {
+			_stats->hits++;
 		}
+		_readBlock = i;
 
-		outputSize = _outputSize;
+		outputSize = entry.outputSize;
 
 		if (headerOutside) {
 			outputSize -= skip;
@@ -315,7 +357,7 @@ int32 BundleMgr::decompressSampleByIndex(int32 index, int32 offset, int32 size,
 
 		assert(finalSize + outputSize <= blocksFinalSize);
 
-		memcpy(*compFinal + finalSize, _compOutputBuff + skip, outputSize);
+		memcpy(*compFinal + finalSize, _blockData + (i % kBlockCacheSize) * kBlockSize + skip, outputSize);
 		finalSize += outputSize;
 
 		size -= outputSize;
@@ -63,6 +63,18 @@ public:
 	bool isSndDataExtComp(int slot);
 };
 
+/**
+ * Counters of the decoded block caches of all bundles.
+ */
+struct BundleBlockStats {
+	uint32 hits;		// blocks which were already decoded when they were requested
+	uint32 misses;		// blocks which had to be decoded when they were requested
+	uint32 readAhead;	// blocks decoded ahead by BundleMgr::readAhead()
+
+	BundleBlockStats() { reset(); }
+	void reset() { hits = misses = readAhead = 0; }
+};
+
 class BundleMgr {
 
 private:
@@ -73,6 +85,17 @@ private:
 		int32 codec;
 	};
 
+	enum {
+		kBlockSize = 0x2000,
+		kBlockCacheSize = 8,	// number of decoded blocks kept per bundle
+		kReadAheadBlocks = 4	// blocks decoded ahead of the read position, less than kBlockCacheSize
+	};
+
+	struct CachedBlock {
+		int32 block;		// number of the decoded block, or -1
+		int32 outputSize;	// size of the decoded data
+	};
+
 	BundleDirCache *_cache;
 	BundleDirCache::AudioTable *_bundleTable;
 	BundleDirCache::IndexNode *_indexTable;
@@ -84,16 +107,21 @@ private:
 	BaseScummFile *_file;
 	bool _compTableLoaded;
 	int _fileBundleId;
-	byte _compOutputBuff[0x2000];
 	byte *_compInputBuff;
-	int _outputSize;
-	int _lastBlock;
+
+	// Decoded blocks, block n is kept in entry n % kBlockCacheSize
+	CachedBlock _blockCache[kBlockCacheSize];
+	byte *_blockData;
+	int32 _readBlock;	// last block read by decompressSampleByIndex(), or -1
+	BundleBlockStats *_stats;
 
 	bool loadCompTable(int32 index);
+	void purgeBlockCache();
+	void decodeBlock(int32 block);
 
 public:
 
-	BundleMgr(BundleDirCache *_cache);
+	BundleMgr(BundleDirCache *_cache, BundleBlockStats *stats);
 	~BundleMgr();
 
 	bool open(const char *filename, bool &compressed, bool errorFlag = false);
@@ -102,6 +130,12 @@ public:
 	int32 decompressSampleByName(const char *name, int32 offset, int32 size, byte **compFinal, bool headerOutside);
 	int32 decompressSampleByIndex(int32 index, int32 offset, int32 size, byte **compFinal, int header_size, bool headerOutside);
 	int32 decompressSampleByCurIndex(int32 offset, int32 size, byte **compFinal, int headerSize, bool headerOutside);
+
+	/**
+	 * Decode one of the blocks following the last one read, if it is not
+	 * decoded yet. Returns false if there was nothing to do.
+	 */
+	bool readAhead();
 };
 
 } // End of namespace Scumm
@@ -320,7 +320,7 @@ ImuseDigiSndMgr::SoundDesc *ImuseDigiSndMgr::allocSlot() {
 bool ImuseDigiSndMgr::openMusicBundle(SoundDesc *sound, int &disk) {
 	bool result = false;
 
-	sound->bundle = new BundleMgr(_cacheBundleDir);
+	sound->bundle = new BundleMgr(_cacheBundleDir, &_bundleBlockStats);
 	assert(sound->bundle);
 	if (_vm->_game.id == GID_CMI) {
 		if (_vm->_game.features & GF_DEMO) {
@@ -355,7 +355,7 @@ bool ImuseDigiSndMgr::openMusicBundle(SoundDesc *sound, int &disk) {
 bool ImuseDigiSndMgr::openVoiceBundle(SoundDesc *sound, int &disk) {
 	bool result = false;
 
-	sound->bundle = new BundleMgr(_cacheBundleDir);
+	sound->bundle = new BundleMgr(_cacheBundleDir, &_bundleBlockStats);
 	assert(sound->bundle);
 	if (_vm->_game.id == GID_CMI) {
 		if (_vm->_game.features & GF_DEMO) {
@@ -731,4 +731,14 @@ int32 ImuseDigiSndMgr::getDataFromRegion(SoundDesc *soundDesc, int region, byte
 	return size;
 }
 
+bool ImuseDigiSndMgr::readAhead(SoundDesc *soundDesc) {
+	assert(checkForProperHandle(soundDesc));
+
+	// Compressed bundles are decoded by the audio streams of their regions
+	if (soundDesc->bundle && !soundDesc->compressed)
+		return soundDesc->bundle->readAhead();
+
+	return false;
+}
+
 } // End of namespace Scumm
@@ -115,6 +115,7 @@ private:
 	ScummEngine *_vm;
 	byte _disk;
 	BundleDirCache *_cacheBundleDir;
+	BundleBlockStats _bundleBlockStats;
 
 	bool openMusicBundle(SoundDesc *sound, int &disk);
 	bool openVoiceBundle(SoundDesc *sound, int &disk);
@@ -146,6 +147,8 @@ public:
 	void getSyncSizeAndPtrById(SoundDesc *soundDesc, int number, int32 &sync_size, byte **sync_ptr);
 
 	int32 getDataFromRegion(SoundDesc *soundDesc, int region, byte **buf, int32 offset, int32 size);
+	bool readAhead(SoundDesc *soundDesc);
+	BundleBlockStats &getBundleBlockStats() { return _bundleBlockStats; }
 };
 
 } // End of namespace Scumm
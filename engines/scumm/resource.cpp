@@ -801,8 +801,8 @@ byte ResourceManager::Resource::getResourceCounter() const {
 	return _flags & RF_USAGE;
 }
 
-/* 2 bytes safety area to make "precaching" of bytes in the gdi drawer easier */
-#define SAFETY_AREA 2
+/* 4 bytes safety area to make "precaching" of bytes in the gdi drawers easier */
+#define SAFETY_AREA 4
 
 byte *ResourceManager::createResource(ResType type, ResId idx, uint32 size) {
 	debugC(DEBUG_RESOURCE, "_res->createResource(%s,%d,%d)", nameOfResType(type), idx, size);
@@ -894,6 +894,10 @@ bool ResourceManager::validateResource(const char *str, ResType type, ResId idx)
 }
 
 void ResourceManager::nukeResource(ResType type, ResId idx) {
+	// Anything derived from the walk boxes becomes stale along with them
+	if (type == rtMatrix)
+		_vm->invalidateWalkGraph();
+
 	byte *ptr = _types[type][idx]._address;
 	if (ptr != NULL) {
 		debugC(DEBUG_RESOURCE, "nukeResource(%s,%d)", nameOfResType(type), idx);
@@ -35,6 +35,7 @@
 #include "graphics/cursorman.h"
 
 #include "scumm/akos.h"
+#include "scumm/boxes.h"
 #include "scumm/charset.h"
 #include "scumm/costume.h"
 #include "scumm/debugger.h"
@@ -136,6 +137,7 @@ ScummEngine::ScummEngine(OSystem *syst, const DetectorResult &dr)
 		_gdi = new Gdi(this);
 	}
 	_res = new ResourceManager(this);
+	_walkGraph = new WalkGraph();
 
 	// Convert MD5 checksum back into a digest
 	for (int i = 0; i < 16; ++i) {
@@ -641,6 +643,7 @@ ScummEngine::~ScummEngine() {
 	delete _debugger;
 
 	delete _res;
+	delete _walkGraph;
 	delete _gdi;
 }
 
@@ -2012,6 +2015,10 @@ void ScummEngine::waitForTimer(int msec_delay) {
 
 	while (!shouldQuit()) {
 		_sound->updateCD(); // Loop CD Audio if needed
+#ifdef ENABLE_SCUMM_7_8
+		if (_imuseDigital)
+			_imuseDigital->readAhead();
+#endif
 		parseEvents();
 
 #ifndef DISABLE_TOWNS_DUAL_LAYER_MODE
@@ -2412,6 +2419,7 @@ void ScummEngine_v7::scummLoop_handleSound() {
 	ScummEngine_v6::scummLoop_handleSound();
 	if (_imuseDigital) {
 		_imuseDigital->flushTracks();
+		_imuseDigital->readAhead();
 		// In CoMI and the Dig the full (non-demo) version invoke IMuseDigital::refreshScripts
 		if ((_game.id == GID_DIG || _game.id == GID_CMI) && !(_game.features & GF_DEMO))
 			_imuseDigital->refreshScripts();
@@ -93,6 +93,8 @@ class Sound;
 
 struct Box;
 struct BoxCoords;
+struct BoxPortal;
+struct WalkGraph;
 struct FindObjectInRoom;
 
 // Use g_scumm from error() ONLY
@@ -1125,6 +1127,9 @@ public:
 	bool checkXYInBoxBounds(int box, int x, int y);
 
 	BoxCoords getBoxCoordinates(int boxnum);
+	BoxPortal getBoxPortal(byte box1nr, byte box2nr);
+
+	void invalidateWalkGraph();
 
 	byte getMaskFromBox(int box);
 	Box *getBoxBaseAddr(int box);
@@ -1149,6 +1154,12 @@ protected:
 	void createBoxMatrix();
 	virtual bool areBoxesNeighbors(int i, int j);
 
+	WalkGraph *_walkGraph;
+	void buildWalkGraph();
+	BoxCoords readBoxCoordinates(int boxnum);
+	int calcNextBox(byte from, byte to);
+	BoxPortal calcBoxPortal(byte box1nr, byte box2nr);
+
 	/* String class */
 public:
 	CharsetRenderer *_charset;
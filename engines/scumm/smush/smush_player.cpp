@@ -24,6 +24,7 @@
 
 #include "common/config-manager.h"
 #include "common/file.h"
+#include "common/memstream.h"
 #include "common/system.h"
 #include "common/util.h"
 
@@ -220,6 +221,10 @@ SmushPlayer::SmushPlayer(ScummEngine_v7 *scumm) {
 	_sf[3] = NULL;
 	_sf[4] = NULL;
 	_base = NULL;
+	_frameChunk = NULL;
+	_frameChunkSize = 0;
+	_frameChunkCapacity = 0;
+	_framePrefetched = false;
 	_frameBuffer = NULL;
 	_specialBuffer = NULL;
 
@@ -290,6 +295,11 @@ void SmushPlayer::release() {
 	delete _base;
 	_base = NULL;
 
+	free(_frameChunk);
+	_frameChunk = NULL;
+	_frameChunkCapacity = 0;
+	_framePrefetched = false;
+
 	free(_specialBuffer);
 	_specialBuffer = NULL;
 
@@ -1005,6 +1015,7 @@ void SmushPlayer::parseNextFrame() {
 		}
 
 		_base->seek(_seekPos + 8, SEEK_SET);
+		_framePrefetched = false;
 		_frame = _seekFrame;
 		_startFrame = _frame;
 		_startTime = _vm->_system->getMillis();
@@ -1014,30 +1025,38 @@ void SmushPlayer::parseNextFrame() {
 
 	assert(_base);
 
-	const uint32 subType = _base->readUint32BE();
-	const int32 subSize = _base->readUint32BE();
-	const int32 subOffset = _base->pos();
+	// Frames are normally read ahead while waiting for them to be due, see
+	// play(), so that decoding them doesn't have to wait for the file
+	if (_framePrefetched || prefetchFrame()) {
+		_framePrefetched = false;
+		Common::MemoryReadStream frame(_frameChunk, _frameChunkSize);
+		handleFrame(_frameChunkSize, frame);
+	} else {
+		const uint32 subType = _base->readUint32BE();
+		const int32 subSize = _base->readUint32BE();
+		const int32 subOffset = _base->pos();
 
-	if (_base->pos() >= (int32)_baseSize) {
-		_vm->_smushVideoShouldFinish = true;
-		_endOfFile = true;
-		return;
-	}
+		if (_base->pos() >= (int32)_baseSize) {
+			_vm->_smushVideoShouldFinish = true;
+			_endOfFile = true;
+			return;
+		}
 
-	debug(3, "Chunk: %s at %x", tag2str(subType), subOffset);
+		debug(3, "Chunk: %s at %x", tag2str(subType), subOffset);
 
-	switch (subType) {
-	case MKTAG('A','H','D','R'): // FT INSANE may seek file to the beginning
-		handleAnimHeader(subSize, *_base);
-		break;
-	case MKTAG('F','R','M','E'):
-		handleFrame(subSize, *_base);
-		break;
-	default:
-		error("Unknown Chunk found at %x: %s, %d", subOffset, tag2str(subType), subSize);
-	}
+		switch (subType) {
+		case MKTAG('A','H','D','R'): // FT INSANE may seek file to the beginning
+			handleAnimHeader(subSize, *_base);
+			break;
+		case MKTAG('F','R','M','E'):
+			handleFrame(subSize, *_base);
+			break;
+		default:
+			error("Unknown Chunk found at %x: %s, %d", subOffset, tag2str(subType), subSize);
+		}
 
-	_base->seek(subOffset + subSize, SEEK_SET);
+		_base->seek(subOffset + subSize, SEEK_SET);
+	}
 
 	if (_insanity)
 		_vm->_sound->processSound();
@@ -1045,6 +1064,36 @@ void SmushPlayer::parseNextFrame() {
 	_vm->_imuseDigital->flushTracks();
 }
 
+bool SmushPlayer::prefetchFrame() {
+	if (!_base || _seekPos >= 0)
+		return false;
+
+	// Only whole FRME chunks are read ahead, everything else is left to
+	// parseNextFrame()
+	const int32 chunkStart = _base->pos();
+	const uint32 subType = _base->readUint32BE();
+	const int32 subSize = _base->readUint32BE();
+
+	if (subType == MKTAG('F','R','M','E') && _base->pos() < (int32)_baseSize && subSize >= 0) {
+		if (subSize > _frameChunkCapacity) {
+			free(_frameChunk);
+			_frameChunk = (byte *)malloc(subSize);
+			assert(_frameChunk);
+			_frameChunkCapacity = subSize;
+		}
+
+		if (_base->read(_frameChunk, subSize) == (uint32)subSize) {
+			debug(3, "Chunk: %s at %x", tag2str(subType), chunkStart + 8);
+			_frameChunkSize = subSize;
+			_framePrefetched = true;
+			return true;
+		}
+	}
+
+	_base->seek(chunkStart, SEEK_SET);
+	return false;
+}
+
 void SmushPlayer::setPalette(const byte *palette) {
 	memcpy(_pal, palette, 0x300);
 	setDirtyColors(0, 255);
@@ -1204,6 +1253,9 @@ void SmushPlayer::play(const char *filename, int32 speed, int32 offset, int32 st
 			else
 				skipFrame = false;
 			timerCallback();
+		} else if (!_framePrefetched) {
+			// Use the time until the next frame is due to read it
+			prefetchFrame();
 		}
 
 		_vm->scummLoop_handleSound();
@@ -1249,7 +1301,9 @@ void SmushPlayer::play(const char *filename, int32 speed, int32 offset, int32 st
 			_IACTpos = 0;
 			break;
 		}
-		_vm->_system->delayMillis(10);
+		// Don't wait if we are behind, so that decoding can catch up
+		if (elapsed < ((_frame - _startFrame) * 1000) / _speed)
+			_vm->_system->delayMillis(10);
 	}
 
 	release();
@@ -1258,4 +1312,120 @@ void SmushPlayer::play(const char *filename, int32 speed, int32 offset, int32 st
 	CursorMan.showMouse(oldMouseState);
 }
 
+bool SmushPlayer::benchmark(const char *filename, int &frames, uint32 &readTime, uint32 &decodeTime) {
+	ScummFile file;
+	if (!_vm->openFile(file, filename))
+		return false;
+
+	file.readUint32BE();
+	const uint32 fileSize = file.readUint32BE();
+
+	const int pitch = _vm->_screenWidth;
+	byte *dst = (byte *)calloc(pitch * _vm->_screenHeight, 1);
+	assert(dst);
+	Codec37Decoder *codec37 = 0;
+	Codec47Decoder *codec47 = 0;
+	int codecWidth = 0, codecHeight = 0;
+	byte *chunk = 0;
+	int32 chunkCapacity = 0;
+
+	frames = 0;
+	readTime = 0;
+	decodeTime = 0;
+
+	while (true) {
+		uint32 start = _vm->_system->getMillis();
+		const uint32 type = file.readUint32BE();
+		const int32 size = file.readUint32BE();
+		if (file.pos() >= (int32)fileSize || file.eos() || size < 0)
+			break;
+		if (type != MKTAG('F','R','M','E')) {
+			file.skip(size);
+			readTime += _vm->_system->getMillis() - start;
+			continue;
+		}
+
+		if (size > chunkCapacity) {
+			free(chunk);
+			chunk = (byte *)malloc(size);
+			assert(chunk);
+			chunkCapacity = size;
+		}
+		if (file.read(chunk, size) != (uint32)size)
+			break;
+		readTime += _vm->_system->getMillis() - start;
+
+		start = _vm->_system->getMillis();
+		int32 pos = 0;
+		while (pos + 8 <= size) {
+			const uint32 subType = READ_BE_UINT32(chunk + pos);
+			const int32 subSize = READ_BE_UINT32(chunk + pos + 4);
+			if (subSize < 0 || pos + 8 + subSize > size)
+				break;
+
+			const byte *src = chunk + pos + 8;
+			int32 srcSize = subSize;
+#ifdef USE_ZLIB
+			byte *fobjBuffer = 0;
+			if (subType == MKTAG('Z','F','O','B') && subSize > 4) {
+				unsigned long decompressedSize = READ_BE_UINT32(src);
+				fobjBuffer = (byte *)malloc(decompressedSize);
+				if (!Common::uncompress(fobjBuffer, &decompressedSize, src + 4, subSize - 4))
+					error("SmushPlayer::benchmark() Zlib uncompress error");
+				src = fobjBuffer;
+				srcSize = decompressedSize;
+			}
+#endif
+
+			if ((subType == MKTAG('F','O','B','J') || subType == MKTAG('Z','F','O','B')) && srcSize >= 14) {
+				const int codec = READ_LE_UINT16(src);
+				const int left = READ_LE_UINT16(src + 2);
+				const int top = READ_LE_UINT16(src + 4);
+				const int width = READ_LE_UINT16(src + 6);
+				const int height = READ_LE_UINT16(src + 8);
+
+				// Only decode what the player would show, see decodeFrameObject()
+				if (width == _vm->_screenWidth && height == _vm->_screenHeight) {
+					if (width != codecWidth || height != codecHeight) {
+						delete codec37;
+						delete codec47;
+						codec37 = new Codec37Decoder(width, height);
+						codec47 = new Codec47Decoder(width, height);
+						codecWidth = width;
+						codecHeight = height;
+					}
+
+					switch (codec) {
+					case 1:
+					case 3:
+						smush_decode_codec1(dst, src + 14, left, top, width, height, pitch);
+						break;
+					case 37:
+						codec37->decode(dst, src + 14);
+						break;
+					case 47:
+						codec47->decode(dst, src + 14);
+						break;
+					default:
+						break;
+					}
+				}
+			}
+
+#ifdef USE_ZLIB
+			free(fobjBuffer);
+#endif
+			pos += 8 + subSize + (subSize & 1);
+		}
+		decodeTime += _vm->_system->getMillis() - start;
+		frames++;
+	}
+
+	free(chunk);
+	delete codec37;
+	delete codec47;
+	free(dst);
+	return true;
+}
+
 } // End of namespace Scumm
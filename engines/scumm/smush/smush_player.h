@@ -49,6 +49,10 @@ private:
 	Codec47Decoder *_codec47;
 	Common::SeekableReadStream *_base;
 	uint32 _baseSize;
+	byte *_frameChunk; ///< The next FRME chunk, when it was read ahead of time
+	int32 _frameChunkSize;
+	int32 _frameChunkCapacity;
+	bool _framePrefetched;
 	byte *_frameBuffer;
 	byte *_specialBuffer;
 
@@ -93,6 +97,13 @@ public:
 	void release();
 	void warpMouse(int x, int y, int buttons);
 
+	/**
+	 * Reads and decodes all video frames of a SMUSH file without showing
+	 * them or playing any audio, for measuring the decoding speed.
+	 * @return false if the file could not be opened
+	 */
+	bool benchmark(const char *filename, int &frames, uint32 &readTime, uint32 &decodeTime);
+
 protected:
 	int _width, _height;
 
@@ -111,6 +122,7 @@ protected:
 private:
 	SmushFont *getFont(int font);
 	void parseNextFrame();
+	bool prefetchFrame();
 	void init(int32 spped);
 	void setupAnim(const char *file);
 	void updateScreen();
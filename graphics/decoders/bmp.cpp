@@ -138,21 +138,27 @@ bool BitmapDecoder::loadStream(Common::SeekableReadStream &stream) {
 		}
 	} else {
 		byte *dst = (byte *)_surface->pixels + (height - 1) * _surface->pitch;
+		byte *rowBuffer = new byte[srcPitch + extraDataLength];
 
 		for (int32 i = 0; i < height; i++) {
+			// The last row may lack its padding
+			const byte *src;
+			uint32 rowSize = stream.readOrView(src, srcPitch + extraDataLength, rowBuffer);
+			if (rowSize < (uint32)srcPitch)
+				memset(rowBuffer + rowSize, 0, srcPitch - rowSize);
+
 			for (uint32 j = 0; j < width; j++) {
-				byte b = stream.readByte();
-				byte g = stream.readByte();
-				byte r = stream.readByte();
-				uint32 color = format.RGBToColor(r, g, b);
+				uint32 color = format.RGBToColor(src[2], src[1], src[0]);
+				src += 3;
 
 				*((uint32 *)dst) = color;
 				dst += format.bytesPerPixel;
 			}
 
-			stream.skip(extraDataLength);
 			dst -= _surface->pitch * 2;
 		}
+
+		delete[] rowBuffer;
 	}
 
 	return true;
@@ -23,7 +23,9 @@
 // NB: This is really only necessary if USE_READLINE is defined
 #define FORBIDDEN_SYMBOL_ALLOW_ALL
 
+#include "common/algorithm.h"
 #include "common/debug-channels.h"
+#include "common/hashmap.h"
 #include "common/system.h"
 
 #include "engines/engine.h"
@@ -64,6 +66,8 @@ Debugger::Debugger() {
 	DCmd_Register("debugflag_list",		WRAP_METHOD(Debugger, Cmd_DebugFlagsList));
 	DCmd_Register("debugflag_enable",	WRAP_METHOD(Debugger, Cmd_DebugFlagEnable));
 	DCmd_Register("debugflag_disable",	WRAP_METHOD(Debugger, Cmd_DebugFlagDisable));
+
+	DCmd_Register("hashmaps",			WRAP_METHOD(Debugger, Cmd_HashMaps));
 }
 
 Debugger::~Debugger() {
@@ -537,6 +541,51 @@ bool Debugger::Cmd_DebugFlagDisable(int argc, const char **argv) {
 	return true;
 }
 
+struct HashMapStatsLess {
+	bool operator()(const Common::HashMapStats &a, const Common::HashMapStats &b) const {
+		return strcmp(a.name, b.name) < 0;
+	}
+};
+
+bool Debugger::Cmd_HashMaps(int argc, const char **argv) {
+	if (argc > 1 && !strcmp(argv[1], "reset")) {
+		Common::resetRegisteredHashMapStats();
+		DebugPrintf("Reset the counters of all hash maps\n");
+		return true;
+	} else if (argc > 1) {
+		DebugPrintf("Usage: %s [reset]\n", argv[0]);
+		DebugPrintf("Shows usage statistics of the registered hash maps. Load and\n");
+		DebugPrintf("deleted are percentages of the capacity; probes are per lookup.\n");
+		return true;
+	}
+
+#ifndef USE_HASHMAP_STATS
+	DebugPrintf("Lookups are not counted in release builds\n");
+#endif
+
+	Common::Array<Common::HashMapStats> stats;
+	Common::getRegisteredHashMapStats(stats);
+	if (stats.empty()) {
+		DebugPrintf("No hash maps registered\n");
+		return true;
+	}
+	Common::sort(stats.begin(), stats.end(), HashMapStatsLess());
+
+	DebugPrintf("%-22s %6s %6s %4s %4s %9s %5s %4s %4s %7s\n",
+		"Name", "Size", "Capac", "Load", "Del", "Lookups", "Probe", "Max", "Grow", "KB");
+	for (uint i = 0; i < stats.size(); ++i) {
+		const Common::HashMapStats &s = stats[i];
+		const Common::HashMapCounters &c = s.counters;
+
+		DebugPrintf("%-22s %6u %6u %3u%% %3u%% %9u %5.2f %4u %4u %7.1f\n",
+			s.name, s.size, s.capacity,
+			s.size * 100 / s.capacity, s.deleted * 100 / s.capacity,
+			c.lookups, c.lookups ? (float)c.probes / c.lookups : 0.0f,
+			c.maxProbes, c.rehashes, s.memory / 1024.0f);
+	}
+	return true;
+}
+
 // Console handler
 #ifndef USE_TEXT_CONSOLE_FOR_DEBUGGER
 bool Debugger::debuggerInputCallback(GUI::ConsoleDialog *console, const char *input, void *refCon) {
@@ -0,0 +1,257 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/rate.h"
+#include "audio/rate_kernels.h"
+#include "audio/mixer.h"
+#include "audio/decoders/raw.h"
+
+#include "helper.h"
+
+class RateConverterTestSuite : public CxxTest::TestSuite
+{
+private:
+	// Simple pseudo random generator, so the test data is reproducible
+	uint32 _seed;
+
+	int16 nextSample() {
+		_seed = _seed * 1103515245 + 12345;
+		return (int16)(_seed >> 16);
+	}
+
+	void fillRandom(int16 *buf, int count) {
+		for (int i = 0; i < count; ++i)
+			buf[i] = nextSample();
+	}
+
+	void mixTestTemplate(bool stereo, bool reverseStereo, Audio::st_volume_t volL, Audio::st_volume_t volR) {
+		const Audio::RateKernels &fast = Audio::getRateKernels();
+		const Audio::RateKernels &ref = Audio::getScalarRateKernels();
+
+		// An odd frame count exercises the tail handling, too
+		const int frames = 1021;
+		int16 in[frames * 2];
+		int16 out[frames * 2], expected[frames * 2];
+		fillRandom(in, frames * 2);
+		fillRandom(out, frames * 2);
+		memcpy(expected, out, sizeof(out));
+
+		if (stereo) {
+			fast.mixStereo(out, in, frames, volL, volR, reverseStereo);
+			ref.mixStereo(expected, in, frames, volL, volR, reverseStereo);
+		} else {
+			fast.mixMono(out, in, frames, volL, volR);
+			ref.mixMono(expected, in, frames, volL, volR);
+		}
+
+		TS_ASSERT_EQUALS(memcmp(out, expected, sizeof(out)), 0);
+	}
+
+public:
+	void setUp() {
+		_seed = 0x1234;
+	}
+
+	void test_mix_mono() {
+		mixTestTemplate(false, false, 256, 256);
+		mixTestTemplate(false, false, 37, 201);
+		mixTestTemplate(false, false, 0, 255);
+	}
+
+	void test_mix_stereo() {
+		mixTestTemplate(true, false, 256, 256);
+		mixTestTemplate(true, false, 91, 3);
+	}
+
+	void test_mix_stereo_reverse() {
+		mixTestTemplate(true, true, 256, 128);
+		mixTestTemplate(true, true, 17, 250);
+	}
+
+	void test_mix_scalar_reference() {
+		int16 in[2] = { -32768, 32767 };
+		int16 out[4] = { 0, 0, 32000, -32000 };
+
+		// Scaling rounds towards zero, accumulation saturates
+		Audio::getScalarRateKernels().mixMono(out, in, 2, 255, 1);
+		TS_ASSERT_EQUALS(out[0], -32640);
+		TS_ASSERT_EQUALS(out[1], -128);
+		TS_ASSERT_EQUALS(out[2], 32767);
+		TS_ASSERT_EQUALS(out[3], -31873);
+	}
+
+	void test_interpolate() {
+		const int count = 1027;
+		int16 last[count], cur[count], out[count], expected[count];
+		uint16 frac[count];
+		fillRandom(last, count);
+		fillRandom(cur, count);
+		fillRandom((int16 *)frac, count);
+
+		// Include the extreme cases, which overflow a plain int product
+		last[0] = -32768; cur[0] = 32767; frac[0] = 65535;
+		last[1] = 32767; cur[1] = -32768; frac[1] = 65535;
+		last[2] = 100; cur[2] = -100; frac[2] = 0;
+
+		Audio::getRateKernels().interpolate(out, last, cur, frac, count);
+		Audio::getScalarRateKernels().interpolate(expected, last, cur, frac, count);
+		TS_ASSERT_EQUALS(memcmp(out, expected, sizeof(out)), 0);
+
+		// Compare against the straightforward formula, using floating point
+		// math to avoid the overflow
+		for (int i = 0; i < count; ++i) {
+			const double diff = cur[i] - last[i];
+			const int value = last[i] + (int)floor((diff * frac[i] + 0x8000) / 65536.0);
+			TS_ASSERT_EQUALS(expected[i], value);
+		}
+	}
+
+	void test_dot_product() {
+		const int count = 133;
+		int16 a[count], b[count];
+		fillRandom(a, count);
+		fillRandom(b, count);
+		for (int i = 0; i < count; ++i)
+			b[i] >>= 4;
+
+		for (int len = 0; len <= count; len += 7)
+			TS_ASSERT_EQUALS(Audio::getRateKernels().dotProduct(a, b, len), Audio::getScalarRateKernels().dotProduct(a, b, len));
+	}
+
+	void test_copy_converter() {
+		int16 *sine;
+		Audio::SeekableAudioStream *s = createSineStream<int16>(11025, 1, &sine, false, false);
+		Audio::RateConverter *conv = Audio::makeRateConverter(11025, 11025, false);
+
+		int16 out[2 * 1000];
+		memset(out, 0, sizeof(out));
+		TS_ASSERT_EQUALS(conv->flow(*s, out, 1000, 256, 128), 1000);
+
+		for (int i = 0; i < 1000; ++i) {
+			TS_ASSERT_EQUALS(out[i * 2 + 0], sine[i]);
+			TS_ASSERT_EQUALS(out[i * 2 + 1], sine[i] / 2);
+		}
+
+		delete conv;
+		delete[] sine;
+		delete s;
+	}
+
+	void test_linear_converter() {
+		int16 *sine;
+		Audio::SeekableAudioStream *s = createSineStream<int16>(11025, 1, &sine, false, false);
+		Audio::RateConverter *conv = Audio::makeRateConverter(11025, 22050, false);
+
+		// Upsampling by two: every second output frame lies right between
+		// two input samples. The first input sample is preceded by silence.
+		int16 out[2 * 2000];
+		memset(out, 0, sizeof(out));
+		TS_ASSERT_EQUALS(conv->flow(*s, out, 2000, 256, 256), 2000);
+
+		for (int i = 1; i < 1000; ++i) {
+			TS_ASSERT_EQUALS(out[i * 4 + 0], sine[i - 1]);
+			TS_ASSERT_EQUALS(out[i * 4 + 2], (int16)(sine[i - 1] + (((sine[i] - sine[i - 1]) * 0x8000 + 0x8000) >> 16)));
+			TS_ASSERT_EQUALS(out[i * 4 + 1], out[i * 4 + 0]);
+		}
+
+		delete conv;
+		delete[] sine;
+		delete s;
+	}
+
+	void test_simple_converter() {
+		int16 *sine;
+		Audio::SeekableAudioStream *s = createSineStream<int16>(22050, 1, &sine, false, true);
+		Audio::RateConverter *conv = Audio::makeRateConverter(22050, 11025, true, true);
+
+		// Downsampling by two picks every second input frame, starting
+		// with the second one
+		int16 out[2 * 2000];
+		memset(out, 0, sizeof(out));
+		TS_ASSERT_EQUALS(conv->flow(*s, out, 2000, 256, 256), 2000);
+
+		for (int i = 0; i < 2000; ++i) {
+			TS_ASSERT_EQUALS(out[i * 2 + 1], sine[i * 4 + 2]);
+			TS_ASSERT_EQUALS(out[i * 2 + 0], sine[i * 4 + 3]);
+		}
+
+		delete conv;
+		delete[] sine;
+		delete s;
+	}
+
+	void sincTestTemplate(const int inRate, const int outRate, Audio::RateConverterQuality quality) {
+		// A constant signal has to come out unchanged, once the filter
+		// is filled
+		const int inSamples = inRate / 10;
+		int16 *in = (int16 *)malloc(inSamples * sizeof(int16));
+		for (int i = 0; i < inSamples; ++i)
+			in[i] = 10000;
+
+		Audio::SeekableAudioStream *s = Audio::makeRawStream((const byte *)in, inSamples * 2, inRate, Audio::FLAG_16BITS
+#ifdef SCUMM_LITTLE_ENDIAN
+		                                                     | Audio::FLAG_LITTLE_ENDIAN
+#endif
+		                                                     );
+		Audio::RateConverter *conv = Audio::makeRateConverter(inRate, outRate, false, false, quality);
+
+		const int outFrames = outRate / 20;
+		int16 *out = new int16[outFrames * 2];
+		memset(out, 0, outFrames * 2 * sizeof(int16));
+		TS_ASSERT_EQUALS(conv->flow(*s, out, outFrames, 256, 256), outFrames);
+
+		for (int i = outFrames / 2; i < outFrames; ++i) {
+			TS_ASSERT_DELTA(out[i * 2 + 0], 10000, 2);
+			TS_ASSERT_EQUALS(out[i * 2 + 1], out[i * 2 + 0]);
+		}
+
+		delete conv;
+		delete s;
+		delete[] out;
+	}
+
+	void test_sinc_converter_dc() {
+		sincTestTemplate(22050, 44100, Audio::kRateConverterSincLow);
+		sincTestTemplate(22050, 48000, Audio::kRateConverterSincMedium);
+		sincTestTemplate(44100, 11025, Audio::kRateConverterSincHigh);
+		sincTestTemplate(11127, 44100, Audio::kRateConverterSincHigh);
+	}
+
+	void test_sinc_converter_high_rates() {
+		// The fast converters cannot handle rates >= 65536
+		sincTestTemplate(96000, 48000, Audio::kRateConverterFast);
+		sincTestTemplate(44100, 96000, Audio::kRateConverterFast);
+	}
+
+	void test_sinc_converter_sine() {
+		// A 1 kHz sine must keep its amplitude and phase
+		const int inRate = 22050, outRate = 48000;
+		const int inSamples = inRate / 5;
+		int16 *in = (int16 *)malloc(inSamples * 2 * sizeof(int16));
+		for (int i = 0; i < inSamples; ++i) {
+			in[i * 2 + 0] = (int16)(sin(2 * M_PI * 1000 * i / inRate) * 16000);
+			in[i * 2 + 1] = -in[i * 2 + 0];
+		}
+
+		Audio::SeekableAudioStream *s = Audio::makeRawStream((const byte *)in, inSamples * 4, inRate, Audio::FLAG_16BITS | Audio::FLAG_STEREO
+#ifdef SCUMM_LITTLE_ENDIAN
+		                                                     | Audio::FLAG_LITTLE_ENDIAN
+#endif
+		                                                     );
+		Audio::RateConverter *conv = Audio::makeRateConverter(inRate, outRate, true, false, Audio::kRateConverterSincHigh);
+
+		const int outFrames = outRate / 10;
+		int16 *out = new int16[outFrames * 2];
+		memset(out, 0, outFrames * 2 * sizeof(int16));
+		TS_ASSERT_EQUALS(conv->flow(*s, out, outFrames, 256, 256), outFrames);
+
+		for (int i = 100; i < outFrames; ++i) {
+			const int expected = (int)(sin(2 * M_PI * 1000 * i / outRate) * 16000);
+			TS_ASSERT_DELTA(out[i * 2 + 0], expected, 40);
+			TS_ASSERT_DELTA(out[i * 2 + 1], -expected, 40);
+		}
+
+		delete conv;
+		delete s;
+		delete[] out;
+	}
+};
@@ -0,0 +1,503 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+/*
+ * Headless audio benchmark. Renders a configurable mix of audio streams
+ * through Audio::MixerImpl::mixCallback without any sound device, and
+ * reports the mixing throughput and the number of heap allocations done
+ * per callback. Run with --help for the available options.
+ */
+
+// The benchmark is a standalone tool, not part of ScummVM proper
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include "backends/modular-backend.h"
+#include "backends/mutex/null/null-mutex.h"
+#include "backends/graphics/null/null-graphics.h"
+#include "backends/events/default/default-events.h"
+#include "backends/saves/default/default-saves.h"
+#include "backends/timer/default/default-timer.h"
+#include "backends/fs/posix/posix-fs-factory.h"
+
+#include "audio/mixer_intern.h"
+#include "audio/audiostream.h"
+#include "audio/decoders/adpcm.h"
+#include "audio/decoders/flac.h"
+#include "audio/decoders/mp3.h"
+#include "audio/decoders/raw.h"
+#include "audio/decoders/voc.h"
+#include "audio/decoders/vorbis.h"
+#include "audio/decoders/wave.h"
+
+#include "common/array.h"
+#include "common/config-manager.h"
+#include "common/fs.h"
+#include "common/memstream.h"
+#include "common/str.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <new>
+
+#pragma mark -
+#pragma mark --- Allocation counting ---
+#pragma mark -
+
+static unsigned long s_allocations = 0;
+
+#ifdef __GLIBC__
+// Count plain malloc calls, too. The decoders use them for their buffers.
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t num, size_t size);
+extern "C" void *__libc_realloc(void *ptr, size_t size);
+extern "C" void __libc_free(void *ptr);
+
+extern "C" void *malloc(size_t size) {
+	++s_allocations;
+	return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t num, size_t size) {
+	++s_allocations;
+	return __libc_calloc(num, size);
+}
+
+extern "C" void *realloc(void *ptr, size_t size) {
+	++s_allocations;
+	return __libc_realloc(ptr, size);
+}
+
+// Bypass the counting malloc above, so that new is only counted once
+#define rawMalloc __libc_malloc
+#define rawFree __libc_free
+#else
+#define rawMalloc malloc
+#define rawFree free
+#endif
+
+void *operator new(size_t size) throw(std::bad_alloc) {
+	++s_allocations;
+	void *ptr = rawMalloc(size ? size : 1);
+	if (!ptr)
+		abort();
+	return ptr;
+}
+
+void *operator new[](size_t size) throw(std::bad_alloc) {
+	++s_allocations;
+	void *ptr = rawMalloc(size ? size : 1);
+	if (!ptr)
+		abort();
+	return ptr;
+}
+
+void operator delete(void *ptr) throw() {
+	rawFree(ptr);
+}
+
+void operator delete[](void *ptr) throw() {
+	rawFree(ptr);
+}
+
+#undef rawMalloc
+#undef rawFree
+
+static uint64 getNanoseconds() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+#pragma mark -
+#pragma mark --- Headless system ---
+#pragma mark -
+
+/**
+ * Minimal OSystem, modelled after the null backend, but with a working
+ * clock. Nothing is hooked up to the mixer; the benchmark calls
+ * mixCallback itself.
+ */
+class OSystem_Bench : public ModularBackend, Common::EventSource {
+protected:
+	virtual Common::EventSource *getDefaultEventSource() { return this; }
+
+public:
+	OSystem_Bench(uint sampleRate) : _sampleRate(sampleRate), _start(getNanoseconds()) {
+		_fsFactory = new POSIXFilesystemFactory();
+	}
+
+	virtual ~OSystem_Bench() {
+		// The timer manager needs the mutex manager, which ModularBackend
+		// destroys before OSystem gets to delete the timer manager
+		delete _timerManager;
+		_timerManager = 0;
+	}
+
+	virtual void initBackend() {
+		_mutexManager = new NullMutexManager();
+		_timerManager = new DefaultTimerManager();
+		_eventManager = new DefaultEventManager(this);
+		_savefileManager = new DefaultSaveFileManager();
+		_graphicsManager = new NullGraphicsManager();
+		_mixer = new Audio::MixerImpl(this, _sampleRate);
+
+		ModularBackend::initBackend();
+	}
+
+	Audio::MixerImpl *getMixerImpl() { return (Audio::MixerImpl *)_mixer; }
+
+	virtual bool pollEvent(Common::Event &event) { return false; }
+
+	virtual uint32 getMillis() { return (uint32)((getNanoseconds() - _start) / 1000000); }
+	virtual void delayMillis(uint msecs) {}
+	virtual void getTimeAndDate(TimeDate &t) const {}
+
+	virtual void logMessage(LogMessageType::Type type, const char *message) {
+		fputs(message, (type == LogMessageType::kInfo || type == LogMessageType::kDebug) ? stdout : stderr);
+	}
+
+private:
+	uint _sampleRate;
+	uint64 _start;
+};
+
+#pragma mark -
+#pragma mark --- Test streams ---
+#pragma mark -
+
+enum {
+	kSourceRate = 22050,
+	kSourceSeconds = 2
+};
+
+static Common::SeekableReadStream *makeBufferStream(byte *data, uint32 size) {
+	return new Common::MemoryReadStream(data, size, DisposeAfterUse::YES);
+}
+
+/** A sine sweep, so the interpolating converters do some real work. */
+static void fillSine(int16 *samples, uint frames, uint channels) {
+	for (uint i = 0; i < frames; i++) {
+		const double t = (double)i / kSourceRate;
+		const int16 value = (int16)(sin(2 * M_PI * (200 + 2000 * t) * t) * 12000);
+		for (uint ch = 0; ch < channels; ch++)
+			samples[i * channels + ch] = ch ? -value : value;
+	}
+}
+
+static Audio::RewindableAudioStream *makeRaw(uint channels) {
+	const uint frames = kSourceRate * kSourceSeconds;
+	const uint32 size = frames * channels * sizeof(int16);
+	int16 *samples = (int16 *)malloc(size);
+	fillSine(samples, frames, channels);
+
+	byte flags = Audio::FLAG_16BITS;
+#ifdef SCUMM_LITTLE_ENDIAN
+	flags |= Audio::FLAG_LITTLE_ENDIAN;
+#endif
+	if (channels == 2)
+		flags |= Audio::FLAG_STEREO;
+
+	return Audio::makeRawStream((byte *)samples, size, kSourceRate, flags);
+}
+
+static Audio::RewindableAudioStream *makeADPCM() {
+	// Random nibbles make for a noisy but perfectly valid IMA ADPCM stream
+	const uint32 size = kSourceRate * kSourceSeconds / 2;
+	byte *data = (byte *)malloc(size);
+	uint32 seed = 0xC0FFEE;
+	for (uint32 i = 0; i < size; i++) {
+		seed = seed * 1103515245 + 12345;
+		data[i] = (byte)(seed >> 16);
+	}
+
+	return Audio::makeADPCMStream(makeBufferStream(data, size), DisposeAfterUse::YES, size, Audio::kADPCMDVI, kSourceRate, 1);
+}
+
+static Audio::RewindableAudioStream *makeVOC() {
+	// A single 8 bit 11025 Hz sound data block
+	const uint32 samples = 11025 * kSourceSeconds;
+	const uint32 size = 26 + 6 + samples + 1;
+	byte *data = (byte *)malloc(size);
+	byte *ptr = data;
+
+	memcpy(ptr, "Creative Voice File\x1A", 20);
+	WRITE_LE_UINT16(ptr + 20, 26);
+	WRITE_LE_UINT16(ptr + 22, 0x010A);
+	WRITE_LE_UINT16(ptr + 24, ~0x010A + 0x1234);
+	ptr += 26;
+
+	*ptr++ = 1;
+	*ptr++ = (samples + 2) & 0xFF;
+	*ptr++ = ((samples + 2) >> 8) & 0xFF;
+	*ptr++ = ((samples + 2) >> 16) & 0xFF;
+	*ptr++ = 0xA6;
+	*ptr++ = 0;
+	for (uint32 i = 0; i < samples; i++)
+		*ptr++ = (byte)(128 + 100 * sin(2 * M_PI * 440 * i / 11025.0));
+	*ptr++ = 0;
+
+	return Audio::makeVOCStream(makeBufferStream(data, size), Audio::FLAG_UNSIGNED, DisposeAfterUse::YES);
+}
+
+static Audio::RewindableAudioStream *makeWAVE() {
+	// 16 bit stereo PCM
+	const uint frames = kSourceRate * kSourceSeconds;
+	const uint32 dataSize = frames * 4;
+	const uint32 size = 44 + dataSize;
+	byte *data = (byte *)malloc(size);
+
+	memcpy(data, "RIFF", 4);
+	WRITE_LE_UINT32(data + 4, size - 8);
+	memcpy(data + 8, "WAVEfmt ", 8);
+	WRITE_LE_UINT32(data + 16, 16);
+	WRITE_LE_UINT16(data + 20, 1);
+	WRITE_LE_UINT16(data + 22, 2);
+	WRITE_LE_UINT32(data + 24, kSourceRate);
+	WRITE_LE_UINT32(data + 28, kSourceRate * 4);
+	WRITE_LE_UINT16(data + 32, 4);
+	WRITE_LE_UINT16(data + 34, 16);
+	memcpy(data + 36, "data", 4);
+	WRITE_LE_UINT32(data + 40, dataSize);
+
+	int16 *samples = (int16 *)(data + 44);
+	fillSine(samples, frames, 2);
+	for (uint i = 0; i < frames * 2; i++)
+		WRITE_LE_UINT16(&samples[i], samples[i]);
+
+	return Audio::makeWAVStream(makeBufferStream(data, size), DisposeAfterUse::YES);
+}
+
+static Audio::RewindableAudioStream *makeFromFile(const char *type, const Common::String &path) {
+	Common::FSNode node(path);
+	Common::SeekableReadStream *file = node.createReadStream();
+	if (!file) {
+		fprintf(stderr, "Cannot open '%s'\n", path.c_str());
+		return 0;
+	}
+
+	// Decode from memory, the benchmark is not about disk access
+	const uint32 size = file->size();
+	byte *data = (byte *)malloc(size);
+	file->read(data, size);
+	delete file;
+	Common::SeekableReadStream *stream = makeBufferStream(data, size);
+
+#ifdef USE_VORBIS
+	if (!strcmp(type, "vorbis"))
+		return Audio::makeVorbisStream(stream, DisposeAfterUse::YES);
+#endif
+#ifdef USE_FLAC
+	if (!strcmp(type, "flac"))
+		return Audio::makeFLACStream(stream, DisposeAfterUse::YES);
+#endif
+#ifdef USE_MAD
+	if (!strcmp(type, "mp3"))
+		return Audio::makeMP3Stream(stream, DisposeAfterUse::YES);
+#endif
+
+	fprintf(stderr, "Support for %s streams is not compiled in\n", type);
+	delete stream;
+	return 0;
+}
+
+#pragma mark -
+#pragma mark --- Main ---
+#pragma mark -
+
+struct StreamSpec {
+	Common::String type;
+	Common::String path;
+	int count;
+};
+
+static void usage(const char *name) {
+	printf("Usage: %s [options]\n"
+	       "\n"
+	       "Stream mix (at most 16 streams in total):\n"
+	       "  --raw=N            N looping 16 bit stereo raw PCM streams (default: 4)\n"
+	       "  --raw-mono=N       N looping 16 bit mono raw PCM streams\n"
+	       "  --adpcm=N          N looping IMA ADPCM streams\n"
+	       "  --voc=N            N looping 8 bit VOC streams\n"
+	       "  --wave=N           N looping 16 bit stereo WAVE streams\n"
+	       "  --vorbis=FILE[:N]  N looping streams decoded from an Ogg Vorbis file\n"
+	       "  --flac=FILE[:N]    N looping streams decoded from a FLAC file\n"
+	       "  --mp3=FILE[:N]     N looping streams decoded from an MP3 file\n"
+	       "\n"
+	       "Mixer settings:\n"
+	       "  --rate=HZ          output sample rate (default: 44100)\n"
+	       "  --buffer=FRAMES    frames per mixer callback (default: 1024)\n"
+	       "  --seconds=S        amount of audio to render (default: 60)\n"
+	       "  --quality=Q        resampler quality: fast, low, medium, high\n"
+	       "  --queue            enable the mixer command queue\n",
+	       name);
+}
+
+static bool parseSpec(const char *arg, const char *type, bool withFile, Common::Array<StreamSpec> &specs) {
+	const size_t len = strlen(type);
+	if (strncmp(arg, "--", 2) || strncmp(arg + 2, type, len) || arg[2 + len] != '=')
+		return false;
+
+	StreamSpec spec;
+	spec.type = type;
+	spec.count = 1;
+
+	const char *value = arg + 3 + len;
+	if (withFile) {
+		const char *colon = strrchr(value, ':');
+		if (colon) {
+			spec.path = Common::String(value, colon);
+			spec.count = atoi(colon + 1);
+		} else {
+			spec.path = value;
+		}
+	} else {
+		spec.count = atoi(value);
+	}
+
+	specs.push_back(spec);
+	return true;
+}
+
+int main(int argc, char *argv[]) {
+	Common::Array<StreamSpec> specs;
+	uint rate = 44100, buffer = 1024, seconds = 60;
+	const char *quality = "fast";
+	bool queue = false;
+
+	for (int i = 1; i < argc; i++) {
+		const char *arg = argv[i];
+		if (!strcmp(arg, "--help") || !strcmp(arg, "-h")) {
+			usage(argv[0]);
+			return 0;
+		} else if (!strncmp(arg, "--rate=", 7)) {
+			rate = atoi(arg + 7);
+		} else if (!strncmp(arg, "--buffer=", 9)) {
+			buffer = atoi(arg + 9);
+		} else if (!strncmp(arg, "--seconds=", 10)) {
+			seconds = atoi(arg + 10);
+		} else if (!strncmp(arg, "--quality=", 10)) {
+			quality = arg + 10;
+		} else if (!strcmp(arg, "--queue")) {
+			queue = true;
+		} else if (!parseSpec(arg, "raw", false, specs) && !parseSpec(arg, "raw-mono", false, specs)
+		           && !parseSpec(arg, "adpcm", false, specs) && !parseSpec(arg, "voc", false, specs)
+		           && !parseSpec(arg, "wave", false, specs) && !parseSpec(arg, "vorbis", true, specs)
+		           && !parseSpec(arg, "flac", true, specs) && !parseSpec(arg, "mp3", true, specs)) {
+			fprintf(stderr, "Unknown option '%s'\n", arg);
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	if (specs.empty()) {
+		StreamSpec spec;
+		spec.type = "raw";
+		spec.count = 4;
+		specs.push_back(spec);
+	}
+
+	if (!rate || !buffer || !seconds) {
+		fprintf(stderr, "Invalid mixer settings\n");
+		return 1;
+	}
+
+	OSystem_Bench *system = new OSystem_Bench(rate);
+	g_system = system;
+	ConfMan.set("resampler_quality", quality);
+	system->initBackend();
+
+	Audio::MixerImpl *mixer = system->getMixerImpl();
+	Audio::Mixer *mixerInterface = mixer;
+	mixer->setReady(true);
+	mixer->setCommandQueue(queue);
+
+	int numStreams = 0;
+	for (uint i = 0; i < specs.size(); i++) {
+		for (int j = 0; j < specs[i].count; j++) {
+			const Common::String &type = specs[i].type;
+			Audio::RewindableAudioStream *stream = 0;
+
+			if (type == "raw")
+				stream = makeRaw(2);
+			else if (type == "raw-mono")
+				stream = makeRaw(1);
+			else if (type == "adpcm")
+				stream = makeADPCM();
+			else if (type == "voc")
+				stream = makeVOC();
+			else if (type == "wave")
+				stream = makeWAVE();
+			else
+				stream = makeFromFile(type.c_str(), specs[i].path);
+
+			if (!stream)
+				return 1;
+
+			Audio::SoundHandle handle;
+			mixerInterface->playStream(Audio::Mixer::kPlainSoundType, &handle, Audio::makeLoopingAudioStream(stream, 0));
+			if (!mixer->isSoundHandleActive(handle)) {
+				fprintf(stderr, "Too many streams\n");
+				return 1;
+			}
+			numStreams++;
+		}
+	}
+
+	byte *samples = new byte[buffer * 4];
+	const uint callbacks = (uint)(((uint64)rate * seconds + buffer - 1) / buffer);
+
+	// Warm up, so that the one time allocations of the converters do
+	// not show up in the allocation statistics
+	mixer->mixCallback(samples, buffer * 4);
+
+	const unsigned long allocationsBefore = s_allocations;
+	uint64 elapsed = 0, worst = 0;
+	for (uint i = 0; i < callbacks; i++) {
+		const uint64 start = getNanoseconds();
+		mixer->mixCallback(samples, buffer * 4);
+		const uint64 duration = getNanoseconds() - start;
+
+		elapsed += duration;
+		if (duration > worst)
+			worst = duration;
+	}
+	const unsigned long allocations = s_allocations - allocationsBefore;
+
+	const double frames = (double)callbacks * buffer;
+	const double secondsElapsed = elapsed / 1e9;
+
+	printf("streams:                 %d\n", numStreams);
+	printf("output rate:             %u Hz, %u frames per callback, resampler '%s'%s\n", rate, buffer, quality, queue ? ", command queue" : "");
+	printf("rendered:                %.0f frames in %u callbacks\n", frames, callbacks);
+	printf("elapsed:                 %.3f s (%.1fx realtime)\n", secondsElapsed, frames / rate / secondsElapsed);
+	printf("samples/sec:             %.0f\n", frames * 2 / secondsElapsed);
+	printf("ns per output frame:     %.1f\n", elapsed / frames);
+	printf("worst callback:          %.3f ms (budget %.3f ms)\n", worst / 1e6, buffer * 1000.0 / rate);
+	printf("allocations/callback:    %.2f\n", (double)allocations / callbacks);
+
+	delete[] samples;
+	delete system;
+	return 0;
+}
@@ -0,0 +1,175 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+/*
+ * HashMap benchmark. Compares Common::HashMap with Common::FlatHashMap for
+ * integer and string keys: insertion, successful and failing lookups,
+ * iteration and erasure. Run with --help for the available options.
+ */
+
+// The benchmark is a standalone tool, not part of ScummVM proper
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include "common/array.h"
+#include "common/flathashmap.h"
+#include "common/hashmap.h"
+#include "common/hash-str.h"
+#include "common/str.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double getSeconds() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/** Keeps the compiler from optimizing the benchmarked loops away. */
+static volatile uint s_sink;
+
+/** Run time of one round, as fastest one of all rounds. */
+struct Timing {
+	double best;
+
+	Timing() : best(1e30) {}
+	void add(double start) {
+		const double elapsed = getSeconds() - start;
+		if (elapsed < best)
+			best = elapsed;
+	}
+};
+
+template<class Map, class Key>
+static void runBenchmark(const char *name, const Common::Array<Key> &keys, const Common::Array<Key> &missing, uint rounds) {
+	Timing insert, hit, miss, iterate, erase;
+	uint sum = 0;
+
+	for (uint round = 0; round < rounds; round++) {
+		Map map;
+
+		double start = getSeconds();
+		for (uint i = 0; i < keys.size(); i++)
+			map[keys[i]] = i;
+		insert.add(start);
+
+		start = getSeconds();
+		for (uint i = 0; i < keys.size(); i++)
+			sum += map.getVal(keys[i]);
+		hit.add(start);
+
+		start = getSeconds();
+		for (uint i = 0; i < missing.size(); i++)
+			sum += map.contains(missing[i]);
+		miss.add(start);
+
+		start = getSeconds();
+		for (typename Map::const_iterator i = map.begin(); i != map.end(); ++i)
+			sum += i->_value;
+		iterate.add(start);
+
+		start = getSeconds();
+		for (uint i = 0; i < keys.size(); i++)
+			map.erase(keys[i]);
+		erase.add(start);
+	}
+	s_sink = sum;
+
+	const double scale = 1e9 / keys.size();
+	printf("%-32s %9.1f %9.1f %9.1f %9.1f %9.1f\n", name,
+	       insert.best * scale, hit.best * scale, miss.best * scale, iterate.best * scale, erase.best * scale);
+}
+
+static void usage(const char *name) {
+	printf("Usage: %s [options]\n"
+	       "  --keys=N     number of keys per map (default: 10000)\n"
+	       "  --rounds=N   number of times each benchmark is repeated (default: 20)\n",
+	       name);
+}
+
+int main(int argc, char *argv[]) {
+	uint numKeys = 10000, rounds = 20;
+
+	for (int i = 1; i < argc; i++) {
+		if (!strncmp(argv[i], "--keys=", 7)) {
+			numKeys = atoi(argv[i] + 7);
+		} else if (!strncmp(argv[i], "--rounds=", 9)) {
+			rounds = atoi(argv[i] + 9);
+		} else {
+			usage(argv[0]);
+			return strcmp(argv[i], "--help") ? 1 : 0;
+		}
+	}
+
+	if (!numKeys || !rounds) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	// Integer keys: sequential ids, as e.g. resource numbers, and random
+	// values. The keys which are not in the map follow the same pattern.
+	Common::Array<uint> seqKeys, seqMissing, randKeys, randMissing;
+	Common::HashMap<uint, bool> used;
+	uint seed = 0xC0FFEE;
+	for (uint i = 0; i < numKeys; i++) {
+		seqKeys.push_back(i);
+		seqMissing.push_back(numKeys + i);
+	}
+	while (randKeys.size() + randMissing.size() < 2 * numKeys) {
+		seed = seed * 1103515245 + 12345;
+		uint key = seed >> 16;
+		seed = seed * 1103515245 + 12345;
+		key = (key << 16) ^ (seed >> 16);
+
+		if (used.contains(key))
+			continue;
+		used[key] = true;
+
+		if (randKeys.size() < numKeys)
+			randKeys.push_back(key);
+		else
+			randMissing.push_back(key);
+	}
+
+	// String keys, modelled after config keys and file names
+	Common::Array<Common::String> stringKeys, stringMissing;
+	for (uint i = 0; i < numKeys; i++) {
+		stringKeys.push_back(Common::String::format("resource.%03u/entry_%u", i % 997, i));
+		stringMissing.push_back(Common::String::format("resource.%03u/missing_%u", i % 997, i));
+	}
+
+	printf("%u keys, best of %u rounds, ns per operation\n\n", numKeys, rounds);
+	printf("%-32s %9s %9s %9s %9s %9s\n", "", "insert", "hit", "miss", "iterate", "erase");
+
+	runBenchmark<Common::HashMap<uint, uint> >("HashMap<uint>, sequential", seqKeys, seqMissing, rounds);
+	runBenchmark<Common::FlatHashMap<uint, uint> >("FlatHashMap<uint>, sequential", seqKeys, seqMissing, rounds);
+	runBenchmark<Common::HashMap<uint, uint> >("HashMap<uint>, random", randKeys, randMissing, rounds);
+	runBenchmark<Common::FlatHashMap<uint, uint> >("FlatHashMap<uint>, random", randKeys, randMissing, rounds);
+	runBenchmark<Common::HashMap<Common::String, uint> >("HashMap<String>", stringKeys, stringMissing, rounds);
+	runBenchmark<Common::FlatHashMap<Common::String, uint> >("FlatHashMap<String>", stringKeys, stringMissing, rounds);
+	runBenchmark<Common::HashMap<Common::String, uint, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> >("HashMap<String>, ignore case", stringKeys, stringMissing, rounds);
+	runBenchmark<Common::FlatHashMap<Common::String, uint, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> >("FlatHashMap<String>, ignore case", stringKeys, stringMissing, rounds);
+
+	return 0;
+}
@@ -0,0 +1,122 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/arena.h"
+
+class ArenaTestSuite : public CxxTest::TestSuite {
+	struct Counted {
+		static int _alive;
+		int _value;
+		Counted(int value) : _value(value) { _alive++; }
+		~Counted() { _alive--; }
+	};
+
+	public:
+	void test_allocate() {
+		Common::Arena arena;
+		void *ptrs[300];
+
+		for (int i = 0; i < 300; ++i) {
+			size_t size = 1 + (i * 37) % 2048;
+			ptrs[i] = arena.allocate(size);
+			memset(ptrs[i], i & 0xFF, size);
+			TS_ASSERT_EQUALS(Common::Arena::getOwner(ptrs[i]), &arena);
+			if (size > 8)
+				TS_ASSERT_EQUALS((size_t)ptrs[i] % Common::Arena::kAlignment, (size_t)0);
+		}
+
+		for (int i = 0; i < 300; ++i) {
+			size_t size = 1 + (i * 37) % 2048;
+			const byte *p = (const byte *)ptrs[i];
+			TS_ASSERT_EQUALS(p[0], i & 0xFF);
+			TS_ASSERT_EQUALS(p[size - 1], i & 0xFF);
+		}
+
+		for (int i = 0; i < 300; ++i)
+			Common::Arena::deallocate(ptrs[i]);
+		TS_ASSERT_EQUALS(arena.getUsedSize(), (size_t)0);
+	}
+
+	void test_reuse() {
+		Common::Arena arena;
+
+		void *a = arena.allocate(40);
+		void *b = arena.allocate(40);
+		TS_ASSERT_DIFFERS(a, b);
+		TS_ASSERT_EQUALS(arena.getUsedSize(), (size_t)96);
+
+		Common::Arena::deallocate(a);
+		TS_ASSERT_EQUALS(arena.allocate(33), a);
+
+		// Fill more than one page of a size class, then free it again
+		const size_t allocated = arena.getAllocatedSize();
+		void *ptrs[1000];
+		for (int i = 0; i < 1000; ++i)
+			ptrs[i] = arena.allocate(64);
+		for (int i = 0; i < 1000; ++i)
+			Common::Arena::deallocate(ptrs[i]);
+		for (int i = 0; i < 1000; ++i)
+			ptrs[i] = arena.allocate(256);
+		for (int i = 0; i < 1000; ++i)
+			Common::Arena::deallocate(ptrs[i]);
+
+		// Free pages are shared between the size classes
+		TS_ASSERT(arena.getAllocatedSize() <= allocated + 3 * Common::Arena::kPagesPerBlock * Common::Arena::kPageSize);
+		TS_ASSERT_EQUALS(arena.getUsedSize(), (size_t)96);
+	}
+
+	void test_large() {
+		Common::Arena arena;
+
+		byte *p = (byte *)arena.allocate(100000);
+		memset(p, 0x55, 100000);
+		TS_ASSERT_EQUALS(Common::Arena::getOwner(p), &arena);
+		TS_ASSERT_EQUALS(arena.getUsedSize(), (size_t)100000);
+		TS_ASSERT(arena.getAllocatedSize() >= 100000);
+
+		Common::Arena::deallocate(p);
+		TS_ASSERT_EQUALS(arena.getUsedSize(), (size_t)0);
+		TS_ASSERT_EQUALS(arena.getAllocatedSize(), (size_t)0);
+	}
+
+	void test_reset() {
+		Common::Arena arena;
+
+		for (int i = 0; i < 500; ++i)
+			arena.allocate(i * 13);
+		const size_t allocated = arena.getAllocatedSize();
+		TS_ASSERT(arena.getUsedSize() > 0);
+
+		arena.reset();
+		TS_ASSERT_EQUALS(arena.getUsedSize(), (size_t)0);
+		TS_ASSERT(arena.getAllocatedSize() <= allocated);
+
+		// The kept pages are used again
+		const size_t kept = arena.getAllocatedSize();
+		for (int i = 0; i < 100; ++i)
+			arena.allocate(i * 13);
+		TS_ASSERT_EQUALS(arena.getAllocatedSize(), kept);
+
+		arena.reset(true);
+		TS_ASSERT_EQUALS(arena.getUsedSize(), (size_t)0);
+		TS_ASSERT_EQUALS(arena.getAllocatedSize(), (size_t)0);
+	}
+
+	void test_new() {
+		Common::Arena arena;
+		Counted::_alive = 0;
+
+		Counted *a = new (arena) Counted(1);
+		Counted *b = new (arena) Counted(2);
+		TS_ASSERT_EQUALS(Counted::_alive, 2);
+		TS_ASSERT_EQUALS(a->_value, 1);
+		TS_ASSERT_EQUALS(b->_value, 2);
+
+		Common::Arena::destroy(a);
+		TS_ASSERT_EQUALS(Counted::_alive, 1);
+		Common::Arena::destroy(b);
+		TS_ASSERT_EQUALS(Counted::_alive, 0);
+		Common::Arena::destroy((Counted *)0);
+	}
+};
+
+int ArenaTestSuite::Counted::_alive = 0;
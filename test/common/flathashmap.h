@@ -0,0 +1,176 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/flathashmap.h"
+#include "common/hashmap.h"
+#include "common/hash-str.h"
+#include "common/str.h"
+
+class FlatHashMapTestSuite : public CxxTest::TestSuite
+{
+	typedef Common::FlatHashMap<Common::String, Common::String, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> FlatStringMap;
+
+	/** Hashes every key to the same slot, to exercise collision handling. */
+	struct BadHash {
+		uint operator()(int x) const { return 0; }
+	};
+
+	public:
+	void test_empty_clear() {
+		Common::FlatHashMap<int, int> container;
+		TS_ASSERT(container.empty());
+		container[0] = 17;
+		container[1] = 33;
+		TS_ASSERT(!container.empty());
+		container.clear();
+		TS_ASSERT(container.empty());
+
+		FlatStringMap container2;
+		TS_ASSERT(container2.empty());
+		container2["foo"] = "bar";
+		container2["quux"] = "blub";
+		TS_ASSERT(!container2.empty());
+		container2.clear(true);
+		TS_ASSERT(container2.empty());
+		container2["foo"] = "bar";
+		TS_ASSERT_EQUALS(container2["FOO"], "bar");
+	}
+
+	void test_add_remove() {
+		Common::FlatHashMap<int, int> container;
+		container[0] = 17;
+		container[1] = 33;
+		container[2] = 45;
+		container[3] = 12;
+		container[4] = 96;
+		TS_ASSERT(container.contains(1));
+		container.erase(1);
+		TS_ASSERT(!container.contains(1));
+		container[1] = 42;
+		TS_ASSERT(container.contains(1));
+		container.erase(container.find(0));
+		TS_ASSERT_EQUALS(container.size(), 4u);
+		container.erase(1);
+		container.erase(2);
+		container.erase(3);
+		TS_ASSERT(!container.empty());
+		container.erase(container.find(4));
+		TS_ASSERT(container.empty());
+	}
+
+	void test_lookup_with_default() {
+		Common::FlatHashMap<int, int> container;
+		container[0] = 17;
+		container[1] = -1;
+
+		// We take a const ref now to ensure that the map
+		// is not modified by getVal.
+		const Common::FlatHashMap<int, int> &containerRef = container;
+
+		TS_ASSERT_EQUALS(containerRef.getVal(0), 17);
+		TS_ASSERT_EQUALS(containerRef.getVal(1), -1);
+		TS_ASSERT_EQUALS(containerRef.getVal(17), 0);
+		TS_ASSERT_EQUALS(containerRef.getVal(17, -10), -10);
+		TS_ASSERT_EQUALS(containerRef.size(), 2u);
+		TS_ASSERT(containerRef.find(17) == containerRef.end());
+	}
+
+	void test_copy() {
+		FlatStringMap map1;
+		map1["foo"] = "bar";
+		map1["quux"] = "blub";
+
+		FlatStringMap map2(map1), map3;
+		map3["asdf"] = "ghjk";
+		map3 = map1;
+		map1.erase("foo");
+
+		TS_ASSERT_EQUALS(map2.size(), 2u);
+		TS_ASSERT_EQUALS(map2["foo"], "bar");
+		TS_ASSERT_EQUALS(map3.size(), 2u);
+		TS_ASSERT_EQUALS(map3["quux"], "blub");
+		TS_ASSERT(!map3.contains("asdf"));
+	}
+
+	void test_collision() {
+		// All keys share one cluster, erasing from its middle must shift
+		// the following keys back without losing any of them
+		Common::FlatHashMap<int, int, BadHash> h;
+		for (int i = 0; i < 8; i++)
+			h[i] = i * 10;
+
+		h.erase(3);
+		h.erase(0);
+		for (int i = 0; i < 8; i++) {
+			TS_ASSERT_EQUALS(h.contains(i), i != 0 && i != 3);
+			if (i != 0 && i != 3)
+				TS_ASSERT_EQUALS(h[i], i * 10);
+		}
+		TS_ASSERT_EQUALS(h.size(), 6u);
+
+		h[3] = 30;
+		h.erase(7);
+		h.erase(1);
+		TS_ASSERT(h.contains(3));
+		TS_ASSERT(!h.contains(7));
+		TS_ASSERT_EQUALS(h[6], 60);
+		TS_ASSERT_EQUALS(h.size(), 5u);
+	}
+
+	void test_iterator() {
+		Common::FlatHashMap<int, int> container;
+		for (int i = 0; i < 5; i++)
+			container[i] = i;
+		container.erase(0);
+		container.erase(1);
+
+		int found = 0;
+		Common::FlatHashMap<int, int>::const_iterator i;
+		for (i = container.begin(); i != container.end(); ++i) {
+			int key = i->_key;
+			TS_ASSERT(key >= 0 && key <= 4);
+			TS_ASSERT_EQUALS(i->_value, key);
+			TS_ASSERT(!(found & (1 << key)));
+			found |= 1 << key;
+		}
+		TS_ASSERT(found == 16+8+4);
+	}
+
+	void test_compare_with_hashmap() {
+		// Apply the same pseudo random operations to a HashMap and a
+		// FlatHashMap, with enough keys to force several expansions and
+		// plenty of clusters which wrap around the end of the table
+		Common::HashMap<uint, uint> reference;
+		Common::FlatHashMap<uint, uint> map;
+
+		uint seed = 12345;
+		for (int i = 0; i < 20000; i++) {
+			seed = seed * 1103515245 + 12345;
+			const uint key = (seed >> 8) % 1500;
+			switch ((seed >> 4) % 3) {
+			case 0:
+			case 1:
+				reference[key] = i;
+				map[key] = i;
+				break;
+			default:
+				reference.erase(key);
+				map.erase(key);
+				break;
+			}
+		}
+
+		TS_ASSERT_EQUALS(map.size(), reference.size());
+		for (uint key = 0; key < 1500; key++) {
+			TS_ASSERT_EQUALS(map.contains(key), reference.contains(key));
+			if (reference.contains(key))
+				TS_ASSERT_EQUALS(map[key], reference[key]);
+		}
+
+		uint count = 0;
+		for (Common::FlatHashMap<uint, uint>::iterator i = map.begin(); i != map.end(); ++i) {
+			TS_ASSERT_EQUALS(i->_value, reference[i->_key]);
+			count++;
+		}
+		TS_ASSERT_EQUALS(count, reference.size());
+	}
+};
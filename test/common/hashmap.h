@@ -230,5 +230,53 @@ class HashMapTestSuite : public CxxTest::TestSuite
 		TS_ASSERT(found == 16+8+4);
 }
 
+	void test_stats() {
+		Common::HashMapStats stats;
+		Common::Array<Common::HashMapStats> registered;
+		uint numRegistered;
+
+		Common::getRegisteredHashMapStats(registered);
+		numRegistered = registered.size();
+
+		{
+			Common::HashMap<int, int> container;
+			container.setStatsName("test.container");
+			for (int i = 0; i < 100; i++)
+				container[i] = i;
+			container.erase(5);
+			TS_ASSERT(!container.contains(5));
+
+			container.getStats(stats);
+			TS_ASSERT_EQUALS(Common::String(stats.name), "test.container");
+			TS_ASSERT_EQUALS(stats.size, 99u);
+			TS_ASSERT_EQUALS(stats.deleted, 1u);
+			TS_ASSERT(stats.capacity * 2 >= 99 * 3);
+#ifdef USE_HASHMAP_STATS
+			TS_ASSERT(stats.counters.lookups >= 101u);
+			TS_ASSERT(stats.counters.probes >= stats.counters.lookups);
+			TS_ASSERT(stats.counters.maxProbes >= 1u);
+			TS_ASSERT(stats.counters.rehashes > 0u);
+#endif
+			TS_ASSERT(stats.memory >= stats.capacity * sizeof(void *));
+
+			// Copies are not registered
+			Common::HashMap<int, int> copy(container);
+			copy.getStats(stats);
+			TS_ASSERT(stats.name == 0);
+
+			Common::getRegisteredHashMapStats(registered);
+			TS_ASSERT_EQUALS(registered.size(), numRegistered + 1);
+
+			Common::resetRegisteredHashMapStats();
+			container.getStats(stats);
+			TS_ASSERT_EQUALS(stats.counters.lookups, 0u);
+			TS_ASSERT_EQUALS(stats.counters.rehashes, 0u);
+		}
+
+		// Destroyed maps unregister themselves
+		Common::getRegisteredHashMapStats(registered);
+		TS_ASSERT_EQUALS(registered.size(), numRegistered);
+	}
+
 	// TODO: Add test cases for iterators, find, ...
 };
@@ -100,4 +100,26 @@ class MemoryReadStreamTestSuite : public CxxTest::TestSuite {
 		ms.seek(0, SEEK_SET);
 		TS_ASSERT(!ms.eos());
 	}
+
+	void test_read_view() {
+		byte contents[] = { 1, 2, 3, 4, 5, 6, 7 };
+		Common::MemoryReadStream ms(contents, sizeof(contents));
+
+		ms.seek(1, SEEK_SET);
+		TS_ASSERT_EQUALS(ms.readView(4), contents + 1);
+		TS_ASSERT_EQUALS(ms.pos(), 5);
+
+		// Not enough data left
+		TS_ASSERT_EQUALS(ms.readView(3), (const byte *)0);
+		TS_ASSERT_EQUALS(ms.pos(), 5);
+		TS_ASSERT(!ms.eos());
+
+		byte buffer[4];
+		const byte *data;
+		TS_ASSERT_EQUALS(ms.readOrView(data, 2, buffer), 2u);
+		TS_ASSERT_EQUALS(data, contents + 5);
+		TS_ASSERT_EQUALS(ms.readOrView(data, 4, buffer), 0u);
+		TS_ASSERT_EQUALS(data, buffer);
+		TS_ASSERT(ms.eos());
+	}
 };
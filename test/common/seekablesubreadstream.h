@@ -70,4 +70,22 @@ class SeekableSubReadStreamTestSuite : public CxxTest::TestSuite {
 		b = ssrs.readByte();
 		TS_ASSERT_EQUALS(b, 1);
 	}
+
+	void test_read_view() {
+		byte contents[10] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+		Common::MemoryReadStream ms(contents, 10);
+
+		Common::SeekableSubReadStream ssrs(&ms, 1, 9);
+
+		ssrs.seek(2, SEEK_SET);
+		TS_ASSERT_EQUALS(ssrs.readView(3), contents + 3);
+		TS_ASSERT_EQUALS(ssrs.pos(), 5);
+		TS_ASSERT_EQUALS(ssrs.readByte(), 6);
+
+		// The view must not extend past the end of the substream
+		TS_ASSERT_EQUALS(ssrs.readView(3), (const byte *)0);
+		TS_ASSERT_EQUALS(ssrs.pos(), 6);
+		TS_ASSERT_EQUALS(ssrs.readView(2), contents + 7);
+		TS_ASSERT_EQUALS(ssrs.pos(), 8);
+	}
 };
@@ -0,0 +1,91 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/memstream.h"
+#include "common/zlib.h"
+
+class ZlibTestSuite : public CxxTest::TestSuite {
+	enum {
+		kDataSize = 300 * 1024
+	};
+
+	byte *_data;
+	byte *_compressed;
+	uint32 _compressedSize;
+
+	public:
+	void setUp() {
+		// Compressible, but not too much, so that there are plenty of
+		// deflate blocks.
+		_data = new byte[kDataSize];
+		uint32 seed = 1;
+		for (uint32 i = 0; i < kDataSize; ++i) {
+			seed = seed * 1103515245 + 12345;
+			_data[i] = 'a' + ((seed >> 16) & 7);
+		}
+
+		Common::MemoryWriteStreamDynamic *dynamic = new Common::MemoryWriteStreamDynamic();
+		Common::WriteStream *gzip = Common::wrapCompressedWriteStream(dynamic);
+		gzip->write(_data, kDataSize);
+		gzip->finalize();
+		_compressed = dynamic->getData();
+		_compressedSize = dynamic->size();
+		delete gzip;
+	}
+
+	void tearDown() {
+		delete[] _data;
+		free(_compressed);
+	}
+
+	Common::SeekableReadStream *open(uint32 checkpointInterval) {
+		Common::SeekableReadStream *compressed = new Common::MemoryReadStream(_compressed, _compressedSize);
+		return Common::wrapCompressedReadStream(compressed, 0, checkpointInterval);
+	}
+
+	void checkSeeks(Common::SeekableReadStream *stream) {
+		TS_ASSERT_EQUALS(stream->size(), kDataSize);
+
+		byte buf[300];
+		uint32 seed = 7;
+		for (int i = 0; i < 200; ++i) {
+			seed = seed * 1103515245 + 12345;
+			uint32 pos = (seed >> 8) % (kDataSize - sizeof(buf));
+			TS_ASSERT(stream->seek(pos));
+			TS_ASSERT_EQUALS((uint32)stream->pos(), pos);
+			TS_ASSERT_EQUALS(stream->read(buf, sizeof(buf)), sizeof(buf));
+			TS_ASSERT_SAME_DATA(buf, _data + pos, sizeof(buf));
+		}
+
+		// Read up to the end
+		TS_ASSERT(stream->seek(kDataSize - 10));
+		TS_ASSERT_EQUALS(stream->read(buf, sizeof(buf)), 10u);
+		TS_ASSERT_SAME_DATA(buf, _data + kDataSize - 10, 10);
+		TS_ASSERT(stream->eos());
+	}
+
+	void test_seek_checkpoints() {
+		Common::SeekableReadStream *stream = open(16 * 1024);
+		checkSeeks(stream);
+		delete stream;
+	}
+
+	void test_seek_no_checkpoints() {
+		Common::SeekableReadStream *stream = open(0);
+		checkSeeks(stream);
+		delete stream;
+	}
+
+	void test_read_all() {
+		Common::SeekableReadStream *stream = open(16 * 1024);
+		byte *buf = new byte[kDataSize];
+		TS_ASSERT_EQUALS(stream->read(buf, kDataSize), (uint32)kDataSize);
+		TS_ASSERT_SAME_DATA(buf, _data, kDataSize);
+
+		// Go back into the middle, after the checkpoints were made
+		TS_ASSERT(stream->seek(kDataSize / 2));
+		TS_ASSERT_EQUALS(stream->read(buf, 1000), 1000u);
+		TS_ASSERT_SAME_DATA(buf, _data + kDataSize / 2, 1000);
+		delete[] buf;
+		delete stream;
+	}
+};
@@ -35,8 +35,28 @@ test/runner.cpp: $(TESTS)
 	$(srcdir)/test/cxxtest/cxxtestgen.py $(TEST_FLAGS) -o $@ $+
 
 
+######################################################################
+# Benchmarks. These are not run automatically, use the 'bench' target
+# to build them.
+#
+######################################################################
+
+BENCHES      := test/bench/audiobench test/bench/hashbench
+# The benchmarks use the real backend classes, which pull in most of the
+# rest of ScummVM, so link against everything the main binary uses.
+BENCH_LIBS    = $(filter %.a,$(OBJS))
+
+bench: $(BENCHES)
+test/bench/audiobench: $(srcdir)/test/bench/audiobench.cpp $(BENCH_LIBS)
+	@mkdir -p test/bench
+	$(QUIET_LINK)$(CXX) $(CXXFLAGS) $(CPPFLAGS) -o $@ $< -Wl,--start-group $(BENCH_LIBS) -Wl,--end-group $(LIBS)
+test/bench/hashbench: $(srcdir)/test/bench/hashbench.cpp common/libcommon.a
+	@mkdir -p test/bench
+	$(QUIET_LINK)$(CXX) $(CXXFLAGS) $(CPPFLAGS) -o $@ $+ $(LIBS)
+
+
 clean: clean-test
 clean-test:
-	-$(RM) test/runner.cpp test/runner
+	-$(RM) test/runner.cpp test/runner $(BENCHES)
 
-.PHONY: test clean-test
+.PHONY: test bench clean-test